@@ -0,0 +1,105 @@
+#ifndef BENCH_FIXTURES_HPP
+#define BENCH_FIXTURES_HPP
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "dataset_spectrum.hpp"
+#include "spectrum_source.hpp"
+
+namespace bench {
+
+// Parameters of a stock HackRF sweep: 20 MS/s, FFT_BIN_WIDTH_HZ = 50 kHz
+// rounded up by hackrf_sweeper to a 404 point FFT, 101 bins per band.
+constexpr double SAMPLE_RATE_HZ = 20e6;
+constexpr int FFT_SIZE = 404;
+constexpr double BIN_WIDTH_HZ = SAMPLE_RATE_HZ / FFT_SIZE;
+constexpr int BINS_PER_BAND = FFT_SIZE / 4;
+constexpr uint64_t TUNE_STEP_HZ = 20'000'000;
+constexpr int WATERFALL_ROWS = 300;
+
+inline std::vector<uint16_t> full_range() {
+    return {1, 6001};
+}
+
+inline std::vector<uint16_t> disjoint_ranges() {
+    return {700, 800, 1800, 1900, 2100, 2200, 2600, 2700, 3500, 3600};
+}
+
+// Sweep blocks in the order hackrf_sweep's interleaved tuning produces
+// them, filled with noise-like powers.
+inline std::vector<FFTSweepData> make_sweep(const std::vector<uint16_t>& freq_ranges_mhz) {
+    auto config = std::make_shared<SweepConfig>();
+    config->bin_width_hz = BIN_WIDTH_HZ;
+    config->fft_size = FFT_SIZE;
+    config->freq_ranges_mhz = freq_ranges_mhz;
+
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> noise(-85.0F, 4.0F);
+
+    auto make_band = [&](uint64_t start_hz) {
+        FrequencyBand band;
+        band.start_hz = start_hz;
+        band.end_hz = start_hz + static_cast<uint64_t>(SAMPLE_RATE_HZ / 4);
+        band.power_db.resize(BINS_PER_BAND);
+        for (float& value : band.power_db) {
+            value = noise(rng);
+        }
+        return band;
+    };
+
+    std::vector<FFTSweepData> blocks;
+    for (size_t i = 0; i + 1 < freq_ranges_mhz.size(); i += 2) {
+        const uint64_t start_hz = freq_ranges_mhz[i] * 1'000'000ULL;
+        const uint64_t end_hz = freq_ranges_mhz[i + 1] * 1'000'000ULL;
+
+        for (uint64_t step = start_hz; step < end_hz; step += TUNE_STEP_HZ) {
+            for (const uint64_t offset : {uint64_t{0}, TUNE_STEP_HZ / 4}) {
+                FFTSweepData block;
+                block.config = config;
+                block.band_lower = make_band(step + offset);
+                block.band_upper = make_band(step + offset + TUNE_STEP_HZ / 2);
+                blocks.push_back(std::move(block));
+            }
+        }
+    }
+    return blocks;
+}
+
+// Both bands of a block into the spectrum, as MainWindow::update_plot does
+inline void add_block(DatasetSpectrum& spectrum, const FFTSweepData& block) {
+    spectrum.add_new_data(block.band_lower.start_hz, block.band_lower.end_hz, block.band_lower.power_db);
+    spectrum.add_new_data(block.band_upper.start_hz, block.band_upper.end_hz, block.band_upper.power_db);
+}
+
+// Hands every band of `blocks` that fits `layout` to
+// update(first_bin, power_db), as DatasetSpectrum does for its traces and
+// statistics. Returns the number of bands handed on.
+template <typename Update>
+uint64_t update_bands(const SpectrumLayout& layout, const std::vector<FFTSweepData>& blocks, Update&& update) {
+    uint64_t bands = 0;
+    for (const FFTSweepData& block : blocks) {
+        for (const FrequencyBand* band : {&block.band_lower, &block.band_upper}) {
+            const size_t first_bin = layout.bin_at(band->start_hz);
+            if (first_bin + band->power_db.size() <= layout.num_bins()) {
+                update(first_bin, band->power_db);
+                ++bands;
+            }
+        }
+    }
+    return bands;
+}
+
+// A spectrum holding one complete sweep of make_sweep()
+inline DatasetSpectrum filled_spectrum(const std::vector<uint16_t>& freq_ranges_mhz) {
+    DatasetSpectrum spectrum(BIN_WIDTH_HZ, freq_ranges_mhz);
+    for (const FFTSweepData& block : make_sweep(freq_ranges_mhz)) {
+        add_block(spectrum, block);
+    }
+    return spectrum;
+}
+
+}  // namespace bench
+
+#endif  // BENCH_FIXTURES_HPP
@@ -0,0 +1,35 @@
+#ifndef BENCH_HARNESS_HPP
+#define BENCH_HARNESS_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Runs the measured operation `iterations` times and returns how many
+// items (bins, rows, pixels, ...) it processed in total.
+using BenchmarkFn = std::function<uint64_t(uint64_t iterations)>;
+
+struct BenchmarkCase {
+    std::string name;
+    std::string unit;  // What one item is, reported as <unit>/s
+    BenchmarkFn fn;
+};
+
+std::vector<BenchmarkCase>& registry();
+bool register_case(std::string name, std::string unit, BenchmarkFn fn);
+
+// Keeps the optimizer from discarding results that are otherwise unused
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+}  // namespace bench
+
+#define BENCH_CASE(fn, name, unit) \
+    static const bool fn##_registered = bench::register_case(name, unit, fn)
+
+#endif  // BENCH_HARNESS_HPP
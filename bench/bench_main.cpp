@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench_harness.hpp"
+
+namespace bench {
+
+std::vector<BenchmarkCase>& registry() {
+    static std::vector<BenchmarkCase> cases;
+    return cases;
+}
+
+bool register_case(std::string name, std::string unit, BenchmarkFn fn) {
+    registry().push_back({std::move(name), std::move(unit), std::move(fn)});
+    return true;
+}
+
+}  // namespace bench
+
+struct BenchmarkResult {
+    uint64_t iterations = 0;
+    uint64_t items = 0;
+    double seconds = 0.0;
+};
+
+BenchmarkResult run_case(const bench::BenchmarkCase& bench_case, double min_time_s) {
+    BenchmarkResult result;
+
+    // Warm caches and lazily built state before timing anything
+    bench_case.fn(1);
+
+    uint64_t iterations = 1;
+    for (;;) {
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t items = bench_case.fn(iterations);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (seconds >= min_time_s || iterations >= (1ULL << 40)) {
+            result.iterations = iterations;
+            result.items = items;
+            result.seconds = seconds;
+            return result;
+        }
+
+        // Aim a little past the target so the final run usually qualifies
+        const double scale = seconds > 0.0 ? 1.4 * min_time_s / seconds : 10.0;
+        iterations = static_cast<uint64_t>(static_cast<double>(iterations) * std::min(std::max(scale, 2.0), 10.0));
+    }
+}
+
+std::string json_escape(const std::string& text) {
+    std::string escaped;
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+int main(int argc, char* argv[]) {
+    std::string filter;
+    double min_time_s = 0.5;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            min_time_s = std::atof(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--filter substring] [--min-time seconds]\n";
+            return 1;
+        }
+    }
+
+    // One JSON document on stdout so results can be diffed between releases;
+    // progress goes to stderr.
+    std::cout << "{\n  \"benchmarks\": [";
+
+    bool first = true;
+    for (const bench::BenchmarkCase& bench_case : bench::registry()) {
+        if (!filter.empty() && bench_case.name.find(filter) == std::string::npos) {
+            continue;
+        }
+
+        std::cerr << "Running " << bench_case.name << "...\n";
+        const BenchmarkResult result = run_case(bench_case, min_time_s);
+        const double rate = result.seconds > 0.0 ? static_cast<double>(result.items) / result.seconds : 0.0;
+
+        std::cout << (first ? "\n" : ",\n")
+                  << "    {\"name\": \"" << json_escape(bench_case.name) << "\""
+                  << ", \"unit\": \"" << json_escape(bench_case.unit) << "/s\""
+                  << ", \"rate\": " << rate
+                  << ", \"iterations\": " << result.iterations
+                  << ", \"items\": " << result.items
+                  << ", \"seconds\": " << result.seconds
+                  << ", \"ns_per_iteration\": " << result.seconds * 1e9 / static_cast<double>(result.iterations)
+                  << "}";
+        first = false;
+    }
+
+    std::cout << "\n  ]\n}\n";
+    return 0;
+}
@@ -0,0 +1,31 @@
+#include <cstdint>
+#include <vector>
+
+#include "bench_fixtures.hpp"
+#include "bench_harness.hpp"
+#include "channel_power.hpp"
+#include "dataset_spectrum.hpp"
+
+namespace {
+
+// Every LTE 5 MHz channel position on the 100 kHz raster across the
+// HackRF's range: several thousand overlapping channels, one update per
+// sweep
+uint64_t channel_power_update_full(uint64_t iterations) {
+    const std::vector<uint16_t> freq_ranges = bench::full_range();
+    const DatasetSpectrum spectrum = bench::filled_spectrum(freq_ranges);
+
+    const std::vector<ScanRange> ranges = {{freq_ranges[0], freq_ranges[1]}};
+    ChannelPowerEngine engine;
+    engine.configure(spectrum.get_layout(), make_band_plan(RadioTechnology::LTE, ranges, 5'000'000, 100'000));
+
+    for (uint64_t i = 0; i < iterations; ++i) {
+        engine.update(static_cast<int64_t>(i), spectrum.get_spectrum());
+    }
+    bench::do_not_optimize(engine.power_db().data());
+    return iterations;
+}
+
+}  // namespace
+
+BENCH_CASE(channel_power_update_full, "channel_power/update/1-6000MHz+LTE5", "sweeps");
@@ -0,0 +1,60 @@
+#include <cstdint>
+#include <vector>
+
+#include "bench_fixtures.hpp"
+#include "bench_harness.hpp"
+#include "dataset_spectrum.hpp"
+#include "pipeline_metrics.hpp"
+
+namespace {
+
+// Assembling a full-span sweep with the per-block instrumentation of
+// MainWindow::update_plot, to set against dataset_spectrum/add_new_data
+uint64_t assemble(bool instrumented, uint64_t iterations) {
+    static const std::vector<FFTSweepData> blocks = bench::make_sweep(bench::full_range());
+
+    DatasetSpectrum spectrum(bench::BIN_WIDTH_HZ, bench::full_range());
+    PipelineMetrics metrics;
+    metrics.set_enabled(instrumented);
+
+    const int64_t capture_ns = pipeline_now_ns();
+    uint64_t count = 0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        for (const FFTSweepData& block : blocks) {
+            metrics.count(PipelineCounter::BlocksReceived);
+
+            const PipelineTimer timer(metrics, PipelineTiming::Assembly);
+            metrics.record(PipelineTiming::QueueWait, capture_ns, timer.start_ns());
+            metrics.count(PipelineCounter::BlocksAssembled);
+
+            bench::add_block(spectrum, block);
+            ++count;
+        }
+    }
+    bench::do_not_optimize(spectrum.get_spectrum().data());
+    bench::do_not_optimize(metrics.snapshot().counters[0]);
+    return count;
+}
+
+uint64_t assemble_metrics_off(uint64_t iterations) {
+    return assemble(false, iterations);
+}
+
+uint64_t assemble_metrics_on(uint64_t iterations) {
+    return assemble(true, iterations);
+}
+
+uint64_t histogram_record(uint64_t iterations) {
+    LatencyHistogram histogram;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        histogram.record(i * 2654435761ULL >> 40);
+    }
+    bench::do_not_optimize(histogram.snapshot().count);
+    return iterations;
+}
+
+}  // namespace
+
+BENCH_CASE(assemble_metrics_off, "pipeline_metrics/assemble_disabled/1-6000MHz", "blocks");
+BENCH_CASE(assemble_metrics_on, "pipeline_metrics/assemble_enabled/1-6000MHz", "blocks");
+BENCH_CASE(histogram_record, "pipeline_metrics/histogram_record", "records");
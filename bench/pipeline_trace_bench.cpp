@@ -0,0 +1,36 @@
+#include <cstdint>
+
+#include "bench_harness.hpp"
+#include "pipeline_trace.hpp"
+
+namespace {
+
+// Cost of one span on the calling thread, with tracing off and on
+uint64_t trace_scope(bool tracing, uint64_t iterations) {
+    if (tracing) {
+        pipeline_trace_start();
+    }
+
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        PIPELINE_TRACE_SCOPE("bench span");
+        sum += i;
+        bench::do_not_optimize(sum);
+    }
+
+    pipeline_trace_stop();
+    return iterations;
+}
+
+uint64_t trace_scope_disabled(uint64_t iterations) {
+    return trace_scope(false, iterations);
+}
+
+uint64_t trace_scope_enabled(uint64_t iterations) {
+    return trace_scope(true, iterations);
+}
+
+}  // namespace
+
+BENCH_CASE(trace_scope_disabled, "pipeline_trace/scope_disabled", "spans");
+BENCH_CASE(trace_scope_enabled, "pipeline_trace/scope_enabled", "spans");
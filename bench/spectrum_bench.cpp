@@ -0,0 +1,163 @@
+#include <qwt_interval.h>
+
+#include <QRgb>
+#include <cstdint>
+#include <vector>
+
+#include "bench_fixtures.hpp"
+#include "bench_harness.hpp"
+#include "dataset_spectrum.hpp"
+#include "spectrum_series_data.hpp"
+#include "thermal_color_map.hpp"
+#include "waterfall_image_item.hpp"
+#include "waterfall_raster_data.hpp"
+
+namespace {
+
+uint64_t add_new_data(const std::vector<uint16_t>& freq_ranges, uint64_t iterations) {
+    const std::vector<FFTSweepData> blocks = bench::make_sweep(freq_ranges);
+    DatasetSpectrum spectrum(bench::BIN_WIDTH_HZ, freq_ranges);
+
+    uint64_t bins = 0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        for (const FFTSweepData& block : blocks) {
+            bench::add_block(spectrum, block);
+            bins += block.band_lower.power_db.size() + block.band_upper.power_db.size();
+        }
+    }
+    bench::do_not_optimize(spectrum.get_spectrum().data());
+    return bins;
+}
+
+uint64_t add_new_data_full(uint64_t iterations) {
+    return add_new_data(bench::full_range(), iterations);
+}
+
+uint64_t add_new_data_disjoint(uint64_t iterations) {
+    return add_new_data(bench::disjoint_ranges(), iterations);
+}
+
+// What the spectrum curve does on every replot: decimate the full span to a
+// 1920 pixel wide canvas, then hand the points to QwtPlotCurve.
+uint64_t curve_envelope_full(uint64_t iterations) {
+    constexpr int WIDTH = 1920;
+
+    const DatasetSpectrum spectrum = bench::filled_spectrum(bench::full_range());
+    SpectrumSeriesData series(&spectrum);
+
+    double sum = 0.0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        series.update_envelope(0.0, static_cast<double>(spectrum.get_layout().num_bins()), WIDTH);
+        for (size_t point = 0; point < series.size(); ++point) {
+            sum += series.sample(point).y();
+        }
+    }
+    bench::do_not_optimize(sum);
+    return iterations * WIDTH;
+}
+
+uint64_t waterfall_add_row(const std::vector<uint16_t>& freq_ranges, uint64_t iterations) {
+    const DatasetSpectrum spectrum = bench::filled_spectrum(freq_ranges);
+    WaterfallRasterData raster(bench::WATERFALL_ROWS, spectrum.get_total_num_datapoints(),
+                               static_cast<int>(bench::BIN_WIDTH_HZ), -90);
+
+    for (uint64_t i = 0; i < iterations; ++i) {
+        raster.addRow(spectrum);
+    }
+    bench::do_not_optimize(raster.value(0, 0));
+    return iterations;
+}
+
+uint64_t waterfall_add_row_full(uint64_t iterations) {
+    return waterfall_add_row(bench::full_range(), iterations);
+}
+
+uint64_t waterfall_add_row_disjoint(uint64_t iterations) {
+    return waterfall_add_row(bench::disjoint_ranges(), iterations);
+}
+
+uint64_t waterfall_image_add_row_full(uint64_t iterations) {
+    const DatasetSpectrum spectrum = bench::filled_spectrum(bench::full_range());
+    WaterfallImageItem image(bench::WATERFALL_ROWS, spectrum.get_total_num_datapoints(), QwtInterval(-90, -25));
+
+    for (uint64_t i = 0; i < iterations; ++i) {
+        image.addRow(spectrum);
+    }
+    return iterations;
+}
+
+// QwtPlotSpectrogram samples value() once per pixel of a 1920 x 300 canvas
+uint64_t waterfall_value_full(uint64_t iterations) {
+    constexpr int WIDTH = 1920;
+    constexpr int HEIGHT = bench::WATERFALL_ROWS;
+
+    const DatasetSpectrum spectrum = bench::filled_spectrum(bench::full_range());
+    const int cols = spectrum.get_total_num_datapoints();
+    WaterfallRasterData raster(HEIGHT, cols, static_cast<int>(bench::BIN_WIDTH_HZ), -90);
+    for (int row = 0; row < HEIGHT; ++row) {
+        raster.addRow(spectrum);
+    }
+
+    double sum = 0.0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        for (int y = 0; y < HEIGHT; ++y) {
+            for (int x = 0; x < WIDTH; ++x) {
+                sum += raster.value(static_cast<double>(x) * cols / WIDTH, y);
+            }
+        }
+    }
+    bench::do_not_optimize(sum);
+    return iterations * WIDTH * HEIGHT;
+}
+
+uint64_t thermal_rgb(uint64_t iterations) {
+    constexpr int VALUES = 4096;
+
+    const ThermalColorMap color_map;
+    const QwtInterval interval(-90, -25);
+
+    std::vector<double> values(VALUES);
+    for (int i = 0; i < VALUES; ++i) {
+        values[i] = -100.0 + 85.0 * i / VALUES;
+    }
+
+    QRgb acc = 0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        for (const double value : values) {
+            acc ^= color_map.rgb(interval, value);
+        }
+    }
+    bench::do_not_optimize(acc);
+    return iterations * VALUES;
+}
+
+uint64_t thermal_colorize(uint64_t iterations) {
+    constexpr int VALUES = 4096;
+
+    const ThermalColorMap color_map;
+    const QwtInterval interval(-90, -25);
+
+    std::vector<float> values(VALUES);
+    for (int i = 0; i < VALUES; ++i) {
+        values[i] = -100.0F + 85.0F * i / VALUES;
+    }
+
+    std::vector<QRgb> row(VALUES);
+    for (uint64_t i = 0; i < iterations; ++i) {
+        color_map.colorize(interval, values, row.data());
+        bench::do_not_optimize(row.data());
+    }
+    return iterations * VALUES;
+}
+
+}  // namespace
+
+BENCH_CASE(add_new_data_full, "dataset_spectrum/add_new_data/1-6000MHz", "bins");
+BENCH_CASE(add_new_data_disjoint, "dataset_spectrum/add_new_data/5x100MHz", "bins");
+BENCH_CASE(curve_envelope_full, "spectrum_series_data/update_envelope/1-6000MHz", "pixels");
+BENCH_CASE(waterfall_add_row_full, "waterfall_raster_data/add_row/1-6000MHz", "rows");
+BENCH_CASE(waterfall_add_row_disjoint, "waterfall_raster_data/add_row/5x100MHz", "rows");
+BENCH_CASE(waterfall_image_add_row_full, "waterfall_image_item/add_row/1-6000MHz", "rows");
+BENCH_CASE(waterfall_value_full, "waterfall_raster_data/value/1920x300", "pixels");
+BENCH_CASE(thermal_rgb, "thermal_color_map/rgb", "pixels");
+BENCH_CASE(thermal_colorize, "thermal_color_map/colorize", "pixels");
@@ -0,0 +1,31 @@
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "bench_fixtures.hpp"
+#include "bench_harness.hpp"
+#include "spectrum_layout.hpp"
+#include "spectrum_statistics.hpp"
+
+namespace {
+
+uint64_t statistics_update_full(uint64_t iterations) {
+    static const std::vector<FFTSweepData> blocks = bench::make_sweep(bench::full_range());
+
+    const SpectrumLayout layout(bench::BIN_WIDTH_HZ, bench::full_range());
+    SpectrumStatistics statistics(layout.num_bins());
+
+    uint64_t bins = 0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        bins += bench::update_bands(layout, blocks, [&statistics](size_t first_bin, std::span<const float> power_db) {
+                    statistics.update(first_bin, power_db);
+                }) *
+                bench::BINS_PER_BAND;
+    }
+    bench::do_not_optimize(statistics.noise_floor_db());
+    return bins;
+}
+
+}  // namespace
+
+BENCH_CASE(statistics_update_full, "spectrum_statistics/update/1-6000MHz", "bins");
@@ -0,0 +1,117 @@
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "bench_fixtures.hpp"
+#include "bench_harness.hpp"
+#include "sweep_codec.hpp"
+#include "sweep_record_format.hpp"
+#include "sweep_record_writer.hpp"
+
+namespace {
+
+constexpr int CODEC_SWEEPS = 8;
+
+// Consecutive full-span sweeps: a fixed noise floor plus fresh noise
+// per sweep, roughly what a quiet band looks like between sweeps.
+std::vector<std::vector<FFTSweepData>> make_sweeps() {
+    const std::vector<FFTSweepData> floor = bench::make_sweep(bench::full_range());
+
+    std::mt19937 rng(99);
+    std::normal_distribution<float> jitter(0.0F, 1.5F);
+
+    std::vector<std::vector<FFTSweepData>> sweeps(CODEC_SWEEPS, floor);
+    for (std::vector<FFTSweepData>& sweep : sweeps) {
+        for (FFTSweepData& block : sweep) {
+            for (FrequencyBand* band : {&block.band_lower, &block.band_upper}) {
+                for (float& value : band->power_db) {
+                    value += jitter(rng);
+                }
+            }
+        }
+    }
+    return sweeps;
+}
+
+// Encodes through SweepRecordWriter into /dev/null, so chunking and
+// keyframes are those of a real recording. The compression ratio is
+// reported once on stderr.
+uint64_t codec_encode(uint64_t iterations) {
+    static const std::vector<std::vector<FFTSweepData>> sweeps = make_sweeps();
+    static bool ratio_reported = false;
+
+    SweepRecordWriter writer;
+    uint64_t bins = 0;
+
+    for (uint64_t i = 0; i < iterations; ++i) {
+        if (!writer.open("/dev/null", sweep_record::PowerEncoding::RiceDelta, SWEEP_CODEC_DEFAULT_STEP_DB)) {
+            return 0;
+        }
+        writer.write_config(*sweeps.front().front().config);
+        for (const std::vector<FFTSweepData>& sweep : sweeps) {
+            for (const FFTSweepData& block : sweep) {
+                writer.write_block(block);
+                bins += block.band_lower.power_db.size() + block.band_upper.power_db.size();
+            }
+        }
+
+        if (!ratio_reported) {
+            std::cerr << "sweep_codec/encode: samples " << static_cast<double>(writer.raw_sample_bytes()) /
+                                                                static_cast<double>(writer.sample_bytes())
+                      << "x smaller than Float32\n";
+            ratio_reported = true;
+        }
+        writer.close();
+    }
+    return bins;
+}
+
+uint64_t codec_decode(uint64_t iterations) {
+    struct CodedBand {
+        uint64_t start_hz;
+        bool keyframe;
+        size_t offset;
+        size_t bytes;
+    };
+
+    static const std::vector<std::vector<FFTSweepData>> sweeps = make_sweeps();
+    static std::vector<std::byte> coded;
+    static std::vector<CodedBand> bands;
+
+    if (bands.empty()) {
+        SweepEncoder encoder;
+        for (const std::vector<FFTSweepData>& sweep : sweeps) {
+            for (const FFTSweepData& block : sweep) {
+                for (const FrequencyBand* band : {&block.band_lower, &block.band_upper}) {
+                    const size_t offset = coded.size();
+                    const bool keyframe = encoder.encode(band->start_hz, band->power_db, SWEEP_CODEC_DEFAULT_STEP_DB,
+                                                         coded);
+                    bands.push_back({band->start_hz, keyframe, offset, coded.size() - offset});
+                }
+            }
+        }
+    }
+
+    SweepDecoder decoder;
+    std::vector<float> out(bench::BINS_PER_BAND);
+    uint64_t bins = 0;
+
+    for (uint64_t i = 0; i < iterations; ++i) {
+        decoder.reset();
+        for (const CodedBand& band : bands) {
+            decoder.decode(band.start_hz, band.keyframe, std::span(coded).subspan(band.offset, band.bytes),
+                           SWEEP_CODEC_DEFAULT_STEP_DB, out);
+            bins += out.size();
+        }
+    }
+    bench::do_not_optimize(out.data());
+    return bins;
+}
+
+}  // namespace
+
+BENCH_CASE(codec_encode, "sweep_codec/encode/1-6000MHz", "bins");
+BENCH_CASE(codec_decode, "sweep_codec/decode/1-6000MHz", "bins");
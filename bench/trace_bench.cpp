@@ -0,0 +1,71 @@
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "bench_fixtures.hpp"
+#include "bench_harness.hpp"
+#include "dataset_spectrum.hpp"
+#include "trace_processor.hpp"
+
+namespace {
+
+// One trace fed every band of a full-span sweep; each item is one band
+// (BINS_PER_BAND bins), so the reported rate is the per-band cost.
+uint64_t trace_update(TraceKind kind, uint64_t iterations) {
+    static const std::vector<FFTSweepData> blocks = bench::make_sweep(bench::full_range());
+
+    DatasetSpectrum spectrum(bench::BIN_WIDTH_HZ, bench::full_range());
+    const SpectrumLayout& layout = spectrum.get_layout();
+
+    TraceProcessor trace(kind, layout.num_bins());
+    trace.set_decay_db(0.1F);
+
+    uint64_t bands = 0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        bands += bench::update_bands(layout, blocks, [&trace](size_t first_bin, std::span<const float> power_db) {
+            trace.update(first_bin, power_db);
+        });
+    }
+    bench::do_not_optimize(trace.values().data());
+    return bands;
+}
+
+uint64_t trace_max_hold_full(uint64_t iterations) {
+    return trace_update(TraceKind::MaxHold, iterations);
+}
+
+uint64_t trace_min_hold_full(uint64_t iterations) {
+    return trace_update(TraceKind::MinHold, iterations);
+}
+
+uint64_t trace_average_full(uint64_t iterations) {
+    return trace_update(TraceKind::Average, iterations);
+}
+
+// add_new_data with every trace enabled, to set against the plain
+// dataset_spectrum/add_new_data case
+uint64_t add_new_data_all_traces_full(uint64_t iterations) {
+    static const std::vector<FFTSweepData> blocks = bench::make_sweep(bench::full_range());
+
+    DatasetSpectrum spectrum(bench::BIN_WIDTH_HZ, bench::full_range());
+    spectrum.enable_trace(TraceKind::MaxHold);
+    spectrum.enable_trace(TraceKind::MinHold);
+    spectrum.enable_trace(TraceKind::Average);
+
+    uint64_t bins = 0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        for (const FFTSweepData& block : blocks) {
+            bench::add_block(spectrum, block);
+            bins += block.band_lower.power_db.size() + block.band_upper.power_db.size();
+        }
+    }
+    bench::do_not_optimize(spectrum.get_spectrum().data());
+    return bins;
+}
+
+}  // namespace
+
+BENCH_CASE(trace_max_hold_full, "trace_processor/max_hold/1-6000MHz", "bands");
+BENCH_CASE(trace_min_hold_full, "trace_processor/min_hold/1-6000MHz", "bands");
+BENCH_CASE(trace_average_full, "trace_processor/average/1-6000MHz", "bands");
+BENCH_CASE(add_new_data_all_traces_full, "dataset_spectrum/add_new_data+traces/1-6000MHz", "bins");
@@ -0,0 +1,53 @@
+#include <cstdint>
+#include <vector>
+
+#include "bench_fixtures.hpp"
+#include "bench_harness.hpp"
+#include "dataset_spectrum.hpp"
+#include "waterfall_history.hpp"
+
+namespace {
+
+constexpr int64_t SWEEP_INTERVAL_US = 300'000;
+constexpr int64_t SIX_HOURS_US = int64_t{6} * 3600 * 1'000'000;
+
+// What every completed sweep costs: one row into the hot ring plus the
+// max-pooling into the levels above
+uint64_t history_add_row_disjoint(uint64_t iterations) {
+    const DatasetSpectrum spectrum = bench::filled_spectrum(bench::disjoint_ranges());
+    WaterfallHistory history;
+    history.reset(spectrum.get_layout().num_bins());
+
+    for (uint64_t i = 0; i < iterations; ++i) {
+        history.add_row(static_cast<int64_t>(i) * SWEEP_INTERVAL_US, spectrum.get_spectrum());
+    }
+    return iterations;
+}
+
+// Zooming the waterfall out to six hours of sweeps, one every 300 ms. The
+// history is filled once and shared by every run.
+uint64_t history_read_six_hours(uint64_t iterations) {
+    static const DatasetSpectrum spectrum = bench::filled_spectrum(bench::disjoint_ranges());
+    static const WaterfallHistory& history = []() -> const WaterfallHistory& {
+        static WaterfallHistory filled;
+        filled.reset(spectrum.get_layout().num_bins());
+        for (int64_t t = 0; t <= SIX_HOURS_US; t += SWEEP_INTERVAL_US) {
+            filled.add_row(t, spectrum.get_spectrum());
+        }
+        return filled;
+    }();
+
+    WaterfallHistoryRows rows;
+    uint64_t total = 0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        history.read(history.newest_us() - SIX_HOURS_US, history.newest_us(), bench::WATERFALL_ROWS, rows);
+        total += rows.timestamps_us.size();
+    }
+    bench::do_not_optimize(rows.power.data());
+    return total;
+}
+
+}  // namespace
+
+BENCH_CASE(history_add_row_disjoint, "waterfall_history/add_row_disjoint", "rows");
+BENCH_CASE(history_read_six_hours, "waterfall_history/read_six_hours", "rows");
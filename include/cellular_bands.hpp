@@ -0,0 +1,66 @@
+#ifndef CELLULAR_BANDS_HPP
+#define CELLULAR_BANDS_HPP
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "spectrum_source.hpp"
+
+enum class RadioTechnology {
+    LTE,
+    NR,
+};
+
+// Downlink part of one 3GPP operating band together with its channel
+// raster: channel numbers first_arfcn, first_arfcn + arfcn_step, ... up to
+// last_arfcn (EARFCNs for LTE, NR-ARFCNs for NR).
+struct CellularBand {
+    RadioTechnology technology;
+    int number;
+    uint64_t dl_low_hz;
+    uint64_t dl_high_hz;
+    uint32_t first_arfcn;
+    uint32_t last_arfcn;
+    uint32_t arfcn_step;
+};
+
+// One channel whose power is integrated over [center - bandwidth / 2,
+// center + bandwidth / 2)
+struct CellularChannel {
+    RadioTechnology technology = RadioTechnology::LTE;
+    int band = 0;
+    uint32_t arfcn = 0;
+    uint64_t center_hz = 0;
+    uint32_t bandwidth_hz = 0;
+};
+
+// Bands in TS 36.101 table 5.7.3-1 and TS 38.104 table 5.4.2.3-1 that fall
+// inside the HackRF's tuning range
+std::span<const CellularBand> cellular_bands();
+
+// Band holding that downlink channel number; for NR the first of several
+// overlapping bands
+const CellularBand* find_cellular_band(RadioTechnology technology, uint32_t arfcn);
+
+// F_DL = F_DL_low + 0.1 MHz * (N_DL - N_Offs-DL) for LTE, the NR global
+// frequency raster for NR. Empty for numbers outside the table.
+std::optional<uint64_t> arfcn_to_hz(RadioTechnology technology, uint32_t arfcn);
+
+std::string channel_name(const CellularChannel& channel);
+
+// Channels of `bandwidth_hz` stepped by `step_hz` along the raster of every
+// band of that technology, kept only where they lie wholly inside the band
+// and the scan ranges. A step equal to the bandwidth tiles each band.
+std::vector<CellularChannel> make_band_plan(RadioTechnology technology,
+                                            const std::vector<ScanRange>& ranges,
+                                            uint32_t bandwidth_hz,
+                                            uint32_t step_hz);
+
+// Reads "LTE|NR, arfcn, bandwidth_mhz" lines; blank lines and lines
+// starting with '#' are skipped
+bool load_channel_plan(const std::string& path, std::vector<CellularChannel>& channels);
+
+#endif  // CELLULAR_BANDS_HPP
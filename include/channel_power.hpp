@@ -0,0 +1,78 @@
+#ifndef CHANNEL_POWER_HPP
+#define CHANNEL_POWER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "cellular_bands.hpp"
+#include "spectrum_layout.hpp"
+
+// Value reported for channels the layout does not cover at all
+constexpr float CHANNEL_NO_DATA_DB = -200.0F;
+
+// Sweeps of per-channel power kept for the time series
+constexpr size_t CHANNEL_HISTORY_SWEEPS = 600;
+
+// Integrated power of a set of cellular channels over a DatasetSpectrum's
+// bin space. configure() maps every channel onto bin spans once per
+// layout; update() then builds one prefix sum of linear bin power and
+// reads each channel off it with a subtraction per span, so a sweep costs
+// O(bins + channels) however many channels there are.
+//
+// Powers are the sum of the bins' linear power in dB, relative like the
+// bins themselves. A channel partly outside the scan ranges is integrated
+// over the part that is swept; coverage() says how much that is.
+class ChannelPowerEngine {
+   public:
+    void configure(const SpectrumLayout& layout, std::vector<CellularChannel> channels);
+
+    void update(int64_t timestamp_us, std::span<const float> spectrum_db);
+    void clear_history();
+
+    [[nodiscard]] const std::vector<CellularChannel>& channels() const noexcept {
+        return channels_;
+    }
+
+    [[nodiscard]] std::span<const float> power_db() const noexcept {
+        return power_db_;
+    }
+
+    // Fraction of the channel's bandwidth that falls on swept bins
+    [[nodiscard]] float coverage(size_t channel) const {
+        return coverage_[channel];
+    }
+
+    [[nodiscard]] size_t history_size() const noexcept {
+        return history_count_;
+    }
+
+    // Oldest first
+    void history(size_t channel, std::vector<int64_t>& timestamps_us, std::vector<float>& power_db) const;
+
+   private:
+    struct BinSpan {
+        uint32_t channel;
+        uint32_t first_bin;
+        uint32_t last_bin;  // Exclusive
+    };
+
+    std::vector<CellularChannel> channels_;
+    std::vector<BinSpan> spans_;  // Sorted by channel
+    std::vector<float> coverage_;
+    size_t num_bins_ = 0;
+
+    std::vector<float> linear_;
+    std::vector<double> prefix_;
+    std::vector<double> channel_linear_;
+    std::vector<float> power_db_;
+
+    // CHANNEL_HISTORY_SWEEPS rows of one power per channel, used as a ring
+    std::vector<float> history_;
+    std::vector<int64_t> history_timestamps_us_;
+    size_t history_head_ = 0;  // Row the next sweep goes to
+    size_t history_count_ = 0;
+};
+
+#endif  // CHANNEL_POWER_HPP
@@ -0,0 +1,41 @@
+#ifndef CHANNEL_POWER_MODEL_HPP
+#define CHANNEL_POWER_MODEL_HPP
+
+#include <QAbstractTableModel>
+#include <QModelIndex>
+#include <QObject>
+#include <QVariant>
+
+#include "channel_power.hpp"
+
+// Live table over a ChannelPowerEngine: one row per channel. reload()
+// follows a new channel set; refresh_power() only announces the power
+// column, so a frame with thousands of channels repaints just the rows on
+// screen.
+class ChannelPowerModel : public QAbstractTableModel {
+    Q_OBJECT
+
+   public:
+    enum Column {
+        ChannelColumn,
+        CenterColumn,
+        BandwidthColumn,
+        PowerColumn,
+        ColumnCount,
+    };
+
+    explicit ChannelPowerModel(const ChannelPowerEngine* engine, QObject* parent = nullptr);
+
+    void reload();
+    void refresh_power();
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+   private:
+    const ChannelPowerEngine* engine_;
+};
+
+#endif  // CHANNEL_POWER_MODEL_HPP
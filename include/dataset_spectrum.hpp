@@ -3,16 +3,28 @@
 
 #include <hackrf_sweeper.h>
 
-#include <QVector>
 #include <cstdint>
-#include <map>
+#include <optional>
+#include <span>
 #include <vector>
 
+#include "spectrum_decimator.hpp"
+#include "spectrum_layout.hpp"
+#include "spectrum_statistics.hpp"
+#include "trace_processor.hpp"
+
+// Value held by bins that have not been swept yet
+constexpr float SPECTRUM_NO_DATA_DB = -120.0F;
+
 class DatasetSpectrum {
    private:
     double fft_bin_size_hz;
     std::vector<uint16_t> freq_ranges;
-    std::map<uint64_t, float> spectrum;
+    SpectrumLayout layout;
+    std::vector<float> spectrum;
+    SpectrumDecimator decimator;
+    std::vector<TraceProcessor> traces;  // Updated with every block, in enable order
+    std::optional<SpectrumStatistics> statistics;
     bool initialized = false;
 
    public:
@@ -21,11 +33,29 @@ class DatasetSpectrum {
 
     int get_num_datapoints() const;
     int get_total_num_datapoints() const;
-    void add_new_data(uint64_t start_freq, uint64_t end_freq, const std::vector<float>& pwr);
-    std::map<uint64_t, float> get_spectrum() const;
-    QVector<double> get_power_array() const;
-    QVector<double> get_frequency_array() const;
+    void add_new_data(uint64_t start_freq, uint64_t end_freq, std::span<const float> pwr);
+    std::span<const float> get_spectrum() const;
+    const SpectrumLayout& get_layout() const;
+    double get_frequency(size_t bin) const;
+    MinMax get_min_max(size_t first_bin, size_t last_bin) const;
     void clear();
+
+    // Switches to new ranges on the same bin width. Bins the old and new
+    // ranges share keep their spectrum, traces and statistics; the rest
+    // start empty. Returns the bins carried over.
+    std::vector<BinRun> reconfigure(std::vector<uint16_t> freq_ranges);
+    bool has_config(double fft_bin_size_hz, const std::vector<uint16_t>& freq_ranges) const;
+
+    // Returns the existing trace of that kind if there is one
+    TraceProcessor& enable_trace(TraceKind kind);
+    void disable_trace(TraceKind kind);
+    TraceProcessor* get_trace(TraceKind kind);
+    const TraceProcessor* get_trace(TraceKind kind) const;
+    void reset_traces();
+
+    SpectrumStatistics& enable_statistics();
+    const SpectrumStatistics* get_statistics() const;
+
     bool is_initialized() const;
 };
 
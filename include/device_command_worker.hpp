@@ -0,0 +1,87 @@
+#ifndef DEVICE_COMMAND_WORKER_HPP
+#define DEVICE_COMMAND_WORKER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "hackrf_gain_state.hpp"
+#include "spectrum_source.hpp"
+
+enum class DeviceCommandKind {
+    Connect,
+    StartSweep,
+    StopSweep,
+    RestartSweep,
+    SetGain,
+    SetScanRanges,
+};
+
+struct DeviceCommandResult {
+    DeviceCommandKind kind = DeviceCommandKind::Connect;
+    bool ok = false;
+    uint64_t coalesced = 0;  // Earlier requests this one superseded
+
+    // What the source holds afterwards, filled in for SetGain / SetScanRanges
+    HackRFGainState gain;
+    std::vector<ScanRange> scan_ranges;
+};
+
+// Invoked on the worker thread once a command has run
+using DeviceCommandCallback = std::function<void(const DeviceCommandResult& result)>;
+
+// Runs every SpectrumSource operation that may block on USB I/O on one
+// dedicated thread, so callers only ever take the queue lock. Requests that
+// supersede each other are coalesced while still queued: a burst of gain or
+// scan range changes collapses into one write of the latest value, and
+// repeats of the same sweep control command collapse into one.
+class DeviceCommandWorker {
+   public:
+    explicit DeviceCommandWorker(SpectrumSource* source);
+    ~DeviceCommandWorker();
+
+    DeviceCommandWorker(const DeviceCommandWorker&) = delete;
+    DeviceCommandWorker& operator=(const DeviceCommandWorker&) = delete;
+
+    void set_completion_callback(DeviceCommandCallback callback);
+
+    // delay lets a freshly plugged device settle without blocking the caller
+    void connect_device(std::chrono::milliseconds delay = std::chrono::milliseconds(0));
+    void start_sweep();
+    void stop_sweep();
+    void restart_sweep();
+    void set_gain_state(const HackRFGainState& state);
+    void set_scan_ranges(const std::vector<ScanRange>& ranges);
+
+   private:
+    struct DeviceCommand {
+        DeviceCommandKind kind;
+        std::chrono::steady_clock::time_point not_before;
+        HackRFGainState gain;
+        std::vector<ScanRange> ranges;
+        uint64_t coalesced = 0;
+    };
+
+    void enqueue(DeviceCommand command);
+    void run();
+    DeviceCommandResult execute(const DeviceCommand& command);
+
+    SpectrumSource* source_;
+
+    // Held while the callback runs, so clearing it waits out a call in flight
+    std::mutex callback_mutex_;
+    DeviceCommandCallback completion_callback_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<DeviceCommand> pending_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+#endif  // DEVICE_COMMAND_WORKER_HPP
@@ -0,0 +1,37 @@
+#ifndef FREQUENCY_SCALE_HPP
+#define FREQUENCY_SCALE_HPP
+
+#include <qwt_scale_div.h>
+#include <qwt_scale_draw.h>
+#include <qwt_scale_engine.h>
+#include <qwt_text.h>
+
+#include "dataset_spectrum.hpp"
+
+// Axis for plots drawn in SpectrumLayout columns. Ticks land on round
+// frequencies inside each scanned range, with the step chosen from the
+// scanned bandwidth in view rather than the span the ranges cover.
+class FrequencyScaleEngine : public QwtLinearScaleEngine {
+   public:
+    explicit FrequencyScaleEngine(const DatasetSpectrum* spectrum);
+
+    QwtScaleDiv divideScale(double x1, double x2, int max_major_steps, int max_minor_steps,
+                            double step_size = 0.0) const override;
+
+   private:
+    const DatasetSpectrum* spectrum_;
+};
+
+// Labels columns with their frequency in MHz. Qwt caches labels, so call
+// invalidateCache() when the layout changes.
+class FrequencyScaleDraw : public QwtScaleDraw {
+   public:
+    explicit FrequencyScaleDraw(const DatasetSpectrum* spectrum);
+
+    QwtText label(double column) const override;
+
+   private:
+    const DatasetSpectrum* spectrum_;
+};
+
+#endif  // FREQUENCY_SCALE_HPP
@@ -4,12 +4,14 @@
 #include <libhackrf/hackrf.h>
 
 #include <cstdint>
-#include <functional>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <vector>
 
 #include "hackrf_gain_state.hpp"
+#include "snapshot_cell.hpp"
+#include "spectrum_source.hpp"
 
 extern "C" {
 #include <hackrf_sweeper.h>
@@ -17,6 +19,10 @@ extern "C" {
 
 constexpr int FFT_BIN_WIDTH_HZ = 50'000;
 
+// hackrf_sweeper rounds the FFT size up so that (size + 4) is a multiple of
+// 8; each sweep block carries a quarter of it per band.
+constexpr int FFT_BINS_PER_BAND_MAX = (DEFAULT_SAMPLE_RATE_HZ / FFT_BIN_WIDTH_HZ + 8) / 4;
+
 namespace hackrf_hardware {
 constexpr int VGA_MIN = 0;
 constexpr int VGA_MAX = 62;
@@ -27,31 +33,21 @@ constexpr int LNA_STEP = 8;
 constexpr int AMP_GAIN_DB = 14;
 }  // namespace hackrf_hardware
 
-struct ScanRange {
-    uint16_t start_mhz;
-    uint16_t end_mhz;
-};
-
-struct FrequencyBand {
-    uint64_t start_hz = 0;
-    uint64_t end_hz = 0;
-    std::vector<float> power_db;
-};
-
-struct FFTSweepData {
-    double bin_width_hz = 0.0;
-    int fft_size = 0;
-    std::vector<uint16_t> freq_ranges_mhz;
-    FrequencyBand band_lower;
-    FrequencyBand band_upper;
+// Everything the controller publishes to other threads, replaced as a whole
+// whenever one of the fields changes
+struct HackRFControllerState {
+    uint64_t generation = 0;
+    FFTCallback fft_callback;
+    HackRFGainState gain;
+    std::vector<ScanRange> scan_ranges;
+    std::shared_ptr<const SweepConfig> sweep_config;
 };
 
-using FFTCallback = std::function<void(const FFTSweepData& data)>;
-
-class HackRFController {
+class HackRFController : public SpectrumSource {
    public:
-    HackRFController();
-    ~HackRFController();
+    // An empty serial opens the first HackRF found
+    explicit HackRFController(std::string serial = {});
+    ~HackRFController() override;
 
     // Non-copyable, non-movable due to mutex and device handle
     HackRFController(const HackRFController&) = delete;
@@ -59,37 +55,60 @@ class HackRFController {
     HackRFController(HackRFController&&) = delete;
     HackRFController& operator=(HackRFController&&) = delete;
 
-    [[nodiscard]] bool is_connected() const;
-    bool connect_device();
+    [[nodiscard]] const std::string& serial() const noexcept;
 
-    void start_sweep();
-    void stop_sweep();
-    void restart_sweep();
+    [[nodiscard]] bool is_connected() const override;
+    bool connect_device() override;
 
-    void set_gain_state(const HackRFGainState& state);
-    [[nodiscard]] HackRFGainState get_gain_state() const;
-    void set_amp_enable(bool enable) noexcept;
-    void set_vga_gain(int gain);
-    void set_lna_gain(int gain);
+    void start_sweep() override;
+    void stop_sweep() override;
+    // hackrf_sweeper hands the range list to the firmware when a sweep
+    // starts, so new ranges take effect here
+    void restart_sweep() override;
 
-    void set_fft_callback(FFTCallback callback);
+    void set_gain_state(const HackRFGainState& state) override;
+    [[nodiscard]] HackRFGainState get_gain_state() const override;
+    void set_amp_enable(bool enable) noexcept override;
+    void set_vga_gain(int gain) override;
+    void set_lna_gain(int gain) override;
+
+    void set_fft_callback(FFTCallback callback) override;
     [[nodiscard]] FFTCallback get_fft_callback() const;
 
-    bool set_scan_ranges(const std::vector<ScanRange>& ranges);
-    [[nodiscard]] std::vector<ScanRange> get_scan_ranges() const;
+    bool set_scan_ranges(const std::vector<ScanRange>& ranges) override;
+    [[nodiscard]] std::vector<ScanRange> get_scan_ranges() const override;
+
+    [[nodiscard]] std::shared_ptr<const SweepConfig> get_sweep_config() const;
+
+    // Never blocks, so it is safe from any thread including the transfer thread
+    [[nodiscard]] std::shared_ptr<const HackRFControllerState> get_state() const noexcept;
+
+    // Called on the libhackrf transfer thread for every FFT block
+    void process_fft_block(const hackrf_sweep_state_t* state, uint64_t current_freq);
 
    private:
-    void update_device_gain();  // Must be called with mutex held
+    // The helpers below must be called with mutex held
+    void update_device_gain();
     bool update_device_scan_ranges();
-    void cleanup_device();  // Must be called with mutex held
+    void publish_sweep_config();
+    void cleanup_device();
+    void refresh_block_state();  // libhackrf thread only
 
+    const std::string serial_;
+
+    // Guards the device and serializes writers of state_; readers of state_
+    // never take it
+    mutable std::mutex mutex_;
     hackrf_device* device_ = nullptr;
     std::unique_ptr<hackrf_sweep_state_t> sweep_state_;
-    HackRFGainState gain_state_;
-    std::vector<ScanRange> scan_ranges_;
     bool sweeping_ = false;
-    mutable std::mutex mutex_;
-    FFTCallback fft_callback_;
+
+    SnapshotCell<HackRFControllerState> state_;
+
+    // Owned by the libhackrf transfer thread while sweeping
+    FFTSweepData sweep_block_;
+    std::shared_ptr<const HackRFControllerState> block_state_;
+    uint64_t block_generation_ = 0;
 };
 
 #endif  // HACKRF_CONTROLLER_HPP
@@ -5,37 +5,181 @@
 #include <qwt_matrix_raster_data.h>
 #include <qwt_plot.h>
 #include <qwt_plot_curve.h>
+#include <qwt_plot_marker.h>
 #include <qwt_plot_spectrogram.h>
 
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QElapsedTimer>
+#include <QLabel>
 #include <QLineEdit>
 #include <QListWidget>
 #include <QMainWindow>
 #include <QPushButton>
+#include <QSlider>
 #include <QSpinBox>
+#include <QTableView>
+#include <QTimer>
+#include <array>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
+#include "channel_power.hpp"
+#include "channel_power_model.hpp"
 #include "dataset_spectrum.hpp"
+#include "device_command_worker.hpp"
 #include "hackrf_controller.hpp"
+#include "pipeline_metrics.hpp"
+#include "recording_playback.hpp"
+#include "render_scheduler.hpp"
+#include "spectrum_series_data.hpp"
+#include "spectrum_source.hpp"
+#include "sweep_queue.hpp"
+#include "sweep_recorder.hpp"
+#include "trace_processor.hpp"
+#include "waterfall_history.hpp"
+#include "waterfall_image_item.hpp"
 #include "waterfall_raster_data.hpp"
 
 constexpr int COLOR_MAP_SAMPLES = 300;
+constexpr double WATERFALL_Z_MIN_DB = -90.0;
+constexpr double WATERFALL_Z_MAX_DB = -25.0;
+constexpr double AUTO_SCALE_MARGIN_DB = 3.0;
+constexpr double AUTO_SCALE_MIN_SPAN_DB = 20.0;
+constexpr double AUTO_SCALE_HYSTERESIS_DB = 1.0;
+constexpr double AUTO_SCALE_PEAK_PERCENTILE = 0.999;
+constexpr int AUTO_SCALE_INTERVAL_MS = 500;
+constexpr int METRICS_OVERLAY_INTERVAL_MS = 500;
+constexpr int HISTORY_REFRESH_MS = 1000;
+constexpr size_t SWEEP_QUEUE_CAPACITY = 1024;
+constexpr int SWEEP_DRAIN_INTERVAL_MS = 10;
+constexpr int PLAYBACK_TICK_MS = 15;
+constexpr int PLAYBACK_SLIDER_STEPS = 10000;
+constexpr size_t PLAYBACK_MAX_BANDS_PER_TICK = 50000;
+
+enum class WaterfallMode {
+    Image,   // WaterfallImageItem: rows colourized once, blitted on repaint
+    Raster,  // QwtPlotSpectrogram sampling WaterfallRasterData per pixel
+};
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
 
    public:
-    explicit MainWindow(HackRFController* controller, QWidget* parent = nullptr);
+    MainWindow(SpectrumSource* source, DeviceCommandWorker* commands, QWidget* parent = nullptr);
+    ~MainWindow() override;
+
+    // Instruments the pipeline and shows the overlay
+    void set_metrics_enabled(bool enabled);
+    [[nodiscard]] const PipelineMetrics& pipeline_metrics() const;
+
+    // False if the spill file could not be set up; RAM is used alone then
+    bool set_history_config(const WaterfallHistoryConfig& config);
 
    private:
     QwtPlot* custom_plot_ = nullptr;
     QwtPlotCurve* curve_ = nullptr;
+    SpectrumSeriesData* spectrum_series_ = nullptr;  // Owned by curve_
+
+    // One curve per TraceKind, drawn while its box is checked. The settings
+    // live in the widgets and are re-applied whenever the dataset is rebuilt.
+    std::array<QwtPlotCurve*, TRACE_KIND_COUNT> trace_curves_{};
+    std::array<SpectrumSeriesData*, TRACE_KIND_COUNT> trace_series_{};  // Owned by trace_curves_
+    std::array<QCheckBox*, TRACE_KIND_COUNT> trace_checks_{};
+    QDoubleSpinBox* trace_decay_spin_ = nullptr;
+    QSpinBox* trace_average_spin_ = nullptr;
 
     QwtPlot* color_plot_ = nullptr;
     QwtPlotSpectrogram* color_map_ = nullptr;
     WaterfallRasterData* raster_data_ = nullptr;
+    WaterfallImageItem* waterfall_image_ = nullptr;
+    WaterfallMode waterfall_mode_ = WaterfallMode::Image;
+
+    // Marks where the gaps between disjoint scan ranges were left out, on
+    // both plots. Rebuilt whenever the layout changes; the plots delete
+    // whatever is still attached when they go.
+    std::vector<QwtPlotMarker*> range_breaks_;
+
+    // Every completed sweep, kept far longer than the waterfall's
+    // COLOR_MAP_SAMPLES rows. While history_span_us_ is set the waterfall
+    // shows that span from here, refreshed every HISTORY_REFRESH_MS,
+    // instead of adding live rows.
+    WaterfallHistory waterfall_history_;
+    SpectrumLayout history_layout_;  // Live layout the history's columns follow
+    int64_t history_span_us_ = 0;
+    QElapsedTimer history_refresh_clock_;
+    QLabel* history_label_ = nullptr;
+
+    // Fixed, or follows the statistics' noise floor and peaks when auto
+    // scaling is on. Re-evaluated every AUTO_SCALE_INTERVAL_MS.
+    QwtInterval waterfall_z_interval_{WATERFALL_Z_MIN_DB, WATERFALL_Z_MAX_DB};
+    QCheckBox* auto_scale_check_ = nullptr;
+    QLabel* noise_floor_label_ = nullptr;
+    QElapsedTimer auto_scale_clock_;
 
     DatasetSpectrum dataset_spectrum_;
-    HackRFController* controller_ = nullptr;
+    SpectrumSource* source_ = nullptr;
+
+    // Every device operation goes through commands_; the widgets edit these
+    // GUI-side copies so they never wait on a source busy with USB I/O.
+    DeviceCommandWorker* commands_ = nullptr;
+    HackRFGainState gain_state_;
+    std::vector<ScanRange> scan_ranges_;
+
+    // Filled by the libhackrf thread, drained on the GUI thread by drain_timer_
+    SweepQueue sweep_queue_{SWEEP_QUEUE_CAPACITY, OverflowPolicy::DropOldest};
+    QTimer* drain_timer_ = nullptr;
+    QLabel* dropped_blocks_label_ = nullptr;
+    uint64_t reported_dropped_blocks_ = 0;
+
+    // Fed from the same producer callback as sweep_queue_
+    SweepRecorder recorder_;
+    QPushButton* record_btn_ = nullptr;
+    QComboBox* record_encoding_combo_ = nullptr;
+    QDoubleSpinBox* record_step_spin_ = nullptr;
+    QLabel* record_stats_label_ = nullptr;
+
+    // While a recording is open, live blocks are discarded and playback_timer_
+    // feeds the plots from the mapping instead
+    RecordingPlayback playback_;
+    std::shared_ptr<const SweepConfig> playback_config_;
+    QTimer* playback_timer_ = nullptr;
+    QElapsedTimer playback_clock_;
+    int64_t playback_position_us_ = 0;
+    double playback_speed_ = 1.0;
+    QPushButton* playback_play_btn_ = nullptr;
+    QPushButton* playback_live_btn_ = nullptr;
+    QComboBox* playback_speed_combo_ = nullptr;
+    QSlider* playback_slider_ = nullptr;
+    QLabel* playback_position_label_ = nullptr;
+
+    // Sweeps completed since the last frame, folded into one waterfall row
+    RenderScheduler* render_scheduler_ = nullptr;
+    QLabel* render_stats_label_ = nullptr;
+    std::vector<float> frame_peak_;
+    bool frame_peak_valid_ = false;
+
+    // Written by the producer callback and the GUI thread; off until the
+    // overlay is shown. frame_capture_ns_ is the newest block in the frame.
+    PipelineMetrics metrics_;
+    PipelineSnapshot metrics_overlay_snapshot_;
+    QCheckBox* metrics_check_ = nullptr;
+    QLabel* metrics_overlay_ = nullptr;
+    QElapsedTimer metrics_overlay_clock_;
+    QPushButton* trace_btn_ = nullptr;
+    int64_t frame_capture_ns_ = 0;
+
+    // Power of the selected cellular channel plan, integrated once per
+    // completed sweep; the table and the time series refresh per frame
+    ChannelPowerEngine channel_power_;
+    ChannelPowerModel* channel_model_ = nullptr;
+    std::vector<CellularChannel> loaded_channel_plan_;
+    QComboBox* channel_plan_combo_ = nullptr;
+    QTableView* channel_table_ = nullptr;
+    QwtPlot* channel_plot_ = nullptr;
+    QwtPlotCurve* channel_curve_ = nullptr;
 
     // Gain controls
     QLineEdit* total_gain_field_ = nullptr;
@@ -48,13 +192,46 @@ class MainWindow : public QMainWindow {
     QPushButton* remove_range_btn_ = nullptr;
     QPushButton* apply_ranges_btn_ = nullptr;
 
+    void drain_sweep_queue();
     void update_plot(const FFTSweepData& data);
+    void ensure_dataset(const SweepConfig& config);
+    void reconfigure_dataset(const SweepConfig& config);
+    void follow_live_layout();
+    void update_range_breaks();
+    void complete_sweep_if_started(const SweepConfig& config, uint64_t band_start_hz, int64_t timestamp_us);
+    void fold_completed_sweep();
+    void render_frame(int sweeps);
+    void refresh_spectrum_curve();
+    void apply_trace_settings();
+    void reset_traces();
+    void configure_channel_power();
+    void load_channel_plan_file();
+    void refresh_channel_power();
     void update_total_gain();
+    void handle_command_result(const DeviceCommandResult& result);
+    void reset_waterfall();
+    void update_noise_floor();
+    void update_metrics_overlay();
+    void save_pipeline_metrics();
+    void capture_trace(bool capture);
+    void set_waterfall_z_interval(const QwtInterval& interval);
+    void set_waterfall_mode(WaterfallMode mode);
+    void set_history_span(int64_t span_us);
+    void show_history();
     void setup_sidebar(QWidget* sidebar);
     void refresh_range_list();
     void add_scan_range();
     void remove_selected_range();
     void apply_scan_ranges();
+    void toggle_recording(bool record);
+    void update_record_stats();
+    void open_recording();
+    void return_to_live();
+    void set_playback_controls_enabled(bool enabled);
+    void set_playback_playing(bool playing);
+    void seek_playback(int slider_value);
+    void advance_playback();
+    void update_playback_position();
 };
 
 #endif  // MAIN_WINDOW_HPP
@@ -0,0 +1,37 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+// Read-only mapping of a whole file. Pages are faulted in on access, so
+// opening costs the same for a kilobyte and for many gigabytes.
+class MappedFile {
+   public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    [[nodiscard]] bool is_open() const noexcept {
+        return data_ != nullptr;
+    }
+
+    [[nodiscard]] const std::byte* data() const noexcept {
+        return data_;
+    }
+
+    [[nodiscard]] size_t size() const noexcept {
+        return size_;
+    }
+
+   private:
+    const std::byte* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+#endif  // MAPPED_FILE_HPP
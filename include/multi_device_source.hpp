@@ -0,0 +1,101 @@
+#ifndef MULTI_DEVICE_SOURCE_HPP
+#define MULTI_DEVICE_SOURCE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "hackrf_gain_state.hpp"
+#include "spectrum_source.hpp"
+#include "sweep_queue.hpp"
+
+constexpr size_t MULTI_DEVICE_QUEUE_CAPACITY = 1024;
+
+// How long the merge waits for a late device before handing out the oldest
+// block it holds; a little over one USB transfer's worth of blocks
+constexpr int64_t MULTI_DEVICE_REORDER_US = 50'000;
+constexpr auto MULTI_DEVICE_IDLE_SLEEP = std::chrono::milliseconds(1);
+
+// Sweeps with several radios at once. The scan ranges are split between
+// the devices by partition_scan_ranges(), each device sweeps its share on
+// its own transfer thread into its own queue, and a merge thread hands the
+// blocks to the FFT callback in timestamp order under one SweepConfig
+// covering every device's ranges. To the rest of the application this is
+// a single source with a faster sweep.
+class MultiDeviceSource : public SpectrumSource {
+   public:
+    explicit MultiDeviceSource(std::vector<std::unique_ptr<SpectrumSource>> devices);
+    ~MultiDeviceSource() override;
+
+    MultiDeviceSource(const MultiDeviceSource&) = delete;
+    MultiDeviceSource& operator=(const MultiDeviceSource&) = delete;
+
+    [[nodiscard]] size_t device_count() const noexcept;
+    [[nodiscard]] SpectrumSource& device(size_t index) const;
+    [[nodiscard]] std::vector<ScanRange> device_scan_ranges(size_t index) const;  // Empty if idle
+
+    // Connected once every device with ranges to sweep is
+    [[nodiscard]] bool is_connected() const override;
+    bool connect_device() override;
+
+    void start_sweep() override;
+    void stop_sweep() override;  // Returns once the stopped devices' blocks are handed out
+    void restart_sweep() override;
+
+    // Applied to every device
+    void set_gain_state(const HackRFGainState& state) override;
+    [[nodiscard]] HackRFGainState get_gain_state() const override;
+    void set_amp_enable(bool enable) noexcept override;
+    void set_vga_gain(int gain) override;
+    void set_lna_gain(int gain) override;
+
+    void set_fft_callback(FFTCallback callback) override;
+
+    // Repartitions the ranges; takes effect on the next (re)start
+    bool set_scan_ranges(const std::vector<ScanRange>& ranges) override;
+    [[nodiscard]] std::vector<ScanRange> get_scan_ranges() const override;
+
+   private:
+    struct Device {
+        std::unique_ptr<SweepQueue> queue;
+        std::unique_ptr<SpectrumSource> source;
+        std::vector<ScanRange> ranges;
+        std::atomic_bool sweeping{false};
+
+        // Merge thread only
+        FFTSweepData head;
+        bool has_head = false;
+        std::shared_ptr<const SweepConfig> config;
+    };
+
+    void run_merge();
+    bool merge_next(int64_t now_us);  // Merge thread only
+    void refresh_merged_config();     // Merge thread only
+    bool is_active(size_t index) const;  // Must be called with mutex held
+
+    std::vector<std::unique_ptr<Device>> devices_;
+    std::vector<ScanRange> scan_ranges_;
+    FFTCallback fft_callback_;
+    mutable std::mutex mutex_;
+
+    std::atomic<uint64_t> fft_callback_generation_{0};
+    std::atomic<size_t> held_blocks_{0};
+    std::atomic_bool merging_{false};
+
+    // Owned by the merge thread
+    FFTCallback merge_callback_;
+    uint64_t merge_callback_generation_ = 0;
+    std::shared_ptr<const SweepConfig> merged_config_;
+    uint64_t merged_generation_ = 0;
+    bool merged_config_stale_ = true;
+
+    std::thread thread_;
+    std::atomic_bool running_{false};
+};
+
+#endif  // MULTI_DEVICE_SOURCE_HPP
@@ -0,0 +1,148 @@
+#ifndef PIPELINE_METRICS_HPP
+#define PIPELINE_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Steady clock in nanoseconds, the time base of every pipeline timestamp
+int64_t pipeline_now_ns() noexcept;
+
+enum class PipelineCounter {
+    BlocksReceived,   // Handed over by the source's callback
+    BlocksDropped,    // Lost to a full queue
+    BlocksAssembled,  // Merged into the spectrum
+    SweepsCompleted,
+    FramesRendered,
+};
+
+enum class PipelineTiming {
+    QueueWait,        // Source callback to dequeue
+    Assembly,         // Merging one block into the spectrum
+    WaterfallInsert,  // Adding one waterfall row
+    Repaint,          // Replotting spectrum and waterfall
+    CaptureToScreen,  // Source callback of a frame's newest block to its repaint
+};
+
+constexpr size_t PIPELINE_COUNTER_COUNT = 5;
+constexpr size_t PIPELINE_TIMING_COUNT = 5;
+
+// Four buckets per power of two from 4 ns up to ~20 minutes, so every
+// bucket is within 25% of its values
+constexpr size_t LATENCY_BUCKET_COUNT = 160;
+
+struct LatencySnapshot {
+    uint64_t count = 0;
+    uint64_t sum_ns = 0;
+    uint64_t max_ns = 0;
+    std::array<uint64_t, LATENCY_BUCKET_COUNT> buckets{};
+
+    [[nodiscard]] double mean_ns() const noexcept;
+    [[nodiscard]] uint64_t percentile_ns(double fraction) const noexcept;  // Upper bound of its bucket
+};
+
+// Fixed-bucket histogram; recording is a few relaxed atomic adds from any thread
+class LatencyHistogram {
+   public:
+    void record(uint64_t ns) noexcept;
+    void reset() noexcept;
+    [[nodiscard]] LatencySnapshot snapshot() const noexcept;
+
+    static size_t bucket_index(uint64_t ns) noexcept;
+    static uint64_t bucket_upper_ns(size_t index) noexcept;
+
+   private:
+    std::array<std::atomic<uint64_t>, LATENCY_BUCKET_COUNT> buckets_{};
+    std::atomic<uint64_t> sum_ns_{0};
+    std::atomic<uint64_t> max_ns_{0};
+};
+
+struct PipelineSnapshot {
+    int64_t taken_ns = 0;
+    double elapsed_s = 0.0;  // Since the metrics were last reset
+    std::array<uint64_t, PIPELINE_COUNTER_COUNT> counters{};
+    std::array<LatencySnapshot, PIPELINE_TIMING_COUNT> timings{};
+
+    [[nodiscard]] uint64_t counter(PipelineCounter which) const noexcept {
+        return counters[static_cast<size_t>(which)];
+    }
+    [[nodiscard]] const LatencySnapshot& timing(PipelineTiming which) const noexcept {
+        return timings[static_cast<size_t>(which)];
+    }
+
+    // Counter rate per second between an earlier snapshot and this one
+    [[nodiscard]] double rate(PipelineCounter which, const PipelineSnapshot& earlier) const noexcept;
+};
+
+// Counters and latency histograms for the path from the source callback to
+// the screen. Shared by the producer and GUI threads without locks; while
+// disabled every call returns straight away.
+class PipelineMetrics {
+   public:
+    PipelineMetrics();
+
+    PipelineMetrics(const PipelineMetrics&) = delete;
+    PipelineMetrics& operator=(const PipelineMetrics&) = delete;
+
+    void set_enabled(bool enabled) noexcept;
+    [[nodiscard]] bool is_enabled() const noexcept {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    void count(PipelineCounter which, uint64_t amount = 1) noexcept {
+        if (is_enabled()) {
+            counters_[static_cast<size_t>(which)].fetch_add(amount, std::memory_order_relaxed);
+        }
+    }
+
+    void record(PipelineTiming which, int64_t start_ns, int64_t end_ns) noexcept {
+        if (is_enabled() && start_ns > 0 && end_ns >= start_ns) {
+            timings_[static_cast<size_t>(which)].record(static_cast<uint64_t>(end_ns - start_ns));
+        }
+    }
+
+    void reset() noexcept;
+    [[nodiscard]] PipelineSnapshot snapshot() const noexcept;
+
+    static const char* name(PipelineCounter which) noexcept;
+    static const char* name(PipelineTiming which) noexcept;
+
+   private:
+    std::atomic_bool enabled_{false};
+    std::atomic<int64_t> reset_ns_{0};
+    std::array<std::atomic<uint64_t>, PIPELINE_COUNTER_COUNT> counters_{};
+    std::array<LatencyHistogram, PIPELINE_TIMING_COUNT> timings_{};
+};
+
+// Times a scope into one histogram; reads the clock only while enabled
+class PipelineTimer {
+   public:
+    PipelineTimer(PipelineMetrics& metrics, PipelineTiming which) noexcept
+        : metrics_(metrics), which_(which), start_ns_(metrics.is_enabled() ? pipeline_now_ns() : 0) {}
+
+    ~PipelineTimer() {
+        if (start_ns_ > 0) {
+            metrics_.record(which_, start_ns_, pipeline_now_ns());
+        }
+    }
+
+    PipelineTimer(const PipelineTimer&) = delete;
+    PipelineTimer& operator=(const PipelineTimer&) = delete;
+
+    [[nodiscard]] int64_t start_ns() const noexcept {
+        return start_ns_;
+    }
+
+   private:
+    PipelineMetrics& metrics_;
+    const PipelineTiming which_;
+    const int64_t start_ns_;
+};
+
+// Totals, rates and percentiles, one object per counter and timing
+std::string pipeline_metrics_json(const PipelineSnapshot& snapshot);
+bool write_pipeline_metrics_json(const PipelineSnapshot& snapshot, const std::string& path);
+
+#endif  // PIPELINE_METRICS_HPP
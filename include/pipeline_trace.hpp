@@ -0,0 +1,68 @@
+#ifndef PIPELINE_TRACE_HPP
+#define PIPELINE_TRACE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "pipeline_metrics.hpp"
+
+// Spans kept per thread; older ones are overwritten once a thread wraps
+constexpr size_t PIPELINE_TRACE_EVENTS_PER_THREAD = 1 << 16;
+constexpr size_t PIPELINE_TRACE_MAX_THREADS = 64;
+
+// Opt-in span tracing for offline profiling. Every thread records into a
+// buffer of its own, so recording takes no lock and never waits on the
+// thread writing the file. The capture is written in the Chrome trace-event
+// format, which chrome://tracing and Perfetto open directly.
+//
+// Span and thread names must be string literals: only the pointer is kept.
+
+namespace pipeline_trace_detail {
+extern std::atomic_bool enabled;
+}  // namespace pipeline_trace_detail
+
+inline bool pipeline_trace_enabled() noexcept {
+    return pipeline_trace_detail::enabled.load(std::memory_order_relaxed);
+}
+
+// Discards what was captured so far and starts recording
+void pipeline_trace_start();
+void pipeline_trace_stop();
+
+// Names the calling thread in the trace; cheap to call repeatedly
+void pipeline_trace_set_thread_name(const char* name) noexcept;
+
+void pipeline_trace_record(const char* name, int64_t start_ns, int64_t end_ns) noexcept;
+
+// May be called while recording; the capture carries on
+bool pipeline_trace_write_json(const std::string& path);
+
+class PipelineTraceScope {
+   public:
+    explicit PipelineTraceScope(const char* name) noexcept
+        : name_(name), start_ns_(pipeline_trace_enabled() ? pipeline_now_ns() : 0) {}
+
+    ~PipelineTraceScope() {
+        if (start_ns_ > 0) {
+            pipeline_trace_record(name_, start_ns_, pipeline_now_ns());
+        }
+    }
+
+    PipelineTraceScope(const PipelineTraceScope&) = delete;
+    PipelineTraceScope& operator=(const PipelineTraceScope&) = delete;
+
+   private:
+    const char* name_;
+    const int64_t start_ns_;
+};
+
+#define PIPELINE_TRACE_CONCAT_(a, b) a##b
+#define PIPELINE_TRACE_CONCAT(a, b) PIPELINE_TRACE_CONCAT_(a, b)
+
+// Records the rest of the enclosing scope as one span
+#define PIPELINE_TRACE_SCOPE(name) \
+    const PipelineTraceScope PIPELINE_TRACE_CONCAT(pipeline_trace_scope_, __LINE__)(name)
+
+#endif  // PIPELINE_TRACE_HPP
@@ -0,0 +1,119 @@
+#ifndef RECORDING_PLAYBACK_HPP
+#define RECORDING_PLAYBACK_HPP
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "spectrum_source.hpp"
+#include "sweep_codec.hpp"
+#include "sweep_record_format.hpp"
+
+struct PlaybackBand {
+    int64_t timestamp_us = 0;
+    uint64_t start_hz = 0;
+    uint64_t end_hz = 0;
+    bool upper = false;               // Upper half of its FFT block
+    std::span<const float> power_db;  // Into the mapping for Float32 records
+};
+
+// Random access over a sweep_record file through a read-only mapping.
+// seek() binary-searches the footer index and then walks at most one
+// chunk; next() and previous() step one band record at a time in either
+// direction. Float32 samples are handed out in place, Int16 and RiceDelta
+// samples are expanded into a scratch buffer reused across calls. RiceDelta
+// chunks line up with index entries, so reverse play decodes one chunk
+// forward at a time and hands its bands out backwards.
+class RecordingPlayback {
+   public:
+    bool open(const std::string& path);
+    void close();
+
+    [[nodiscard]] bool is_open() const noexcept {
+        return file_.is_open();
+    }
+
+    [[nodiscard]] int64_t first_timestamp_us() const noexcept {
+        return first_timestamp_us_;
+    }
+
+    [[nodiscard]] int64_t last_timestamp_us() const noexcept {
+        return last_timestamp_us_;
+    }
+
+    [[nodiscard]] size_t file_size() const noexcept {
+        return file_.size();
+    }
+
+    [[nodiscard]] uint64_t dropped_blocks() const noexcept {
+        return dropped_blocks_;
+    }
+
+    // Blocks reported dropped by Drop records that next() stepped over since
+    // the last call
+    uint64_t take_passed_drops() noexcept {
+        const uint64_t drops = passed_drops_;
+        passed_drops_ = 0;
+        return drops;
+    }
+
+    // Sweep configuration of the band most recently returned
+    [[nodiscard]] const std::shared_ptr<const SweepConfig>& config() const noexcept {
+        return config_;
+    }
+
+    // Positions the cursor at the first band at or after timestamp_us
+    void seek(int64_t timestamp_us);
+
+    bool next(PlaybackBand& band);
+    bool previous(PlaybackBand& band);
+
+   private:
+    struct ReverseStep {
+        uint64_t band_offset;
+        uint64_t config_offset;
+        size_t first_sample;  // Into reverse_samples_ for RiceDelta bands
+    };
+
+    const sweep_record::RecordHeader* record_at(uint64_t offset) const;
+    const sweep_record::IndexHeader* index_header_at(uint64_t offset) const;
+    const sweep_record::IndexHeader* load_checkpoints();
+    bool rebuild_index();
+    void load_config(uint64_t offset);
+    void decode_band(uint64_t offset, PlaybackBand& band);
+    bool decode_rice(const sweep_record::RecordHeader& header, const sweep_record::BandRecord& record,
+                     std::span<float> out);
+    void resync_decoder();
+    bool fill_reverse_steps();
+
+    MappedFile file_;
+    uint64_t records_end_ = 0;
+
+    // Points into the mapping when the footer is intact, else into owned_index_
+    std::span<const sweep_record::IndexEntry> index_;
+    std::vector<sweep_record::IndexEntry> owned_index_;
+
+    int64_t first_timestamp_us_ = 0;
+    int64_t last_timestamp_us_ = 0;
+    uint64_t dropped_blocks_ = 0;
+    uint64_t passed_drops_ = 0;
+
+    uint64_t cursor_ = 0;        // Offset of the next record next() reads
+    uint64_t reverse_from_ = 0;  // Start of the band returned last; previous() steps back from it
+    uint64_t config_offset_ = 0;
+    std::shared_ptr<const SweepConfig> config_;
+
+    std::vector<ReverseStep> reverse_steps_;  // Band records of one chunk before reverse_from_
+    std::vector<float> reverse_samples_;
+    std::vector<float> scratch_;
+
+    // Holds the references for RiceDelta bands up to cursor_ unless reverse
+    // play has moved it elsewhere
+    SweepDecoder decoder_;
+    bool decoder_synced_ = true;
+};
+
+#endif  // RECORDING_PLAYBACK_HPP
@@ -0,0 +1,49 @@
+#ifndef RENDER_SCHEDULER_HPP
+#define RENDER_SCHEDULER_HPP
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <cstdint>
+
+constexpr int DEFAULT_TARGET_FPS = 30;
+
+// Decouples repainting from sweep arrival. Completed sweeps are only
+// counted here; frame_due fires at most once per frame interval, carrying
+// how many sweeps it stands for so the receiver can fold them into a
+// single frame. A target of 0 FPS follows the primary screen refresh rate.
+class RenderScheduler : public QObject {
+    Q_OBJECT
+
+   public:
+    explicit RenderScheduler(QObject* parent = nullptr);
+
+    void set_target_fps(int fps);
+    [[nodiscard]] double target_fps() const;
+
+    void sweep_completed();
+
+    [[nodiscard]] double achieved_fps() const;
+    [[nodiscard]] uint64_t frames() const;
+    // Sweeps folded into another sweep's frame instead of getting their own
+    [[nodiscard]] uint64_t dropped_frames() const;
+
+   signals:
+    void frame_due(int sweeps);
+
+   private:
+    void on_tick();
+
+    QTimer timer_;
+    double target_fps_ = DEFAULT_TARGET_FPS;
+    int pending_sweeps_ = 0;
+
+    uint64_t frames_ = 0;
+    uint64_t dropped_frames_ = 0;
+
+    QElapsedTimer fps_window_;
+    int frames_in_window_ = 0;
+    double achieved_fps_ = 0.0;
+};
+
+#endif  // RENDER_SCHEDULER_HPP
@@ -0,0 +1,92 @@
+#ifndef REPLAY_SOURCE_HPP
+#define REPLAY_SOURCE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hackrf_gain_state.hpp"
+#include "spectrum_source.hpp"
+
+enum class ReplayPace {
+    Original,          // Sleep to reproduce the recorded timestamps
+    AsFastAsPossible,  // Deliver blocks back to back
+};
+
+struct ReplayStats {
+    uint64_t blocks = 0;
+    uint64_t passes = 0;
+    double elapsed_s = 0.0;
+};
+
+using ReplayFinishedCallback = std::function<void(const ReplayStats& stats)>;
+
+// Plays back the CSV output of the stock hackrf_sweep tool
+// ("date, time, hz_low, hz_high, hz_bin_width, num_samples, dB, ...").
+// Lines sharing a timestamp come from the same tuning step and are paired
+// into the lower/upper bands of one FFTSweepData, exactly as the HackRF
+// callback would deliver them. Scan ranges are derived from the file.
+class ReplaySource : public SpectrumSource {
+   public:
+    ReplaySource(ReplayPace pace, bool loop);
+    ~ReplaySource() override;
+
+    ReplaySource(const ReplaySource&) = delete;
+    ReplaySource& operator=(const ReplaySource&) = delete;
+
+    bool open(const std::string& path);
+
+    [[nodiscard]] bool is_connected() const override;
+    bool connect_device() override;  // Succeeds once open() has read the file
+
+    void start_sweep() override;
+    void stop_sweep() override;
+    void restart_sweep() override;
+
+    // No hardware behind a replay: gain is remembered but has no effect
+    void set_gain_state(const HackRFGainState& state) override;
+    [[nodiscard]] HackRFGainState get_gain_state() const override;
+    void set_amp_enable(bool enable) noexcept override;
+    void set_vga_gain(int gain) override;
+    void set_lna_gain(int gain) override;
+
+    void set_fft_callback(FFTCallback callback) override;
+    void set_finished_callback(ReplayFinishedCallback callback);
+
+    // The recording fixes the ranges, so this only accepts the current ones
+    bool set_scan_ranges(const std::vector<ScanRange>& ranges) override;
+    [[nodiscard]] std::vector<ScanRange> get_scan_ranges() const override;
+    [[nodiscard]] bool applies_scan_ranges_live() const override;
+
+   private:
+    struct ReplayLine {
+        int64_t timestamp_us = 0;
+        FrequencyBand band;
+        double bin_width_hz = 0.0;
+    };
+
+    void run();
+    bool read_line(std::ifstream& file, ReplayLine& line);
+
+    std::string path_;
+    const ReplayPace pace_;
+    const bool loop_;
+
+    std::shared_ptr<const SweepConfig> sweep_config_;
+    std::vector<ScanRange> scan_ranges_;
+    HackRFGainState gain_state_;
+    FFTCallback fft_callback_;
+    ReplayFinishedCallback finished_callback_;
+    mutable std::mutex mutex_;
+
+    std::thread thread_;
+    std::atomic_bool running_{false};
+};
+
+#endif  // REPLAY_SOURCE_HPP
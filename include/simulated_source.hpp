@@ -0,0 +1,76 @@
+#ifndef SIMULATED_SOURCE_HPP
+#define SIMULATED_SOURCE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "hackrf_gain_state.hpp"
+#include "spectrum_source.hpp"
+
+// A HackRF sweeps roughly 400 tuning steps, 800 blocks, per second
+constexpr int SIMULATED_BLOCKS_PER_SECOND = 800;
+constexpr float SIMULATED_NOISE_DB = -95.0F;
+constexpr float SIMULATED_NOISE_SPREAD_DB = 2.0F;
+
+struct SimulatedCarrier {
+    uint64_t center_hz;
+    uint64_t bandwidth_hz;
+    float power_db;
+};
+
+// A HackRF without the hardware: sweeps the scan ranges on its own thread
+// with the tuning steps, band layout and pacing of hackrf_sweeper, and
+// fills the bands with noise and a few fixed carriers. Used to exercise
+// the pipeline, and the multi-device merge, without a radio attached.
+class SimulatedSource : public SpectrumSource {
+   public:
+    explicit SimulatedSource(uint32_t seed = 0);
+    ~SimulatedSource() override;
+
+    SimulatedSource(const SimulatedSource&) = delete;
+    SimulatedSource& operator=(const SimulatedSource&) = delete;
+
+    [[nodiscard]] bool is_connected() const override;
+    bool connect_device() override;
+
+    void start_sweep() override;
+    void stop_sweep() override;
+    void restart_sweep() override;
+
+    // Gain offsets the simulated levels the way it would a real front end
+    void set_gain_state(const HackRFGainState& state) override;
+    [[nodiscard]] HackRFGainState get_gain_state() const override;
+    void set_amp_enable(bool enable) noexcept override;
+    void set_vga_gain(int gain) override;
+    void set_lna_gain(int gain) override;
+
+    void set_fft_callback(FFTCallback callback) override;
+
+    bool set_scan_ranges(const std::vector<ScanRange>& ranges) override;
+    [[nodiscard]] std::vector<ScanRange> get_scan_ranges() const override;
+    [[nodiscard]] bool applies_scan_ranges_live() const override;
+
+   private:
+    void run();
+    void publish_sweep_config();  // Must be called with mutex held
+    void fill_band(FrequencyBand& band, const SweepConfig& config, uint64_t start_hz, float gain_db);  // Sweep thread only
+
+    uint64_t random_state_;  // Sweep thread only
+
+    bool connected_ = false;
+    std::shared_ptr<const SweepConfig> sweep_config_;
+    uint64_t sweep_config_generation_ = 0;
+    std::vector<ScanRange> scan_ranges_;
+    HackRFGainState gain_state_{false, 24, 0};
+    FFTCallback fft_callback_;
+    mutable std::mutex mutex_;
+
+    std::thread thread_;
+    std::atomic_bool running_{false};
+};
+
+#endif  // SIMULATED_SOURCE_HPP
@@ -0,0 +1,54 @@
+#ifndef SNAPSHOT_CELL_HPP
+#define SNAPSHOT_CELL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// Publishes read-mostly state as immutable versions. Readers take the
+// current version without locking and keep it alive for as long as they
+// hold it; a writer copies the current version, edits the copy and swaps
+// it in. Every version carries the generation it was published as, so all
+// fields a reader sees belong together.
+//
+// T needs a `uint64_t generation` member. Writers must be serialized by
+// the owner; readers may run on any thread.
+template <typename T>
+class SnapshotCell {
+   public:
+    using Snapshot = std::shared_ptr<const T>;
+
+    SnapshotCell() : value_(std::make_shared<const T>()) {}
+
+    SnapshotCell(const SnapshotCell&) = delete;
+    SnapshotCell& operator=(const SnapshotCell&) = delete;
+
+    [[nodiscard]] Snapshot load() const noexcept {
+        return value_.load(std::memory_order_acquire);
+    }
+
+    // Generation of the latest version, without touching the version
+    // itself; cheap enough to poll for every block
+    [[nodiscard]] uint64_t generation() const noexcept {
+        return generation_.load(std::memory_order_acquire);
+    }
+
+    template <typename Edit>
+    Snapshot update(Edit&& edit) {
+        T next = *value_.load(std::memory_order_relaxed);
+        std::forward<Edit>(edit)(next);
+        next.generation = generation_.load(std::memory_order_relaxed) + 1;
+
+        Snapshot published = std::make_shared<const T>(std::move(next));
+        value_.store(published, std::memory_order_release);
+        generation_.store(published->generation, std::memory_order_release);
+        return published;
+    }
+
+   private:
+    std::atomic<Snapshot> value_;
+    std::atomic<uint64_t> generation_{0};
+};
+
+#endif  // SNAPSHOT_CELL_HPP
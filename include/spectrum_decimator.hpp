@@ -0,0 +1,29 @@
+#ifndef SPECTRUM_DECIMATOR_HPP
+#define SPECTRUM_DECIMATOR_HPP
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+struct MinMax {
+    float min;
+    float max;
+};
+
+// Min/max pyramid over a flat bin array. Level k holds the envelope of
+// aligned blocks of 2^(k+1) bins, so the envelope of any bin range is
+// assembled from O(log n) nodes. Blocks only rebuild the nodes above the
+// bins they touched.
+class SpectrumDecimator {
+   public:
+    void reset(std::span<const float> bins);
+    void update(std::span<const float> bins, size_t first, size_t count);
+
+    // Envelope of bins [first, last); last must be greater than first
+    [[nodiscard]] MinMax range(std::span<const float> bins, size_t first, size_t last) const;
+
+   private:
+    std::vector<std::vector<MinMax>> levels_;
+};
+
+#endif  // SPECTRUM_DECIMATOR_HPP
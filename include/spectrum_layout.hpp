@@ -0,0 +1,93 @@
+#ifndef SPECTRUM_LAYOUT_HPP
+#define SPECTRUM_LAYOUT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// One configured scan range mapped onto the bin grid. Bin k of the segment
+// sits at start_hz + k * bin_width_hz.
+struct SpectrumSegment {
+    uint64_t start_hz = 0;
+    uint64_t end_hz = 0;
+    size_t first_bin = 0;
+    size_t num_bins = 0;
+};
+
+// Bins [from_bin, from_bin + count) of one layout that sit at the same
+// frequencies as [to_bin, to_bin + count) of another
+struct BinRun {
+    size_t from_bin = 0;
+    size_t to_bin = 0;
+    size_t count = 0;
+};
+
+// Maps the configured frequency ranges onto a single flat bin index space.
+// Segments are stored back to back in the order of freq_ranges, so the
+// index of a bin is its segment's first_bin plus its offset on the grid.
+//
+// The flat index is also the plot column: curves and waterfalls draw the
+// segments side by side, so the gaps between ranges cost neither memory
+// nor drawing. Column x covers [x, x + 1) and its left edge sits at
+// frequency_of_column(x).
+class SpectrumLayout {
+   public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    SpectrumLayout() = default;
+    SpectrumLayout(double bin_width_hz, const std::vector<uint16_t>& freq_ranges_mhz);
+
+    [[nodiscard]] bool empty() const noexcept {
+        return num_bins_ == 0;
+    }
+
+    [[nodiscard]] size_t num_bins() const noexcept {
+        return num_bins_;
+    }
+
+    [[nodiscard]] double bin_width_hz() const noexcept {
+        return bin_width_hz_;
+    }
+
+    [[nodiscard]] const std::vector<SpectrumSegment>& segments() const noexcept {
+        return segments_;
+    }
+
+    [[nodiscard]] uint64_t start_hz() const noexcept;
+    [[nodiscard]] uint64_t end_hz() const noexcept;
+
+    // Frequency of a flat bin index, in Hz.
+    [[nodiscard]] double frequency_at(size_t bin) const;
+
+    // Flat index of the bin containing freq_hz, or npos if it is not scanned.
+    [[nodiscard]] size_t bin_at(uint64_t freq_hz) const;
+
+    // Fractional columns; past either end the nearest segment is extended
+    [[nodiscard]] double frequency_of_column(double column) const;
+    [[nodiscard]] double column_of_frequency(double freq_hz) const;
+
+    // Bins this layout shares with `to`, in order of this layout's bins.
+    // Segments starting off each other's grid are matched to the nearest bin.
+    [[nodiscard]] std::vector<BinRun> shared_bins(const SpectrumLayout& to) const;
+
+   private:
+    double bin_width_hz_ = 0.0;
+    size_t num_bins_ = 0;
+    std::vector<SpectrumSegment> segments_;
+};
+
+// Carries per-bin values over to a layout of num_bins bins, in place; bins
+// without a counterpart in `runs` take `fill`
+template <typename T>
+void remap_bins(std::vector<T>& values, const std::vector<BinRun>& runs, size_t num_bins, const T& fill) {
+    std::vector<T> remapped(num_bins, fill);
+    for (const BinRun& run : runs) {
+        std::copy_n(values.begin() + static_cast<ptrdiff_t>(run.from_bin), run.count,
+                    remapped.begin() + static_cast<ptrdiff_t>(run.to_bin));
+    }
+    values = std::move(remapped);
+}
+
+#endif  // SPECTRUM_LAYOUT_HPP
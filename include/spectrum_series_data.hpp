@@ -0,0 +1,42 @@
+#ifndef SPECTRUM_SERIES_DATA_HPP
+#define SPECTRUM_SERIES_DATA_HPP
+
+#include <qwt_series_data.h>
+
+#include <QPointF>
+#include <QRectF>
+#include <optional>
+#include <vector>
+
+#include "dataset_spectrum.hpp"
+
+// Feeds QwtPlotCurve a view of a DatasetSpectrum sized to the plot rather
+// than to the spectrum. Where several bins fall into one pixel column the
+// column is drawn as a vertical min/max stroke taken from the spectrum's
+// decimation pyramid, so the point count tracks the canvas width and no
+// narrow peak is lost. Zoomed in past one bin per pixel, the raw bins are
+// passed through. Points are (plot column, power in dB), with columns as
+// laid out by SpectrumLayout.
+//
+// Constructed with a TraceKind it draws that trace of the spectrum instead,
+// and nothing while the trace is not enabled.
+class SpectrumSeriesData : public QwtSeriesData<QPointF> {
+   public:
+    explicit SpectrumSeriesData(const DatasetSpectrum* spectrum);
+    SpectrumSeriesData(const DatasetSpectrum* spectrum, TraceKind trace);
+
+    // Rebuilds the points for the visible plot columns [min_column,
+    // max_column] drawn across `pixels` pixels.
+    void update_envelope(double min_column, double max_column, int pixels);
+
+    size_t size() const override;
+    QPointF sample(size_t i) const override;
+    QRectF boundingRect() const override;
+
+   private:
+    const DatasetSpectrum* spectrum_;
+    std::optional<TraceKind> trace_;
+    std::vector<QPointF> points_;
+};
+
+#endif  // SPECTRUM_SERIES_DATA_HPP
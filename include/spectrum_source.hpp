@@ -0,0 +1,74 @@
+#ifndef SPECTRUM_SOURCE_HPP
+#define SPECTRUM_SOURCE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "hackrf_gain_state.hpp"
+
+struct ScanRange {
+    uint16_t start_mhz;
+    uint16_t end_mhz;
+};
+
+struct FrequencyBand {
+    uint64_t start_hz = 0;
+    uint64_t end_hz = 0;
+    std::vector<float> power_db;
+};
+
+// Description of the active sweep, rebuilt only when the FFT or the scan
+// ranges change and shared by every block swept under it.
+struct SweepConfig {
+    uint64_t generation = 0;
+    double bin_width_hz = 0.0;
+    int fft_size = 0;
+    std::vector<uint16_t> freq_ranges_mhz;
+};
+
+struct FFTSweepData {
+    std::shared_ptr<const SweepConfig> config;
+    int64_t timestamp_us = 0;  // Wall clock when the block was swept
+    int64_t capture_ns = 0;    // pipeline_now_ns() when the source delivered it
+
+    FrequencyBand band_lower;
+    FrequencyBand band_upper;
+};
+
+using FFTCallback = std::function<void(const FFTSweepData& data)>;
+
+// Anything that can produce sweep blocks for the GUI: a HackRF, or a
+// recording played back from disk. Blocks are delivered to the FFT
+// callback from a single producer thread owned by the source.
+class SpectrumSource {
+   public:
+    virtual ~SpectrumSource() = default;
+
+    [[nodiscard]] virtual bool is_connected() const = 0;
+    virtual bool connect_device() = 0;
+
+    virtual void start_sweep() = 0;
+    virtual void stop_sweep() = 0;
+    virtual void restart_sweep() = 0;
+
+    virtual void set_gain_state(const HackRFGainState& state) = 0;
+    [[nodiscard]] virtual HackRFGainState get_gain_state() const = 0;
+    virtual void set_amp_enable(bool enable) noexcept = 0;
+    virtual void set_vga_gain(int gain) = 0;
+    virtual void set_lna_gain(int gain) = 0;
+
+    virtual void set_fft_callback(FFTCallback callback) = 0;
+
+    virtual bool set_scan_ranges(const std::vector<ScanRange>& ranges) = 0;
+    [[nodiscard]] virtual std::vector<ScanRange> get_scan_ranges() const = 0;
+
+    // Whether a running sweep follows set_scan_ranges() by itself, or only
+    // picks the new ranges up on restart_sweep()
+    [[nodiscard]] virtual bool applies_scan_ranges_live() const {
+        return false;
+    }
+};
+
+#endif  // SPECTRUM_SOURCE_HPP
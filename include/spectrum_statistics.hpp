@@ -0,0 +1,88 @@
+#ifndef SPECTRUM_STATISTICS_HPP
+#define SPECTRUM_STATISTICS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "spectrum_layout.hpp"
+
+// Histogram buckets cover [STATS_MIN_DB, STATS_MAX_DB) in STATS_BUCKET_DB
+// steps; values outside land in the first or last bucket.
+constexpr float STATS_MIN_DB = -140.0F;
+constexpr float STATS_MAX_DB = 20.0F;
+constexpr float STATS_BUCKET_DB = 0.5F;
+constexpr size_t STATS_BUCKETS = static_cast<size_t>((STATS_MAX_DB - STATS_MIN_DB) / STATS_BUCKET_DB);
+
+// Neighbouring bins sharing one noise-floor histogram
+constexpr size_t STATS_CELL_BINS = 256;
+
+// Sweeps of history the histograms and the mean/variance roughly span;
+// older sweeps fade out instead of being kept forever
+constexpr uint32_t STATS_HISTORY_SWEEPS = 256;
+
+// Fraction of samples below the noise floor. Carriers occupy the top of
+// each cell's distribution, so a low percentile tracks the floor beneath
+// them.
+constexpr double STATS_NOISE_FLOOR_PERCENTILE = 0.2;
+
+// Incremental per-bin statistics over the flat bin space of a
+// DatasetSpectrum, fed block by block.
+//
+// Mean and variance use Welford's update with the weight capped at
+// STATS_HISTORY_SWEEPS, after which it becomes an exponential moving
+// mean/variance. The noise floor comes from fixed-size dB histograms, one
+// per STATS_CELL_BINS bins plus one over the whole span, whose counts are
+// halved whenever they pass STATS_HISTORY_SWEEPS samples per bin. All
+// memory is allocated up front and an update is O(bins in the block).
+class SpectrumStatistics {
+   public:
+    explicit SpectrumStatistics(size_t num_bins);
+
+    void update(size_t first_bin, std::span<const float> power_db);
+    void reset();
+
+    // Keeps the per-bin statistics carried over by `runs`. A new cell takes
+    // the histogram of the old cell its first carried bin came from, and
+    // the span-wide histogram is kept as it is.
+    void remap(const std::vector<BinRun>& runs, size_t num_bins);
+
+    [[nodiscard]] size_t num_bins() const noexcept {
+        return mean_.size();
+    }
+
+    [[nodiscard]] std::span<const float> mean() const noexcept {
+        return mean_;
+    }
+
+    // Zero until the bin has been swept twice
+    [[nodiscard]] std::span<const float> variance() const noexcept {
+        return variance_;
+    }
+
+    [[nodiscard]] uint32_t count(size_t bin) const {
+        return count_[bin];
+    }
+
+    // Noise floor of the cell holding `bin`, or STATS_MIN_DB before any data
+    [[nodiscard]] float noise_floor_db(size_t bin) const;
+
+    // Over the whole span
+    [[nodiscard]] float noise_floor_db() const;
+    [[nodiscard]] float percentile_db(double fraction) const;
+
+   private:
+    static float percentile(std::span<const uint32_t> histogram, uint64_t total, double fraction);
+
+    std::vector<float> mean_;
+    std::vector<float> variance_;
+    std::vector<uint32_t> count_;
+
+    std::vector<uint32_t> cell_histograms_;  // STATS_BUCKETS per cell
+    std::vector<uint64_t> cell_totals_;
+    std::vector<uint32_t> histogram_;
+    uint64_t total_ = 0;
+};
+
+#endif  // SPECTRUM_STATISTICS_HPP
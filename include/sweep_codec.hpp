@@ -0,0 +1,44 @@
+#ifndef SWEEP_CODEC_HPP
+#define SWEEP_CODEC_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+constexpr float SWEEP_CODEC_DEFAULT_STEP_DB = 0.1F;
+
+// Lossy band compression for recordings. Power is quantized to step_db,
+// predicted from the previous band with the same start frequency (or from
+// the neighbouring bin for a keyframe), and the zigzagged residuals are
+// Rice coded with one parameter per band:
+//
+//   uint8_t k, then per bin: unary(residual >> k), residual & ((1 << k) - 1)
+//
+// A unary run of RICE_ESCAPE ones is followed by the residual in
+// RICE_ESCAPE_BITS raw bits instead. Calling reset() on both ends at the
+// same record makes everything after it decodable on its own.
+class SweepEncoder {
+   public:
+    // Appends the coded band to out. Returns true for a keyframe.
+    bool encode(uint64_t start_hz, std::span<const float> power_db, float step_db, std::vector<std::byte>& out);
+    void reset();
+
+   private:
+    std::unordered_map<uint64_t, std::vector<int16_t>> previous_;
+    std::vector<uint32_t> residuals_;
+};
+
+class SweepDecoder {
+   public:
+    // Fills out (sized to the band's bin count). Fails for a delta band
+    // whose reference was never decoded, or for a truncated payload.
+    bool decode(uint64_t start_hz, bool keyframe, std::span<const std::byte> in, float step_db, std::span<float> out);
+    void reset();
+
+   private:
+    std::unordered_map<uint64_t, std::vector<int16_t>> previous_;
+};
+
+#endif  // SWEEP_CODEC_HPP
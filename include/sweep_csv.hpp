@@ -0,0 +1,13 @@
+#ifndef SWEEP_CSV_HPP
+#define SWEEP_CSV_HPP
+
+#include <string>
+
+#include "spectrum_source.hpp"
+
+// Appends one line per band in the output format of the stock hackrf_sweep
+// tool ("date, time, hz_low, hz_high, hz_bin_width, num_samples, dB, ..."),
+// which ReplaySource reads back. Times are UTC.
+void append_sweep_csv(std::string& out, const FFTSweepData& data);
+
+#endif  // SWEEP_CSV_HPP
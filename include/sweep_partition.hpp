@@ -0,0 +1,24 @@
+#ifndef SWEEP_PARTITION_HPP
+#define SWEEP_PARTITION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "spectrum_source.hpp"
+
+// hackrf_sweeper retunes in steps of the sample rate and widens every range
+// to whole steps, so sweep time grows with the number of steps
+constexpr uint16_t SWEEP_TUNE_STEP_MHZ = 20;
+
+// Tuning steps needed to sweep the ranges once
+uint32_t sweep_tune_steps(const std::vector<ScanRange>& ranges);
+
+// Splits the scan ranges between `devices` radios so each sweeps about the
+// same number of tuning steps. Overlapping ranges are merged first; each
+// device then gets a contiguous run of the spectrum, cut on tuning-step
+// boundaries so no step is swept twice. Devices beyond the number of steps
+// get no ranges.
+std::vector<std::vector<ScanRange>> partition_scan_ranges(const std::vector<ScanRange>& ranges, size_t devices);
+
+#endif  // SWEEP_PARTITION_HPP
@@ -0,0 +1,95 @@
+#ifndef SWEEP_QUEUE_HPP
+#define SWEEP_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "hackrf_controller.hpp"
+
+enum class OverflowPolicy {
+    DropOldest,  // Producer discards the oldest queued block to make room
+    DropNewest,  // Producer discards the block it is trying to push
+};
+
+struct SweepQueueStats {
+    uint64_t pushed = 0;
+    uint64_t dropped_oldest = 0;
+    uint64_t dropped_newest = 0;
+
+    [[nodiscard]] uint64_t dropped() const noexcept {
+        return dropped_oldest + dropped_newest;
+    }
+};
+
+// Bounded single-producer/single-consumer queue of sweep blocks.
+//
+// All slots are allocated up front with room for bins_per_band powers per
+// band, and push() copies into a recycled slot, so the producer neither
+// locks nor allocates. Slots circulate between a ready
+// ring (producer -> consumer) and a free ring (consumer -> producer). Under
+// DropOldest the producer may also pop from the head of the ready ring,
+// which is why the ready head is advanced with compare-and-swap.
+class SweepQueue {
+   public:
+    SweepQueue(size_t capacity, OverflowPolicy policy, size_t bins_per_band = FFT_BINS_PER_BAND_MAX);
+
+    SweepQueue(const SweepQueue&) = delete;
+    SweepQueue& operator=(const SweepQueue&) = delete;
+
+    // Producer side. Returns false if the block was dropped.
+    bool push(const FFTSweepData& data);
+
+    // Consumer side. Invokes fn for up to max_blocks queued blocks in FIFO
+    // order and returns the number handed out.
+    template <typename Fn>
+    size_t drain(Fn&& fn, size_t max_blocks = std::numeric_limits<size_t>::max()) {
+        size_t drained = 0;
+        uint32_t slot = 0;
+        while (drained < max_blocks && pop_ready(slot)) {
+            fn(static_cast<const FFTSweepData&>(slots_[slot]));
+            push_free(slot);
+            ++drained;
+        }
+        return drained;
+    }
+
+    [[nodiscard]] size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    [[nodiscard]] OverflowPolicy overflow_policy() const noexcept {
+        return policy_;
+    }
+
+    [[nodiscard]] size_t size() const noexcept;
+    [[nodiscard]] SweepQueueStats stats() const noexcept;
+
+   private:
+    bool pop_ready(uint32_t& slot);       // Consumer
+    void push_free(uint32_t slot);        // Consumer
+    bool pop_free(uint32_t& slot);        // Producer
+    bool steal_oldest(uint32_t& slot);    // Producer, DropOldest only
+
+    const size_t capacity_;
+    const OverflowPolicy policy_;
+
+    // capacity_ + 1 slots: capacity_ queued plus the one the consumer holds.
+    std::vector<FFTSweepData> slots_;
+
+    std::vector<std::atomic<uint32_t>> ready_;
+    alignas(64) std::atomic<uint64_t> ready_head_{0};
+    alignas(64) std::atomic<uint64_t> ready_tail_{0};
+
+    std::vector<std::atomic<uint32_t>> free_;
+    alignas(64) std::atomic<uint64_t> free_head_{0};
+    alignas(64) std::atomic<uint64_t> free_tail_{0};
+
+    alignas(64) std::atomic<uint64_t> pushed_{0};
+    std::atomic<uint64_t> dropped_oldest_{0};
+    std::atomic<uint64_t> dropped_newest_{0};
+};
+
+#endif  // SWEEP_QUEUE_HPP
@@ -0,0 +1,139 @@
+#ifndef SWEEP_RECORD_FORMAT_HPP
+#define SWEEP_RECORD_FORMAT_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// On-disk layout of a sweep recording, in host byte order:
+//
+//   FileHeader
+//   RecordHeader + payload, repeated (Config, Band, Drop, checkpoint Index)
+//   RecordHeader + IndexHeader + IndexEntry[]  (whole index, written on close)
+//   Footer                                     (fixed size, always the last bytes)
+//
+// Every record payload is padded to RECORD_ALIGNMENT so the structs and
+// power samples can be used in place from a memory mapping. While
+// recording, every periodic flush checkpoints the index entries of the
+// chunks completed since the previous checkpoint in an Index record that
+// points back to that one. A file without a valid footer was not closed
+// cleanly: its newest checkpoint is found from the end, the chain gives
+// the index up to there, and only the records after it are walked.
+namespace sweep_record {
+
+// One index entry per chunk, an independent RiceDelta run: the encoder
+// resets at every entry. A chunk ends at the first sweep boundary after
+// both INDEX_STRIDE_BANDS band records and INDEX_CHUNK_MIN_SWEEPS sweeps,
+// so only its first sweep is keyframes and every later band is coded
+// against the previous sweep of its range. INDEX_MAX_CHUNK_BANDS bounds
+// chunks whose sweeps never restart.
+constexpr uint64_t INDEX_STRIDE_BANDS = 512;
+constexpr uint64_t INDEX_CHUNK_MIN_SWEEPS = 8;
+constexpr uint64_t INDEX_MAX_CHUNK_BANDS = 64 * INDEX_STRIDE_BANDS;
+
+constexpr std::array<char, 8> FILE_MAGIC = {'H', 'R', 'F', 'S', 'W', 'E', 'E', 'P'};
+constexpr std::array<char, 8> FOOTER_MAGIC = {'H', 'R', 'F', 'S', 'I', 'D', 'X', '1'};
+constexpr std::array<char, 8> INDEX_MAGIC = {'H', 'R', 'F', 'S', 'I', 'D', 'X', 'C'};
+constexpr uint32_t FORMAT_VERSION = 2;
+constexpr size_t RECORD_ALIGNMENT = 8;
+
+enum class RecordType : uint32_t {
+    Config = 1,  // ConfigRecord + uint16_t freq_ranges_mhz[num_ranges * 2]
+    Band = 2,    // BandRecord + power samples in BandRecord::encoding
+    Drop = 3,    // DropRecord
+    Index = 4,   // IndexHeader + IndexEntry[entries]
+};
+
+enum class PowerEncoding : uint16_t {
+    Float32 = 0,    // dB as float
+    Int16 = 1,      // dB = offset_db + sample * step_db
+    RiceDelta = 2,  // SweepEncoder output at step_db, see sweep_codec.hpp
+};
+
+constexpr uint16_t BAND_FLAG_UPPER = 1;     // Upper half of its FFT block
+constexpr uint16_t BAND_FLAG_KEYFRAME = 2;  // RiceDelta band coded without a reference
+constexpr uint16_t BAND_FLAG_CHUNK_START = 4;  // First band of a chunk, where the encoder was reset
+
+struct FileHeader {
+    std::array<char, 8> magic;
+    uint32_t version;
+    uint32_t header_bytes;
+    int64_t created_us;
+};
+
+struct RecordHeader {
+    uint32_t type;
+    uint32_t payload_bytes;  // Including the padding
+};
+
+struct ConfigRecord {
+    uint64_t generation;
+    double bin_width_hz;
+    int32_t fft_size;
+    uint32_t num_ranges;
+};
+
+struct BandRecord {
+    int64_t timestamp_us;
+    uint64_t start_hz;
+    uint64_t end_hz;
+    double bin_width_hz;
+    uint32_t num_bins;
+    uint16_t encoding;
+    uint16_t flags;
+    float offset_db;
+    float step_db;
+};
+
+// The writer fell behind and discarded blocks after after_timestamp_us
+struct DropRecord {
+    int64_t after_timestamp_us;
+    uint64_t dropped_blocks;
+};
+
+struct IndexEntry {
+    int64_t timestamp_us;     // First band record covered by the entry
+    uint64_t offset;          // File offset of that record's RecordHeader
+    uint64_t config_offset;   // Config record in effect at offset
+    uint64_t min_start_hz;    // Frequency extent of the covered records
+    uint64_t max_end_hz;
+};
+
+// Head of every Index record. Records from resume_offset on are not
+// covered by the index chain up to and including this record.
+struct IndexHeader {
+    std::array<char, 8> magic;      // INDEX_MAGIC, found by scanning back from the end
+    uint64_t previous_offset;       // RecordHeader of the previous Index record, 0 for none
+    uint64_t first_entry;           // Position of the first entry in the whole index
+    uint64_t entries;
+    uint64_t resume_offset;         // First record to walk after the chain
+    uint64_t resume_config_offset;  // Config record in effect at resume_offset
+    uint64_t dropped_blocks;        // Reported by Drop records before resume_offset
+};
+
+struct Footer {
+    uint64_t index_offset;  // RecordHeader of the Index record
+    uint64_t index_entries;
+    uint64_t band_records;
+    uint64_t dropped_blocks;
+    int64_t first_timestamp_us;
+    int64_t last_timestamp_us;
+    std::array<char, 8> magic;
+};
+
+static_assert(sizeof(FileHeader) == 24);
+static_assert(sizeof(RecordHeader) == 8);
+static_assert(sizeof(ConfigRecord) == 24);
+static_assert(sizeof(BandRecord) == 48);
+static_assert(sizeof(DropRecord) == 16);
+static_assert(sizeof(IndexEntry) == 40);
+static_assert(sizeof(IndexHeader) == 56);
+static_assert(sizeof(Footer) == 56);
+
+constexpr size_t padded_size(size_t bytes) {
+    return (bytes + RECORD_ALIGNMENT - 1) / RECORD_ALIGNMENT * RECORD_ALIGNMENT;
+}
+
+}  // namespace sweep_record
+
+#endif  // SWEEP_RECORD_FORMAT_HPP
@@ -0,0 +1,99 @@
+#ifndef SWEEP_RECORD_WRITER_HPP
+#define SWEEP_RECORD_WRITER_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "spectrum_source.hpp"
+#include "sweep_codec.hpp"
+#include "sweep_record_format.hpp"
+
+constexpr size_t RECORD_WRITER_BUFFER_BYTES = 4 * 1024 * 1024;
+constexpr float RECORD_WRITER_DEFAULT_STEP_DB = 0.01F;
+
+// Synchronous sweep_record writer: records are staged in one large buffer
+// and handed to the file in RECORD_WRITER_BUFFER_BYTES writes. Used from a
+// single thread.
+class SweepRecordWriter {
+   public:
+    SweepRecordWriter();
+    ~SweepRecordWriter();
+
+    SweepRecordWriter(const SweepRecordWriter&) = delete;
+    SweepRecordWriter& operator=(const SweepRecordWriter&) = delete;
+
+    // step_db applies to Int16 and RiceDelta samples
+    bool open(const std::string& path,
+              sweep_record::PowerEncoding encoding = sweep_record::PowerEncoding::Float32,
+              float step_db = RECORD_WRITER_DEFAULT_STEP_DB);
+    // Writes the whole index and the footer
+    bool close();
+
+    [[nodiscard]] bool is_open() const noexcept {
+        return file_ != nullptr;
+    }
+
+    // Emits a Config record first if the block's config is new
+    void write_block(const FFTSweepData& data);
+    void write_config(const SweepConfig& config);
+    void write_band(int64_t timestamp_us, uint64_t start_hz, uint64_t end_hz, double bin_width_hz,
+                    std::span<const float> power_db, bool upper);
+    void write_drop(uint64_t dropped_blocks);
+    void flush();
+
+    // Writes an Index record of the chunks completed since the previous
+    // one, then flushes. Call periodically so a file that is never closed
+    // can be reopened without walking every record.
+    void checkpoint();
+
+    [[nodiscard]] uint64_t bytes_written() const noexcept {
+        return flushed_bytes_ + buffer_.size();
+    }
+
+    // Sample bytes as stored, and as they would be stored as Float32
+    [[nodiscard]] uint64_t sample_bytes() const noexcept {
+        return sample_bytes_;
+    }
+
+    [[nodiscard]] uint64_t raw_sample_bytes() const noexcept {
+        return raw_sample_bytes_;
+    }
+
+   private:
+    void begin_record(sweep_record::RecordType type, size_t payload_bytes);
+    void append(const void* data, size_t bytes);
+    void pad_to_alignment();
+    void write_index(uint64_t first_entry, uint64_t entries, uint64_t resume_offset, uint64_t resume_config_offset,
+                     uint64_t dropped_blocks);
+
+    std::FILE* file_ = nullptr;
+    bool failed_ = false;
+    std::vector<char> buffer_;
+    uint64_t flushed_bytes_ = 0;
+
+    sweep_record::PowerEncoding encoding_ = sweep_record::PowerEncoding::Float32;
+    float step_db_ = RECORD_WRITER_DEFAULT_STEP_DB;
+    uint64_t config_generation_ = 0;
+    uint64_t config_offset_ = 0;
+    uint64_t sweep_start_hz_ = 0;  // First band of every sweep under the current config
+    uint64_t chunk_bands_ = 0;
+    uint64_t chunk_sweeps_ = 0;  // Sweep starts seen since the chunk began
+    int64_t last_timestamp_us_ = 0;
+
+    std::vector<int16_t> quantized_;
+    SweepEncoder encoder_;
+    std::vector<std::byte> encoded_;
+
+    std::vector<sweep_record::IndexEntry> index_;
+    uint64_t checkpointed_entries_ = 0;
+    uint64_t previous_index_offset_ = 0;
+    uint64_t chunk_dropped_blocks_ = 0;  // Dropped blocks reported before the open chunk
+    sweep_record::Footer footer_{};
+    uint64_t sample_bytes_ = 0;
+    uint64_t raw_sample_bytes_ = 0;
+};
+
+#endif  // SWEEP_RECORD_WRITER_HPP
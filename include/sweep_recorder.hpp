@@ -0,0 +1,81 @@
+#ifndef SWEEP_RECORDER_HPP
+#define SWEEP_RECORDER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "spectrum_source.hpp"
+#include "sweep_queue.hpp"
+#include "sweep_record_format.hpp"
+#include "sweep_record_writer.hpp"
+
+constexpr size_t RECORDER_QUEUE_CAPACITY = 4096;
+constexpr int RECORDER_IDLE_SLEEP_MS = 5;
+constexpr int RECORDER_FLUSH_INTERVAL_MS = 1000;
+
+struct SweepRecorderStats {
+    uint64_t blocks = 0;
+    uint64_t dropped = 0;
+    uint64_t bytes = 0;
+    uint64_t sample_bytes = 0;
+    uint64_t raw_sample_bytes = 0;  // The same samples as Float32
+
+    [[nodiscard]] double compression_ratio() const noexcept {
+        return sample_bytes > 0 ? static_cast<double>(raw_sample_bytes) / static_cast<double>(sample_bytes) : 1.0;
+    }
+};
+
+// Writes the blocks handed to push() to a sweep_record file. push() only
+// copies into a private SweepQueue, so the producer thread never waits on
+// the disk; a writer thread drains it into a SweepRecordWriter and leaves a
+// Drop record wherever the queue overflowed.
+class SweepRecorder {
+   public:
+    SweepRecorder() = default;
+    ~SweepRecorder();
+
+    SweepRecorder(const SweepRecorder&) = delete;
+    SweepRecorder& operator=(const SweepRecorder&) = delete;
+
+    bool start(const std::string& path,
+               sweep_record::PowerEncoding encoding = sweep_record::PowerEncoding::Float32,
+               float step_db = RECORD_WRITER_DEFAULT_STEP_DB);
+    void stop();
+
+    [[nodiscard]] bool is_recording() const noexcept {
+        return recording_.load(std::memory_order_acquire);
+    }
+
+    // Producer thread: a no-op unless recording
+    void push(const FFTSweepData& data) {
+        if (recording_.load(std::memory_order_acquire)) {
+            queue_.push(data);
+        }
+    }
+
+    [[nodiscard]] SweepRecorderStats stats() const noexcept;
+
+   private:
+    void run();
+    size_t drain_to_writer();
+    void publish_stats();
+
+    SweepQueue queue_{RECORDER_QUEUE_CAPACITY, OverflowPolicy::DropNewest};
+    std::atomic_bool recording_{false};
+    std::atomic_bool running_{false};
+    std::thread thread_;
+
+    // Writer thread state
+    SweepRecordWriter writer_;
+    uint64_t dropped_baseline_ = 0;
+
+    std::atomic<uint64_t> blocks_written_{0};
+    std::atomic<uint64_t> dropped_blocks_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+    std::atomic<uint64_t> sample_bytes_{0};
+    std::atomic<uint64_t> raw_sample_bytes_{0};
+};
+
+#endif  // SWEEP_RECORDER_HPP
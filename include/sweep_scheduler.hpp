@@ -0,0 +1,150 @@
+#ifndef SWEEP_SCHEDULER_HPP
+#define SWEEP_SCHEDULER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "hackrf_gain_state.hpp"
+#include "snapshot_cell.hpp"
+#include "spectrum_source.hpp"
+
+// Tuning steps a HackRF sweeps per second, until a rate has been measured
+constexpr double SCHEDULER_DEFAULT_STEPS_PER_SECOND = 400.0;
+
+// A scan range and how often it should be revisited. Ranges without a
+// target are swept in the background, in whatever time the others leave.
+struct ScheduledRange {
+    ScanRange range;
+    double revisit_s = 0.0;
+};
+
+// The range list handed to the device: ranges with a tight target are
+// repeated in every slot of the cycle and the background is cut into one
+// chunk per slot. Revisit times are what the plan expects at the rate it
+// was made for, in the order of SweepScheduler's ranges.
+struct SweepPlan {
+    std::vector<ScanRange> entries;
+    std::vector<ScheduledRange> ranges;  // Sorted and merged
+    std::vector<double> expected_revisit_s;
+    size_t slots = 1;
+};
+
+SweepPlan plan_sweep_schedule(const std::vector<ScheduledRange>& ranges, double steps_per_second,
+                              size_t max_entries);
+
+struct RangeRevisit {
+    ScheduledRange target;
+    double expected_s = 0.0;
+    double achieved_s = 0.0;  // Mean time between visits, 0 until the second
+    uint64_t visits = 0;
+};
+
+// Visits counted by the block path under one plan; each plan starts its
+// own, so readers never see counts from a list the device no longer sweeps
+struct RangeVisitCounter {
+    std::atomic<int64_t> first_us{0};
+    std::atomic<int64_t> last_us{0};
+    std::atomic<uint64_t> visits{0};
+};
+
+struct SweepPlanCounters {
+    explicit SweepPlanCounters(size_t ranges) : visits(ranges) {}
+
+    std::atomic<int64_t> first_block_us{0};
+    std::atomic<int64_t> last_block_us{0};
+    std::atomic<uint64_t> blocks{0};
+    std::vector<RangeVisitCounter> visits;  // In the order of SweepPlan::ranges
+};
+
+// Everything the scheduler publishes to the block path, replaced as a whole
+// whenever the plan or the callback changes
+struct SweepSchedulerState {
+    uint64_t generation = 0;
+    FFTCallback fft_callback;
+    SweepPlan plan;
+    std::vector<uint64_t> range_starts_hz;
+    std::shared_ptr<SweepPlanCounters> counters;
+
+    // The plan takes over at the first block whose config generation is
+    // not this one; unset when every block from now on is swept from it
+    bool awaits_config = false;
+    uint64_t stale_config_generation = 0;
+};
+
+// Sits on top of a single device and gives some ranges a higher revisit
+// rate than others. hackrf_sweeper walks its range list in order, so the
+// plan is applied by handing it a list with repeats and nothing has to
+// restart between sub-sweeps. A source that only takes a new list when its
+// sweep starts is restarted whenever the schedule changes. Blocks are
+// passed on under a SweepConfig describing the plain ranges, so consumers
+// never see the repeats.
+class SweepScheduler : public SpectrumSource {
+   public:
+    explicit SweepScheduler(std::unique_ptr<SpectrumSource> source);
+    ~SweepScheduler() override;
+
+    SweepScheduler(const SweepScheduler&) = delete;
+    SweepScheduler& operator=(const SweepScheduler&) = delete;
+
+    [[nodiscard]] SpectrumSource& source() const;
+
+    bool set_schedule(const std::vector<ScheduledRange>& ranges);
+    [[nodiscard]] SweepPlan get_plan() const;
+
+    // Plans again with the sweep rate measured since the last plan; false
+    // until blocks have been swept under it
+    bool replan();
+    [[nodiscard]] double measured_steps_per_second() const;
+    [[nodiscard]] std::vector<RangeRevisit> revisit_report() const;
+
+    [[nodiscard]] bool is_connected() const override;
+    bool connect_device() override;
+
+    void start_sweep() override;
+    void stop_sweep() override;
+    void restart_sweep() override;
+
+    void set_gain_state(const HackRFGainState& state) override;
+    [[nodiscard]] HackRFGainState get_gain_state() const override;
+    void set_amp_enable(bool enable) noexcept override;
+    void set_vga_gain(int gain) override;
+    void set_lna_gain(int gain) override;
+
+    void set_fft_callback(FFTCallback callback) override;
+
+    // Ranges already in the schedule keep their targets, new ones are
+    // swept in the background
+    bool set_scan_ranges(const std::vector<ScanRange>& ranges) override;
+    [[nodiscard]] std::vector<ScanRange> get_scan_ranges() const override;
+    // Always true: the scheduler restarts the source itself when it has to
+    [[nodiscard]] bool applies_scan_ranges_live() const override;
+
+   private:
+    bool apply_plan(const std::vector<ScheduledRange>& ranges, double steps_per_second);  // Must hold mutex_
+    void refresh_block_state(const FFTSweepData& data);                                  // Source thread only
+    void process_block(const FFTSweepData& data);                                        // Source thread only
+
+    std::unique_ptr<SpectrumSource> source_;
+
+    // Serializes writers of state_ and the source calls that go with them;
+    // the block path never takes it
+    mutable std::mutex mutex_;
+    bool sweeping_ = false;
+
+    SnapshotCell<SweepSchedulerState> state_;
+    std::atomic<uint64_t> seen_config_generation_{0};  // Of the latest block from the source
+
+    // Owned by the source's thread
+    FFTSweepData block_;
+    std::shared_ptr<const SweepSchedulerState> block_state_;
+    uint64_t block_generation_ = 0;
+    std::shared_ptr<const SweepSchedulerState> block_plan_;  // Plan the blocks are swept from
+    std::shared_ptr<const SweepConfig> source_config_;
+    uint64_t config_generation_ = 0;
+};
+
+#endif  // SWEEP_SCHEDULER_HPP
@@ -7,11 +7,26 @@
 #include <qwt_plot_curve.h>
 #include <qwt_plot_spectrogram.h>
 
+#include <array>
+#include <cstddef>
+#include <span>
+
+// Number of precomputed palette entries spanning the z-interval
+constexpr int THERMAL_LUT_SIZE = 1024;
+
 class ThermalColorMap : public QwtLinearColorMap {
    public:
     ThermalColorMap();
 
-    QRgb rgb(const QwtInterval& interval, double value) const;
+    QRgb rgb(const QwtInterval& interval, double value) const override;
+
+    // Colours a whole row at once; the loop is branch-free so the compiler
+    // can vectorize everything but the final table load.
+    void colorize(const QwtInterval& interval, std::span<const float> values, QRgb* out) const;
+    void colorize(const QwtInterval& interval, std::span<const double> values, QRgb* out) const;
+
+   private:
+    std::array<QRgb, THERMAL_LUT_SIZE> lut_{};
 };
 
 #endif  // THERMAL_COLOR_MAP_HPP
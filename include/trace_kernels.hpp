@@ -0,0 +1,29 @@
+#ifndef TRACE_KERNELS_HPP
+#define TRACE_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Per-bin trace updates over `count` bins. `hits` counts the updates each
+// bin has seen since its trace was reset; a bin without hits takes the
+// input as it is. On x86-64 every kernel is built for AVX2 and for the
+// baseline SSE2 and the loader picks one per CPU; other targets use their
+// baseline vector ISA (NEON on AArch64).
+
+// Held values relax toward the input by decay_db per update
+void trace_max_hold(float* trace, uint32_t* hits, const float* input, size_t count, float decay_db);
+void trace_min_hold(float* trace, uint32_t* hits, const float* input, size_t count, float decay_db);
+
+// Exponential average of linear power over the last average_count updates,
+// kept in `linear` and written back to `trace` in dB. Until a bin has seen
+// average_count updates it holds the plain mean of what it has seen.
+void trace_average(float* trace, float* linear, uint32_t* hits, const float* input, size_t count,
+                   uint32_t average_count);
+
+// 10^(power_db / 10), to the same accuracy as trace_average
+void power_db_to_linear(const float* power_db, float* linear, size_t count);
+
+// Name of the instruction set the kernels run with on this CPU
+const char* trace_kernel_target();
+
+#endif  // TRACE_KERNELS_HPP
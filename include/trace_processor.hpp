@@ -0,0 +1,70 @@
+#ifndef TRACE_PROCESSOR_HPP
+#define TRACE_PROCESSOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "spectrum_decimator.hpp"
+#include "spectrum_layout.hpp"
+
+constexpr float TRACE_DEFAULT_DECAY_DB = 0.0F;
+constexpr uint32_t TRACE_DEFAULT_AVERAGE_COUNT = 16;
+
+enum class TraceKind {
+    MaxHold,
+    MinHold,
+    Average,  // Exponential average of linear power
+};
+
+constexpr size_t TRACE_KIND_COUNT = 3;
+
+// A derived trace over the same flat bin space as DatasetSpectrum. Each
+// block updates only the bins it covers, so the cost per block tracks the
+// block size rather than the span. Bins not swept since the last reset
+// read SPECTRUM_NO_DATA_DB.
+class TraceProcessor {
+   public:
+    TraceProcessor(TraceKind kind, size_t num_bins);
+
+    [[nodiscard]] TraceKind kind() const noexcept {
+        return kind_;
+    }
+
+    void update(size_t first_bin, std::span<const float> power_db);
+    void reset();
+
+    // Keeps the bins carried over by `runs` and starts the others empty
+    void remap(const std::vector<BinRun>& runs, size_t num_bins);
+
+    // dB per update that a held bin relaxes toward the live value; 0 holds forever
+    void set_decay_db(float decay_db) noexcept;
+    [[nodiscard]] float decay_db() const noexcept {
+        return decay_db_;
+    }
+
+    // Updates an Average trace weighs together
+    void set_average_count(uint32_t count) noexcept;
+    [[nodiscard]] uint32_t average_count() const noexcept {
+        return average_count_;
+    }
+
+    [[nodiscard]] std::span<const float> values() const noexcept {
+        return values_;
+    }
+
+    [[nodiscard]] MinMax get_min_max(size_t first_bin, size_t last_bin) const;
+
+   private:
+    TraceKind kind_;
+    float decay_db_ = TRACE_DEFAULT_DECAY_DB;
+    uint32_t average_count_ = TRACE_DEFAULT_AVERAGE_COUNT;
+
+    std::vector<float> values_;
+    std::vector<float> linear_;  // Average only
+    std::vector<uint32_t> hits_;
+    SpectrumDecimator decimator_;
+};
+
+#endif  // TRACE_PROCESSOR_HPP
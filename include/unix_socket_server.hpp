@@ -0,0 +1,56 @@
+#ifndef UNIX_SOCKET_SERVER_HPP
+#define UNIX_SOCKET_SERVER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Bytes a client may fall behind by before it is disconnected: several
+// seconds of CSV for a full-range sweep
+constexpr size_t SOCKET_CLIENT_MAX_BACKLOG_BYTES = size_t{8} << 20;
+
+// Non-blocking local stream socket that hands the same bytes to every
+// connected client. What a client cannot take without blocking waits in
+// its backlog for the next broadcast; a client whose backlog outgrows
+// SOCKET_CLIENT_MAX_BACKLOG_BYTES is disconnected rather than allowed to
+// stall the sender.
+class UnixSocketServer {
+   public:
+    UnixSocketServer() = default;
+    ~UnixSocketServer();
+
+    UnixSocketServer(const UnixSocketServer&) = delete;
+    UnixSocketServer& operator=(const UnixSocketServer&) = delete;
+
+    bool listen(const std::string& path);
+    void close();
+
+    void accept_pending();
+    // Empty data still sends what the clients have pending
+    void broadcast(std::string_view data);
+
+    [[nodiscard]] size_t client_count() const noexcept {
+        return clients_.size();
+    }
+
+    [[nodiscard]] uint64_t dropped_clients() const noexcept {
+        return dropped_clients_;
+    }
+
+   private:
+    struct Client {
+        int fd = -1;
+        std::string backlog;
+    };
+
+    static bool send_backlog(Client& client);
+
+    std::string path_;
+    int listen_fd_ = -1;
+    std::vector<Client> clients_;
+    uint64_t dropped_clients_ = 0;
+};
+
+#endif  // UNIX_SOCKET_SERVER_HPP
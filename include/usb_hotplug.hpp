@@ -0,0 +1,41 @@
+#ifndef USB_HOTPLUG_HPP
+#define USB_HOTPLUG_HPP
+
+#include <libusb-1.0/libusb.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "device_command_worker.hpp"
+
+constexpr int HACKRF_VENDOR_ID = 0x1d50;
+constexpr auto HOTPLUG_DELAY = std::chrono::milliseconds(200);
+
+// Watches for a HackRF being plugged in and queues a delayed connect and
+// sweep start on the command worker. libusb events are handled on a thread
+// of our own; the worker must outlive the monitor.
+class UsbHotplugMonitor {
+   public:
+    explicit UsbHotplugMonitor(DeviceCommandWorker* commands);
+    ~UsbHotplugMonitor();
+
+    UsbHotplugMonitor(const UsbHotplugMonitor&) = delete;
+    UsbHotplugMonitor& operator=(const UsbHotplugMonitor&) = delete;
+
+    // Returns false (after logging) if hotplug is unavailable
+    bool start();
+    void stop();
+
+   private:
+    static int on_device_arrived(libusb_context* ctx, libusb_device* device, libusb_hotplug_event event,
+                                 void* user_data);
+
+    DeviceCommandWorker* commands_;
+    libusb_context* context_ = nullptr;
+    libusb_hotplug_callback_handle callback_handle_{};
+    std::atomic_bool running_{false};
+    std::thread event_thread_;
+};
+
+#endif  // USB_HOTPLUG_HPP
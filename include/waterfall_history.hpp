@@ -0,0 +1,132 @@
+#ifndef WATERFALL_HISTORY_HPP
+#define WATERFALL_HISTORY_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "spectrum_layout.hpp"
+
+// Rings above full resolution; level k max-pools DECIMATION^k sweeps into
+// each row, so the top level pools 65536
+constexpr size_t WATERFALL_HISTORY_LEVELS = 8;
+constexpr size_t WATERFALL_HISTORY_DECIMATION = 4;
+
+struct WaterfallHistoryConfig {
+    size_t memory_bytes = size_t{256} << 20;  // Full-resolution ring and levels together
+    size_t spill_bytes = 0;                   // Size of the spill file; 0 keeps RAM only
+    std::string spill_path;
+};
+
+struct WaterfallHistoryRows {
+    size_t level = 0;                    // Each row pools DECIMATION^level sweeps
+    std::vector<int64_t> timestamps_us;  // Oldest sweep in each row, oldest row first
+    std::vector<float> power;            // cols() values per row
+};
+
+// Waterfall rows for hours of sweeps rather than seconds. Full-resolution
+// rows go into a ring in RAM; rows pushed out of it spill into a ring in a
+// memory-mapped scratch file, where the page cache decides what stays
+// resident. Every sweep is also max-pooled into WATERFALL_HISTORY_LEVELS
+// coarser rings, so a window of hours is read as a few hundred pre-reduced
+// rows, and the coarse levels reach back much further than full resolution
+// for the same memory. Half of memory_bytes goes to the full-resolution
+// ring, the rest is split evenly between the levels.
+class WaterfallHistory {
+   public:
+    WaterfallHistory() = default;
+    ~WaterfallHistory();
+
+    WaterfallHistory(const WaterfallHistory&) = delete;
+    WaterfallHistory& operator=(const WaterfallHistory&) = delete;
+
+    // Drops all rows and maps the spill file. If the file cannot be created
+    // this returns false and full resolution stays in RAM only.
+    bool configure(const WaterfallHistoryConfig& config);
+
+    // Drops all rows and sizes the rings for rows of `cols` values
+    void reset(size_t cols);
+
+    // Moves the rows held in RAM onto `cols` columns, carrying the columns
+    // in `runs`. Spilled rows are dropped rather than rewritten; the levels
+    // still cover their time at a coarser resolution.
+    void remap(const std::vector<BinRun>& runs, size_t cols);
+
+    // Timestamps are expected to increase; when one goes backwards (the
+    // clock stepping back) the history starts again from that row
+    void add_row(int64_t timestamp_us, std::span<const float> power);
+
+    // Rows in [start_us, end_us] from the finest level that has at most
+    // max_rows of them and reaches back to start_us, or else the newest
+    // max_rows of the coarsest level. Sweeps not yet pooled into a full row
+    // of that level are added as one partial row at the end.
+    bool read(int64_t start_us, int64_t end_us, size_t max_rows, WaterfallHistoryRows& rows) const;
+
+    [[nodiscard]] size_t cols() const noexcept {
+        return cols_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return hot_.count == 0;
+    }
+
+    [[nodiscard]] int64_t newest_us() const noexcept;
+
+    // RAM held by the rings, not counting the mapped spill
+    [[nodiscard]] size_t memory_bytes() const noexcept;
+
+   private:
+    struct Ring {
+        std::vector<float> storage;  // Empty when rows point into the spill mapping
+        float* rows = nullptr;
+        std::vector<int64_t> timestamps_us;
+        size_t capacity = 0;
+        size_t next = 0;  // Slot the next row goes to
+        size_t count = 0;
+        bool dropped = false;  // Overwritten a row since the last reset
+
+        [[nodiscard]] size_t slot(size_t i) const noexcept {
+            return (next + capacity - count + i) % capacity;
+        }
+    };
+
+    // Rows of the level below not yet making up a full row of this one
+    struct Pending {
+        std::vector<float> power;
+        int64_t timestamp_us = 0;
+        size_t count = 0;
+    };
+
+    bool map_spill(const std::string& path, size_t size);
+    void unmap_spill();
+
+    [[nodiscard]] size_t hot_capacity(size_t cols) const noexcept;
+    [[nodiscard]] size_t level_capacity(size_t cols) const noexcept;
+    [[nodiscard]] size_t spill_capacity(size_t cols) const noexcept;
+
+    void clear();  // Drops all rows, keeping the storage
+    void push(Ring& ring, int64_t timestamp_us, const float* power);
+    void remap_ring(Ring& ring, const std::vector<BinRun>& runs, size_t cols, size_t capacity);
+
+    // Level 0 is the spill ring followed by the hot ring
+    [[nodiscard]] size_t level_count(size_t level) const noexcept;
+    [[nodiscard]] const float* level_row(size_t level, size_t i) const noexcept;
+    [[nodiscard]] int64_t level_timestamp(size_t level, size_t i) const noexcept;
+    [[nodiscard]] bool level_complete(size_t level) const noexcept;
+    [[nodiscard]] size_t level_lower_bound(size_t level, int64_t timestamp_us) const noexcept;
+
+    WaterfallHistoryConfig config_;
+    float* spill_ = nullptr;
+    size_t spill_size_ = 0;
+
+    size_t cols_ = 0;
+    Ring hot_;
+    Ring spill_ring_;
+    std::array<Ring, WATERFALL_HISTORY_LEVELS> levels_;  // levels_[k] is level k + 1
+    std::array<Pending, WATERFALL_HISTORY_LEVELS> pending_;
+};
+
+#endif  // WATERFALL_HISTORY_HPP
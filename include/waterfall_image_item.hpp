@@ -0,0 +1,62 @@
+#ifndef WATERFALL_IMAGE_ITEM_HPP
+#define WATERFALL_IMAGE_ITEM_HPP
+
+#include <qwt_interval.h>
+#include <qwt_plot_item.h>
+#include <qwt_scale_map.h>
+
+#include <QImage>
+#include <QPainter>
+#include <QRectF>
+#include <span>
+#include <vector>
+
+#include "dataset_spectrum.hpp"
+#include "thermal_color_map.hpp"
+
+// Widest image kept per row; wider spectra are max-pooled down to this so
+// memory and blit cost stay bounded without hiding narrow peaks.
+constexpr int WATERFALL_IMAGE_MAX_WIDTH = 4096;
+
+// Waterfall that colourizes each sweep once, when it arrives, into a ring
+// of image rows. Painting is two scaled blits (the newest rows above the
+// wrap point, then the older ones), so redraw cost no longer scales with
+// history depth and the colour map runs only on new rows, or on every row
+// when the z interval changes.
+//
+// Plot coordinates match WaterfallRasterData: x spans the spectrum columns,
+// y spans the rows with the newest sweep at the top.
+class WaterfallImageItem : public QwtPlotItem {
+   public:
+    WaterfallImageItem(int rows, int cols, const QwtInterval& z_interval);
+
+    int rtti() const override;
+    QRectF boundingRect() const override;
+    void draw(QPainter* painter,
+              const QwtScaleMap& x_map,
+              const QwtScaleMap& y_map,
+              const QRectF& canvas_rect) const override;
+
+    void addRow(const DatasetSpectrum& spectrum);
+    void addRow(const SpectrumLayout& layout, std::span<const float> power);
+
+    // Recolours every row from its kept values
+    void setZInterval(const QwtInterval& z_interval);
+
+    // Moves the history onto `cols` columns, carrying the columns in `runs`
+    void remap(const std::vector<BinRun>& runs, int cols);
+
+   private:
+    int rows_;
+    int cols_;
+    int head_ = 0;    // Image row holding the newest sweep
+    int filled_ = 0;  // Rows written so far, up to rows_; the others stay black
+    QwtInterval z_interval_;
+    ThermalColorMap color_map_;
+    QImage image_;
+    std::vector<float> values_;  // What each image pixel was coloured from, row by row
+    std::vector<float> columns_;
+    std::vector<float> pooled_;
+};
+
+#endif  // WATERFALL_IMAGE_ITEM_HPP
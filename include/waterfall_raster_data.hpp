@@ -5,9 +5,11 @@
 #include <qwt_matrix_raster_data.h>
 
 #include <QVector>
-#include <map>
+#include <span>
 #include <vector>
 
+#include "dataset_spectrum.hpp"
+
 class WaterfallRasterData : public QwtMatrixRasterData {
    private:
     std::vector<double> m_data;
@@ -22,7 +24,11 @@ class WaterfallRasterData : public QwtMatrixRasterData {
     virtual ~WaterfallRasterData();
 
     void addRow(QVector<double> newRow);
-    void addRow(std::map<uint64_t, float> newRow);
+    void addRow(const DatasetSpectrum& spectrum);
+    void addRow(const SpectrumLayout& layout, std::span<const float> power);
+
+    // Moves the history onto `cols` columns, carrying the columns in `runs`
+    void remap(const std::vector<BinRun>& runs, int cols);
 
     virtual double value(double x, double y) const override;
 };
@@ -0,0 +1,218 @@
+#include "cellular_bands.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t MHZ_TO_HZ = 1'000'000ULL;
+constexpr uint64_t LTE_RASTER_HZ = 100'000;
+
+constexpr uint64_t mhz(double value) {
+    return static_cast<uint64_t>(value * 1e6 + 0.5);
+}
+
+// For LTE first_arfcn is N_Offs-DL, so F_DL_low sits at the first channel
+constexpr std::array<CellularBand, 36> CELLULAR_BANDS = {{
+    {RadioTechnology::LTE, 1, mhz(2110), mhz(2170), 0, 599, 1},
+    {RadioTechnology::LTE, 2, mhz(1930), mhz(1990), 600, 1199, 1},
+    {RadioTechnology::LTE, 3, mhz(1805), mhz(1880), 1200, 1949, 1},
+    {RadioTechnology::LTE, 4, mhz(2110), mhz(2155), 1950, 2399, 1},
+    {RadioTechnology::LTE, 5, mhz(869), mhz(894), 2400, 2649, 1},
+    {RadioTechnology::LTE, 7, mhz(2620), mhz(2690), 2750, 3449, 1},
+    {RadioTechnology::LTE, 8, mhz(925), mhz(960), 3450, 3799, 1},
+    {RadioTechnology::LTE, 12, mhz(729), mhz(746), 5010, 5179, 1},
+    {RadioTechnology::LTE, 13, mhz(746), mhz(756), 5180, 5279, 1},
+    {RadioTechnology::LTE, 14, mhz(758), mhz(768), 5280, 5379, 1},
+    {RadioTechnology::LTE, 17, mhz(734), mhz(746), 5730, 5849, 1},
+    {RadioTechnology::LTE, 20, mhz(791), mhz(821), 6150, 6449, 1},
+    {RadioTechnology::LTE, 25, mhz(1930), mhz(1995), 8040, 8689, 1},
+    {RadioTechnology::LTE, 26, mhz(859), mhz(894), 8690, 9039, 1},
+    {RadioTechnology::LTE, 28, mhz(758), mhz(803), 9210, 9659, 1},
+    {RadioTechnology::LTE, 38, mhz(2570), mhz(2620), 37750, 38249, 1},
+    {RadioTechnology::LTE, 40, mhz(2300), mhz(2400), 38650, 39649, 1},
+    {RadioTechnology::LTE, 41, mhz(2496), mhz(2690), 39650, 41589, 1},
+    {RadioTechnology::LTE, 42, mhz(3400), mhz(3600), 41590, 43589, 1},
+    {RadioTechnology::LTE, 66, mhz(2110), mhz(2200), 66436, 67335, 1},
+    {RadioTechnology::LTE, 71, mhz(617), mhz(652), 68586, 68935, 1},
+    {RadioTechnology::NR, 1, mhz(2110), mhz(2170), 422000, 434000, 20},
+    {RadioTechnology::NR, 3, mhz(1805), mhz(1880), 361000, 376000, 20},
+    {RadioTechnology::NR, 5, mhz(869), mhz(894), 173800, 178800, 20},
+    {RadioTechnology::NR, 7, mhz(2620), mhz(2690), 524000, 538000, 20},
+    {RadioTechnology::NR, 8, mhz(925), mhz(960), 185000, 192000, 20},
+    {RadioTechnology::NR, 20, mhz(791), mhz(821), 158200, 164200, 20},
+    {RadioTechnology::NR, 28, mhz(758), mhz(803), 151600, 160600, 20},
+    {RadioTechnology::NR, 38, mhz(2570), mhz(2620), 514000, 524000, 20},
+    {RadioTechnology::NR, 40, mhz(2300), mhz(2400), 460000, 480000, 20},
+    {RadioTechnology::NR, 41, mhz(2496), mhz(2690), 499200, 537999, 3},
+    {RadioTechnology::NR, 66, mhz(2110), mhz(2200), 422000, 440000, 20},
+    {RadioTechnology::NR, 71, mhz(617), mhz(652), 123400, 130400, 20},
+    {RadioTechnology::NR, 77, mhz(3300), mhz(4200), 620000, 680000, 1},
+    {RadioTechnology::NR, 78, mhz(3300), mhz(3800), 620000, 653333, 1},
+    {RadioTechnology::NR, 79, mhz(4400), mhz(5000), 693334, 733333, 1},
+}};
+
+// One piece of the NR global frequency raster (TS 38.104 table 5.4.2.1-1)
+struct NrRasterRange {
+    uint32_t first_arfcn;
+    uint32_t last_arfcn;
+    uint64_t offset_hz;
+    uint64_t step_hz;
+};
+
+constexpr std::array<NrRasterRange, 3> NR_GLOBAL_RASTER = {{
+    {0, 599999, 0, 5'000},
+    {600000, 2016666, 3'000'000'000ULL, 15'000},
+    {2016667, 3279165, 24'250'080'000ULL, 60'000},
+}};
+
+const char* technology_name(RadioTechnology technology) {
+    return technology == RadioTechnology::LTE ? "LTE" : "NR";
+}
+
+bool inside_ranges(const std::vector<ScanRange>& ranges, uint64_t low_hz, uint64_t high_hz) {
+    return std::any_of(ranges.begin(), ranges.end(), [&](const ScanRange& range) {
+        return low_hz >= range.start_mhz * MHZ_TO_HZ && high_hz <= range.end_mhz * MHZ_TO_HZ;
+    });
+}
+
+}  // namespace
+
+std::span<const CellularBand> cellular_bands() {
+    return CELLULAR_BANDS;
+}
+
+const CellularBand* find_cellular_band(RadioTechnology technology, uint32_t arfcn) {
+    for (const CellularBand& band : CELLULAR_BANDS) {
+        if (band.technology == technology && arfcn >= band.first_arfcn && arfcn <= band.last_arfcn) {
+            return &band;
+        }
+    }
+    return nullptr;
+}
+
+std::optional<uint64_t> arfcn_to_hz(RadioTechnology technology, uint32_t arfcn) {
+    if (technology == RadioTechnology::LTE) {
+        const CellularBand* band = find_cellular_band(technology, arfcn);
+        if (band == nullptr) {
+            return std::nullopt;
+        }
+        return band->dl_low_hz + LTE_RASTER_HZ * (arfcn - band->first_arfcn);
+    }
+
+    for (const NrRasterRange& range : NR_GLOBAL_RASTER) {
+        if (arfcn >= range.first_arfcn && arfcn <= range.last_arfcn) {
+            return range.offset_hz + range.step_hz * (arfcn - range.first_arfcn);
+        }
+    }
+    return std::nullopt;
+}
+
+std::string channel_name(const CellularChannel& channel) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s %s%d #%u", technology_name(channel.technology),
+                  channel.technology == RadioTechnology::LTE ? "B" : "n", channel.band, channel.arfcn);
+    return name;
+}
+
+std::vector<CellularChannel> make_band_plan(RadioTechnology technology,
+                                            const std::vector<ScanRange>& ranges,
+                                            uint32_t bandwidth_hz,
+                                            uint32_t step_hz) {
+    std::vector<CellularChannel> channels;
+    if (bandwidth_hz == 0 || step_hz == 0) {
+        return channels;
+    }
+
+    for (const CellularBand& band : CELLULAR_BANDS) {
+        if (band.technology != technology) {
+            continue;
+        }
+
+        uint64_t next_center_hz = band.dl_low_hz + bandwidth_hz / 2;
+        for (uint32_t arfcn = band.first_arfcn; arfcn <= band.last_arfcn; arfcn += band.arfcn_step) {
+            const std::optional<uint64_t> center_hz = arfcn_to_hz(technology, arfcn);
+            if (!center_hz || *center_hz < next_center_hz) {
+                continue;
+            }
+
+            const uint64_t low_hz = *center_hz - bandwidth_hz / 2;
+            const uint64_t high_hz = *center_hz + bandwidth_hz / 2;
+            if (high_hz > band.dl_high_hz) {
+                break;
+            }
+
+            next_center_hz = *center_hz + step_hz;
+            if (inside_ranges(ranges, low_hz, high_hz)) {
+                channels.push_back({technology, band.number, arfcn, *center_hz, bandwidth_hz});
+            }
+        }
+    }
+    return channels;
+}
+
+bool load_channel_plan(const std::string& path, std::vector<CellularChannel>& channels) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Failed to open channel plan: " << path << '\n';
+        return false;
+    }
+
+    std::vector<CellularChannel> loaded;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        ++line_number;
+
+        const size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+
+        char technology[8] = {};
+        unsigned int arfcn = 0;
+        double bandwidth_mhz = 0.0;
+        if (std::sscanf(line.c_str() + start, "%7[A-Za-z] , %u , %lf", technology, &arfcn, &bandwidth_mhz) != 3 ||
+            bandwidth_mhz <= 0.0) {
+            std::cerr << path << ':' << line_number << ": expected \"LTE|NR, arfcn, bandwidth_mhz\"\n";
+            return false;
+        }
+
+        CellularChannel channel;
+        const std::string name(technology);
+        if (name == "LTE") {
+            channel.technology = RadioTechnology::LTE;
+        } else if (name == "NR") {
+            channel.technology = RadioTechnology::NR;
+        } else {
+            std::cerr << path << ':' << line_number << ": unknown technology " << name << '\n';
+            return false;
+        }
+
+        const std::optional<uint64_t> center_hz = arfcn_to_hz(channel.technology, arfcn);
+        const CellularBand* band = find_cellular_band(channel.technology, arfcn);
+        if (!center_hz || band == nullptr) {
+            std::cerr << path << ':' << line_number << ": channel " << arfcn << " is not in a known band\n";
+            return false;
+        }
+
+        channel.band = band->number;
+        channel.arfcn = arfcn;
+        channel.center_hz = *center_hz;
+        channel.bandwidth_hz = static_cast<uint32_t>(std::llround(bandwidth_mhz * 1e6));
+        loaded.push_back(channel);
+    }
+
+    channels = std::move(loaded);
+    return true;
+}
@@ -0,0 +1,114 @@
+#include "channel_power.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "trace_kernels.hpp"
+
+void ChannelPowerEngine::configure(const SpectrumLayout& layout, std::vector<CellularChannel> channels) {
+    channels_ = std::move(channels);
+    num_bins_ = layout.num_bins();
+
+    spans_.clear();
+    coverage_.assign(channels_.size(), 0.0F);
+
+    const double bin_width = layout.bin_width_hz();
+    for (size_t channel = 0; channel < channels_.size() && bin_width > 0.0; ++channel) {
+        const CellularChannel& info = channels_[channel];
+        const double low_hz = static_cast<double>(info.center_hz) - info.bandwidth_hz / 2.0;
+        const double high_hz = static_cast<double>(info.center_hz) + info.bandwidth_hz / 2.0;
+
+        // Bins whose frequency lies inside the channel, segment by segment
+        size_t covered_bins = 0;
+        for (const SpectrumSegment& segment : layout.segments()) {
+            const double start = static_cast<double>(segment.start_hz);
+            const auto to_bin = [&](double freq_hz) {
+                const double bin = std::ceil((freq_hz - start) / bin_width);
+                return static_cast<size_t>(std::clamp(bin, 0.0, static_cast<double>(segment.num_bins)));
+            };
+
+            const size_t first = to_bin(low_hz);
+            const size_t last = to_bin(high_hz);
+            if (last <= first) {
+                continue;
+            }
+
+            spans_.push_back({static_cast<uint32_t>(channel), static_cast<uint32_t>(segment.first_bin + first),
+                              static_cast<uint32_t>(segment.first_bin + last)});
+            covered_bins += last - first;
+        }
+
+        if (info.bandwidth_hz > 0) {
+            coverage_[channel] = static_cast<float>(
+                std::min(1.0, static_cast<double>(covered_bins) * bin_width / info.bandwidth_hz));
+        }
+    }
+
+    linear_.assign(num_bins_, 0.0F);
+    prefix_.assign(num_bins_ + 1, 0.0);
+    channel_linear_.assign(channels_.size(), 0.0);
+    power_db_.assign(channels_.size(), CHANNEL_NO_DATA_DB);
+
+    history_.assign(CHANNEL_HISTORY_SWEEPS * channels_.size(), CHANNEL_NO_DATA_DB);
+    history_timestamps_us_.assign(CHANNEL_HISTORY_SWEEPS, 0);
+    clear_history();
+}
+
+void ChannelPowerEngine::update(int64_t timestamp_us, std::span<const float> spectrum_db) {
+    if (spectrum_db.size() != num_bins_ || channels_.empty()) {
+        return;
+    }
+
+    power_db_to_linear(spectrum_db.data(), linear_.data(), num_bins_);
+
+    // Double, so that subtracting two large sums keeps a weak channel's power
+    double sum = 0.0;
+    for (size_t bin = 0; bin < num_bins_; ++bin) {
+        sum += linear_[bin];
+        prefix_[bin + 1] = sum;
+    }
+
+    std::fill(channel_linear_.begin(), channel_linear_.end(), 0.0);
+    for (const BinSpan& span : spans_) {
+        channel_linear_[span.channel] += prefix_[span.last_bin] - prefix_[span.first_bin];
+    }
+
+    float* row = history_.data() + history_head_ * channels_.size();
+    for (size_t channel = 0; channel < channels_.size(); ++channel) {
+        power_db_[channel] = coverage_[channel] > 0.0F && channel_linear_[channel] > 0.0
+                                 ? static_cast<float>(10.0 * std::log10(channel_linear_[channel]))
+                                 : CHANNEL_NO_DATA_DB;
+        row[channel] = power_db_[channel];
+    }
+
+    history_timestamps_us_[history_head_] = timestamp_us;
+    history_head_ = (history_head_ + 1) % CHANNEL_HISTORY_SWEEPS;
+    history_count_ = std::min(history_count_ + 1, CHANNEL_HISTORY_SWEEPS);
+}
+
+void ChannelPowerEngine::clear_history() {
+    history_head_ = 0;
+    history_count_ = 0;
+}
+
+void ChannelPowerEngine::history(size_t channel,
+                                 std::vector<int64_t>& timestamps_us,
+                                 std::vector<float>& power_db) const {
+    timestamps_us.clear();
+    power_db.clear();
+    if (channel >= channels_.size()) {
+        return;
+    }
+
+    const size_t oldest = (history_head_ + CHANNEL_HISTORY_SWEEPS - history_count_) % CHANNEL_HISTORY_SWEEPS;
+    for (size_t i = 0; i < history_count_; ++i) {
+        const size_t row = (oldest + i) % CHANNEL_HISTORY_SWEEPS;
+        timestamps_us.push_back(history_timestamps_us_[row]);
+        power_db.push_back(history_[row * channels_.size() + channel]);
+    }
+}
@@ -0,0 +1,81 @@
+#include "channel_power_model.hpp"
+
+#include <QString>
+
+ChannelPowerModel::ChannelPowerModel(const ChannelPowerEngine* engine, QObject* parent)
+    : QAbstractTableModel(parent), engine_(engine) {}
+
+void ChannelPowerModel::reload() {
+    beginResetModel();
+    endResetModel();
+}
+
+void ChannelPowerModel::refresh_power() {
+    const int rows = rowCount();
+    if (rows > 0) {
+        emit dataChanged(index(0, PowerColumn), index(rows - 1, PowerColumn), {Qt::DisplayRole});
+    }
+}
+
+int ChannelPowerModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(engine_->channels().size());
+}
+
+int ChannelPowerModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant ChannelPowerModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || static_cast<size_t>(index.row()) >= engine_->channels().size()) {
+        return {};
+    }
+
+    const auto row = static_cast<size_t>(index.row());
+    const CellularChannel& channel = engine_->channels()[row];
+
+    if (role == Qt::TextAlignmentRole && index.column() != ChannelColumn) {
+        return static_cast<int>(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    if (role != Qt::DisplayRole) {
+        return {};
+    }
+
+    switch (index.column()) {
+        case ChannelColumn:
+            return QString::fromStdString(channel_name(channel));
+        case CenterColumn:
+            return QString::number(channel.center_hz / 1e6, 'f', 3);
+        case BandwidthColumn:
+            return QString::number(channel.bandwidth_hz / 1e6, 'g', 4);
+        case PowerColumn: {
+            const float power_db = engine_->power_db()[row];
+            if (power_db <= CHANNEL_NO_DATA_DB) {
+                return QString("-");
+            }
+            // Flag channels only partly inside the scan ranges
+            const QString text = QString::number(power_db, 'f', 1);
+            return engine_->coverage(row) < 1.0F ? text + "*" : text;
+        }
+        default:
+            return {};
+    }
+}
+
+QVariant ChannelPowerModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return {};
+    }
+
+    switch (section) {
+        case ChannelColumn:
+            return QString("Channel");
+        case CenterColumn:
+            return QString("MHz");
+        case BandwidthColumn:
+            return QString("BW");
+        case PowerColumn:
+            return QString("dB");
+        default:
+            return {};
+    }
+}
@@ -1,100 +1,158 @@
 #include "dataset_spectrum.hpp"
 
-#include <QVector>
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
-#include <iostream>
-#include <map>
+#include <span>
+#include <utility>
 #include <vector>
 
-template <class T>
-std::vector<uint64_t> linspace(T start, T stop, int num, bool endpoint = true) {
-    // Return an empty vector if num is non-positive.
-    if (num <= 0) {
-        return std::vector<T>{};
-    }
-
-    // Special case for a single element.
-    if (num == 1) {
-        return std::vector<T>{static_cast<T>(start)};
-    }
-
-    std::vector<T> result(num);
-    double step_size = endpoint ? (stop - start) / (num - 1) : (stop - start) / num;
-
-    for (int i = 0; i < num; ++i) {
-        result[i] = static_cast<T>(start + i * step_size);
-    }
-
-    return result;
-}
-
-DatasetSpectrum::DatasetSpectrum() : initialized(false) {}
+DatasetSpectrum::DatasetSpectrum() : fft_bin_size_hz(0.0), initialized(false) {}
 
 DatasetSpectrum::DatasetSpectrum(double fft_bin_size_hz, std::vector<uint16_t> freq_ranges)
     : fft_bin_size_hz(fft_bin_size_hz),
       freq_ranges(freq_ranges),
+      layout(fft_bin_size_hz, freq_ranges),
+      spectrum(layout.num_bins(), SPECTRUM_NO_DATA_DB),
       initialized(true) {
+    decimator.reset(spectrum);
 }
 
 int DatasetSpectrum::get_num_datapoints() const {
-    if (freq_ranges.empty()) {
-        return 0;
-    }
-
-    int datapoints = 0;
-    for (size_t i = 0; i < freq_ranges.size(); i += 2) {
-        datapoints += (freq_ranges[i + 1] - freq_ranges[i]) / (fft_bin_size_hz / 1e6);
-    }
-    return datapoints;
+    return static_cast<int>(layout.num_bins());
 }
 
+// Plot columns; the layout lays the ranges side by side without their gaps
 int DatasetSpectrum::get_total_num_datapoints() const {
-    if (freq_ranges.empty()) {
-        return 0;
-    }
-    return (freq_ranges[freq_ranges.size() - 1] - freq_ranges[0]) / (fft_bin_size_hz / 1e6);
+    return static_cast<int>(layout.num_bins());
 }
 
-void DatasetSpectrum::add_new_data(uint64_t start_freq, uint64_t end_freq, const std::vector<float>& pwr) {
-    std::vector<uint64_t> freqs = linspace<uint64_t>(start_freq, end_freq, pwr.size(), false);
+void DatasetSpectrum::add_new_data(uint64_t start_freq, uint64_t end_freq, std::span<const float> pwr) {
+    if (pwr.empty() || end_freq <= start_freq) {
+        return;
+    }
 
-    for (size_t i = 0; i < pwr.size(); ++i) {
-        spectrum[freqs[i]] = pwr[i];
+    const double bin_width = layout.bin_width_hz();
+
+    // A block normally lands inside one segment, but clip it against every
+    // segment so overlapping or partially covered ranges are handled too.
+    for (const SpectrumSegment& segment : layout.segments()) {
+        if (end_freq <= segment.start_hz || start_freq >= segment.end_hz) {
+            continue;
+        }
+
+        // Snap the block start onto the segment's bin grid
+        const double offset_bins = std::round(
+            (static_cast<double>(start_freq) - static_cast<double>(segment.start_hz)) / bin_width);
+        const auto first_in_block = static_cast<ptrdiff_t>(offset_bins);
+
+        const ptrdiff_t src_begin = std::max<ptrdiff_t>(0, -first_in_block);
+        const ptrdiff_t dst_begin = std::max<ptrdiff_t>(0, first_in_block);
+        const ptrdiff_t count = std::min<ptrdiff_t>(
+            static_cast<ptrdiff_t>(pwr.size()) - src_begin,
+            static_cast<ptrdiff_t>(segment.num_bins) - dst_begin);
+
+        if (count <= 0) {
+            continue;
+        }
+
+        const size_t first_bin = segment.first_bin + static_cast<size_t>(dst_begin);
+        std::copy_n(pwr.begin() + src_begin, count, spectrum.begin() + static_cast<ptrdiff_t>(first_bin));
+        decimator.update(spectrum, first_bin, static_cast<size_t>(count));
+
+        const std::span<const float> block = pwr.subspan(static_cast<size_t>(src_begin), static_cast<size_t>(count));
+        for (TraceProcessor& trace : traces) {
+            trace.update(first_bin, block);
+        }
+        if (statistics) {
+            statistics->update(first_bin, block);
+        }
     }
 }
 
-std::map<uint64_t, float> DatasetSpectrum::get_spectrum() const {
+std::span<const float> DatasetSpectrum::get_spectrum() const {
     return spectrum;
 }
 
-QVector<double> DatasetSpectrum::get_power_array() const {
-    QVector<double> spectrum_vec;
+const SpectrumLayout& DatasetSpectrum::get_layout() const {
+    return layout;
+}
+
+double DatasetSpectrum::get_frequency(size_t bin) const {
+    return layout.frequency_at(bin);
+}
+
+MinMax DatasetSpectrum::get_min_max(size_t first_bin, size_t last_bin) const {
+    return decimator.range(spectrum, first_bin, last_bin);
+}
+
+void DatasetSpectrum::clear() {
+    std::fill(spectrum.begin(), spectrum.end(), SPECTRUM_NO_DATA_DB);
+    decimator.reset(spectrum);
+    reset_traces();
+    if (statistics) {
+        statistics->reset();
+    }
+}
+
+std::vector<BinRun> DatasetSpectrum::reconfigure(std::vector<uint16_t> freq_ranges) {
+    SpectrumLayout new_layout(fft_bin_size_hz, freq_ranges);
+    std::vector<BinRun> runs = layout.shared_bins(new_layout);
+
+    remap_bins(spectrum, runs, new_layout.num_bins(), SPECTRUM_NO_DATA_DB);
+    decimator.reset(spectrum);
+    for (TraceProcessor& trace : traces) {
+        trace.remap(runs, new_layout.num_bins());
+    }
+    if (statistics) {
+        statistics->remap(runs, new_layout.num_bins());
+    }
 
-    spectrum_vec.reserve(spectrum.size());
+    this->freq_ranges = std::move(freq_ranges);
+    layout = std::move(new_layout);
+    return runs;
+}
+
+bool DatasetSpectrum::has_config(double fft_bin_size_hz, const std::vector<uint16_t>& freq_ranges) const {
+    return initialized && this->fft_bin_size_hz == fft_bin_size_hz && this->freq_ranges == freq_ranges;
+}
 
-    for (const auto& pair : spectrum) {
-        spectrum_vec.push_back(pair.second);
+TraceProcessor& DatasetSpectrum::enable_trace(TraceKind kind) {
+    if (TraceProcessor* trace = get_trace(kind)) {
+        return *trace;
     }
+    return traces.emplace_back(kind, spectrum.size());
+}
 
-    return spectrum_vec;
+void DatasetSpectrum::disable_trace(TraceKind kind) {
+    std::erase_if(traces, [kind](const TraceProcessor& trace) { return trace.kind() == kind; });
 }
 
-QVector<double> DatasetSpectrum::get_frequency_array() const {
-    QVector<double> freq_vec;
+TraceProcessor* DatasetSpectrum::get_trace(TraceKind kind) {
+    return const_cast<TraceProcessor*>(std::as_const(*this).get_trace(kind));
+}
 
-    freq_vec.reserve(spectrum.size());
+const TraceProcessor* DatasetSpectrum::get_trace(TraceKind kind) const {
+    const auto it = std::find_if(traces.begin(), traces.end(),
+                                 [kind](const TraceProcessor& trace) { return trace.kind() == kind; });
+    return it != traces.end() ? &*it : nullptr;
+}
 
-    for (const auto& pair : spectrum) {
-        freq_vec.push_back(pair.first / 1e6);
+void DatasetSpectrum::reset_traces() {
+    for (TraceProcessor& trace : traces) {
+        trace.reset();
     }
+}
 
-    return freq_vec;
+SpectrumStatistics& DatasetSpectrum::enable_statistics() {
+    if (!statistics) {
+        statistics.emplace(spectrum.size());
+    }
+    return *statistics;
 }
 
-void DatasetSpectrum::clear() {
-    spectrum.clear();
+const SpectrumStatistics* DatasetSpectrum::get_statistics() const {
+    return statistics ? &*statistics : nullptr;
 }
 
 bool DatasetSpectrum::is_initialized() const {
@@ -0,0 +1,172 @@
+#include "device_command_worker.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "hackrf_gain_state.hpp"
+#include "pipeline_trace.hpp"
+
+namespace {
+
+// Span names must outlive the trace, so each command kind gets a literal
+const char* command_trace_name(DeviceCommandKind kind) {
+    switch (kind) {
+        case DeviceCommandKind::Connect:
+            return "connect";
+        case DeviceCommandKind::StartSweep:
+            return "start sweep";
+        case DeviceCommandKind::StopSweep:
+            return "stop sweep";
+        case DeviceCommandKind::RestartSweep:
+            return "restart sweep";
+        case DeviceCommandKind::SetGain:
+            return "set gain";
+        case DeviceCommandKind::SetScanRanges:
+            return "set scan ranges";
+    }
+    return "device command";
+}
+
+}  // namespace
+
+DeviceCommandWorker::DeviceCommandWorker(SpectrumSource* source)
+    : source_(source), thread_(&DeviceCommandWorker::run, this) {}
+
+DeviceCommandWorker::~DeviceCommandWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        pending_.clear();
+    }
+    wake_.notify_all();
+    thread_.join();
+}
+
+void DeviceCommandWorker::set_completion_callback(DeviceCommandCallback callback) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    completion_callback_ = std::move(callback);
+}
+
+void DeviceCommandWorker::connect_device(std::chrono::milliseconds delay) {
+    enqueue({DeviceCommandKind::Connect, std::chrono::steady_clock::now() + delay, {}, {}});
+}
+
+void DeviceCommandWorker::start_sweep() {
+    enqueue({DeviceCommandKind::StartSweep, {}, {}, {}});
+}
+
+void DeviceCommandWorker::stop_sweep() {
+    enqueue({DeviceCommandKind::StopSweep, {}, {}, {}});
+}
+
+void DeviceCommandWorker::restart_sweep() {
+    enqueue({DeviceCommandKind::RestartSweep, {}, {}, {}});
+}
+
+void DeviceCommandWorker::set_gain_state(const HackRFGainState& state) {
+    enqueue({DeviceCommandKind::SetGain, {}, state, {}});
+}
+
+void DeviceCommandWorker::set_scan_ranges(const std::vector<ScanRange>& ranges) {
+    enqueue({DeviceCommandKind::SetScanRanges, {}, {}, ranges});
+}
+
+void DeviceCommandWorker::enqueue(DeviceCommand command) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (command.kind == DeviceCommandKind::SetGain || command.kind == DeviceCommandKind::SetScanRanges) {
+            // Settings: overwrite the queued request in place with the newest value
+            auto queued = std::find_if(pending_.begin(), pending_.end(), [&](const DeviceCommand& pending) {
+                return pending.kind == command.kind;
+            });
+            if (queued != pending_.end()) {
+                queued->gain = command.gain;
+                queued->ranges = std::move(command.ranges);
+                ++queued->coalesced;
+                return;
+            }
+        } else if (!pending_.empty() && pending_.back().kind == command.kind) {
+            // Sweep control: running the same command twice in a row is a no-op
+            pending_.back().not_before = std::max(pending_.back().not_before, command.not_before);
+            ++pending_.back().coalesced;
+            return;
+        }
+
+        pending_.push_back(std::move(command));
+    }
+    wake_.notify_one();
+}
+
+void DeviceCommandWorker::run() {
+    pipeline_trace_set_thread_name("device commands");
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (!stopping_) {
+        if (pending_.empty()) {
+            wake_.wait(lock);
+            continue;
+        }
+
+        if (pending_.front().not_before > std::chrono::steady_clock::now()) {
+            wake_.wait_until(lock, pending_.front().not_before);
+            continue;
+        }
+
+        const DeviceCommand command = std::move(pending_.front());
+        pending_.pop_front();
+        lock.unlock();
+
+        const DeviceCommandResult result = execute(command);
+        {
+            std::lock_guard<std::mutex> callback_lock(callback_mutex_);
+            if (completion_callback_) {
+                completion_callback_(result);
+            }
+        }
+
+        lock.lock();
+    }
+}
+
+DeviceCommandResult DeviceCommandWorker::execute(const DeviceCommand& command) {
+    const PipelineTraceScope trace_scope(command_trace_name(command.kind));
+
+    DeviceCommandResult result;
+    result.kind = command.kind;
+    result.coalesced = command.coalesced;
+
+    switch (command.kind) {
+        case DeviceCommandKind::Connect:
+            result.ok = source_->connect_device();
+            break;
+        case DeviceCommandKind::StartSweep:
+            source_->start_sweep();
+            result.ok = source_->is_connected();
+            break;
+        case DeviceCommandKind::StopSweep:
+            source_->stop_sweep();
+            result.ok = true;
+            break;
+        case DeviceCommandKind::RestartSweep:
+            source_->restart_sweep();
+            result.ok = source_->is_connected();
+            break;
+        case DeviceCommandKind::SetGain:
+            source_->set_gain_state(command.gain);
+            result.gain = source_->get_gain_state();
+            result.ok = true;
+            break;
+        case DeviceCommandKind::SetScanRanges:
+            result.ok = source_->set_scan_ranges(command.ranges);
+            result.scan_ranges = source_->get_scan_ranges();
+            break;
+    }
+
+    return result;
+}
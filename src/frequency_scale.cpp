@@ -0,0 +1,93 @@
+#include "frequency_scale.hpp"
+
+#include <qwt_scale_div.h>
+#include <qwt_scale_draw.h>
+#include <qwt_scale_engine.h>
+#include <qwt_text.h>
+
+#include <QList>
+#include <QString>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "dataset_spectrum.hpp"
+
+namespace {
+
+// Columns of the multiples of step_hz inside [lo, hi) of one segment
+void append_ticks(QList<double>& ticks, const SpectrumSegment& segment, double bin_width_hz, double lo, double hi,
+                  double step_hz, double skip_step_hz) {
+    const auto start_hz = static_cast<double>(segment.start_hz);
+    const double first_column = static_cast<double>(segment.first_bin);
+    const double lo_hz = start_hz + (lo - first_column) * bin_width_hz;
+    const double hi_hz = start_hz + (hi - first_column) * bin_width_hz;
+
+    for (auto k = static_cast<int64_t>(std::ceil(lo_hz / step_hz)); static_cast<double>(k) * step_hz < hi_hz; ++k) {
+        const double freq_hz = static_cast<double>(k) * step_hz;
+        if (skip_step_hz > 0.0 && std::abs(std::remainder(freq_hz, skip_step_hz)) < step_hz / 2) {
+            continue;  // Already a major tick
+        }
+        ticks.append(first_column + (freq_hz - start_hz) / bin_width_hz);
+    }
+}
+
+}  // namespace
+
+FrequencyScaleEngine::FrequencyScaleEngine(const DatasetSpectrum* spectrum) : spectrum_(spectrum) {}
+
+QwtScaleDiv FrequencyScaleEngine::divideScale(double x1, double x2, int max_major_steps, int max_minor_steps,
+                                              double step_size) const {
+    const SpectrumLayout& layout = spectrum_->get_layout();
+    if (layout.empty() || x1 == x2) {
+        return QwtLinearScaleEngine::divideScale(x1, x2, max_major_steps, max_minor_steps, step_size);
+    }
+
+    const double lo = std::min(x1, x2);
+    const double hi = std::max(x1, x2);
+    const double bin_width_hz = layout.bin_width_hz();
+
+    const double major_step_hz =
+        QwtScaleArithmetic::divideInterval((hi - lo) * bin_width_hz, std::max(max_major_steps, 1), 10);
+    const double minor_step_hz =
+        max_minor_steps > 0 ? QwtScaleArithmetic::divideInterval(major_step_hz, max_minor_steps, 10) : 0.0;
+    if (major_step_hz <= 0.0) {
+        return QwtLinearScaleEngine::divideScale(x1, x2, max_major_steps, max_minor_steps, step_size);
+    }
+
+    QList<double> major_ticks;
+    QList<double> minor_ticks;
+    for (const SpectrumSegment& segment : layout.segments()) {
+        const double segment_lo = std::max(lo, static_cast<double>(segment.first_bin));
+        const double segment_hi = std::min(hi, static_cast<double>(segment.first_bin + segment.num_bins));
+        if (segment_hi <= segment_lo) {
+            continue;
+        }
+
+        append_ticks(major_ticks, segment, bin_width_hz, segment_lo, segment_hi, major_step_hz, 0.0);
+        if (minor_step_hz > 0.0) {
+            append_ticks(minor_ticks, segment, bin_width_hz, segment_lo, segment_hi, minor_step_hz, major_step_hz);
+        }
+    }
+
+    return QwtScaleDiv(x1, x2, minor_ticks, QList<double>(), major_ticks);
+}
+
+FrequencyScaleDraw::FrequencyScaleDraw(const DatasetSpectrum* spectrum) : spectrum_(spectrum) {}
+
+QwtText FrequencyScaleDraw::label(double column) const {
+    const SpectrumLayout& layout = spectrum_->get_layout();
+    if (layout.empty()) {
+        return QwtText();
+    }
+
+    // Ticks sit on round frequencies, so trim what rounding leaves behind
+    QString text = QString::number(layout.frequency_of_column(column) / 1e6, 'f', 3);
+    while (text.endsWith('0')) {
+        text.chop(1);
+    }
+    if (text.endsWith('.')) {
+        text.chop(1);
+    }
+    return QwtText(text);
+}
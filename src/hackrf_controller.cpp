@@ -2,44 +2,37 @@
 
 #include <libhackrf/hackrf.h>
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <iostream>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <utility>
 #include <vector>
 #include <thread>
 
 #include "hackrf_gain_state.hpp"
+#include "pipeline_metrics.hpp"
+#include "pipeline_trace.hpp"
 
 extern "C" {
 #include <hackrf_sweeper.h>
 }
 
-FrequencyBand extract_band(const hackrf_sweep_state_t* state,
-                           uint64_t start_freq,
-                           int power_offset,
-                           int num_bins) {
-    FrequencyBand band;
+// Copies one quarter of the FFT output into a band whose storage was sized at
+// FFT setup time, so this never allocates on the transfer thread.
+void fill_band(FrequencyBand& band,
+               const hackrf_sweep_state_t* state,
+               uint64_t start_freq,
+               int power_offset,
+               int num_bins) {
     band.start_hz = start_freq;
     band.end_hz = start_freq + state->sample_rate_hz / 4;
-    band.power_db.reserve(num_bins);
-    band.power_db.insert(
-        band.power_db.begin(),
+    band.power_db.assign(
         &state->fft.pwr[1 + power_offset],
         &state->fft.pwr[1 + power_offset + num_bins]);
-    return band;
-}
-
-std::vector<uint16_t> build_freq_ranges(const hackrf_sweep_state_t* state) {
-    std::vector<uint16_t> ranges;
-    ranges.reserve(static_cast<size_t>(state->num_ranges) * 2);
-
-    for (int i = 0; i < state->num_ranges; ++i) {
-        ranges.push_back(state->frequencies[i * 2]);
-        ranges.push_back(state->frequencies[i * 2 + 1]);
-    }
-    return ranges;
 }
 
 extern "C" {
@@ -51,39 +44,12 @@ extern "C" {
         }
 
         HackRFController* controller = static_cast<HackRFController*>(state->user_ctx);
-        const FFTCallback callback = controller->get_fft_callback();
-
-        if (!callback) {
-            return 0;
-        }
-
-        const int quarter_fft = state->fft.size / 4;
-
-        FFTSweepData data;
-        data.bin_width_hz = state->fft.bin_width;
-        data.fft_size = state->fft.size;
-        data.freq_ranges_mhz = build_freq_ranges(state);
-
-        // Lower band: offset at 5/8 of FFT size
-        data.band_lower = extract_band(
-            state,
-            current_freq,
-            state->fft.size * 5 / 8,
-            quarter_fft);
-
-        // Upper band: starts at sample_rate/2, offset at 1/8 of FFT size
-        data.band_upper = extract_band(
-            state,
-            current_freq + state->sample_rate_hz / 2,
-            state->fft.size / 8,
-            quarter_fft);
-
-        callback(data);
+        controller->process_fft_block(state, current_freq);
         return 0;
     }
 }
 
-HackRFController::HackRFController() = default;
+HackRFController::HackRFController(std::string serial) : serial_(std::move(serial)) {}
 
 HackRFController::~HackRFController() {
     stop_sweep();
@@ -92,6 +58,10 @@ HackRFController::~HackRFController() {
     cleanup_device();
 }
 
+const std::string& HackRFController::serial() const noexcept {
+    return serial_;
+}
+
 bool HackRFController::is_connected() const {
     std::lock_guard<std::mutex> lock(mutex_);
     return device_ != nullptr;
@@ -104,9 +74,9 @@ bool HackRFController::connect_device() {
         cleanup_device();
     }
 
-    int ret = hackrf_open(&device_);
+    int ret = hackrf_open_by_serial(serial_.empty() ? nullptr : serial_.c_str(), &device_);
     if (ret != HACKRF_SUCCESS) {
-        std::cerr << "HackRF device not connected: " << ret << '\n';
+        std::cerr << "HackRF device " << (serial_.empty() ? "" : serial_ + " ") << "not connected: " << ret << '\n';
         device_ = nullptr;
         return false;
     }
@@ -149,6 +119,13 @@ bool HackRFController::connect_device() {
         std::cerr << "Failed to setup FFT: " << ret << '\n';
     }
 
+    // Not sweeping yet, so the transfer thread cannot be using the block
+    const size_t bins_per_band = static_cast<size_t>(sweep_state_->fft.size / 4);
+    sweep_block_.band_lower.power_db.reserve(bins_per_band);
+    sweep_block_.band_upper.power_db.reserve(bins_per_band);
+
+    publish_sweep_config();
+
     return true;
 }
 
@@ -187,38 +164,29 @@ void HackRFController::stop_sweep() {
 
 void HackRFController::set_gain_state(const HackRFGainState& state) {
     std::lock_guard<std::mutex> lock(mutex_);
-    gain_state_ = state;
+    state_.update([&state](HackRFControllerState& next) { next.gain = state; });
     update_device_gain();
 }
 
 void HackRFController::set_amp_enable(bool enable) noexcept {
-    std::unique_lock<std::mutex> lock(mutex_);
-    gain_state_.set_amp_enable(enable);
-    lock.unlock();
-
+    std::lock_guard<std::mutex> lock(mutex_);
+    state_.update([enable](HackRFControllerState& next) { next.gain.set_amp_enable(enable); });
     update_device_gain();
 }
 
 HackRFGainState HackRFController::get_gain_state() const {
-    std::unique_lock<std::mutex> lock(mutex_);
-    lock.unlock();
-
-    return gain_state_;
+    return state_.load()->gain;
 }
 
 void HackRFController::set_vga_gain(int gain) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    gain_state_.set_vga_gain(gain);
-    lock.unlock();
-
+    std::lock_guard<std::mutex> lock(mutex_);
+    state_.update([gain](HackRFControllerState& next) { next.gain.set_vga_gain(gain); });
     update_device_gain();
 }
 
 void HackRFController::set_lna_gain(int gain) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    gain_state_.set_lna_gain(gain);
-    lock.unlock();
-
+    std::lock_guard<std::mutex> lock(mutex_);
+    state_.update([gain](HackRFControllerState& next) { next.gain.set_lna_gain(gain); });
     update_device_gain();
 }
 
@@ -228,9 +196,10 @@ void HackRFController::update_device_gain() {
         return;
     }
 
-    hackrf_set_amp_enable(device_, gain_state_.get_amp_enable() ? 1 : 0);
-    hackrf_set_vga_gain(device_, static_cast<uint32_t>(gain_state_.get_vga_gain()));
-    hackrf_set_lna_gain(device_, static_cast<uint32_t>(gain_state_.get_lna_gain()));
+    const HackRFGainState gain = state_.load()->gain;
+    hackrf_set_amp_enable(device_, gain.get_amp_enable() ? 1 : 0);
+    hackrf_set_vga_gain(device_, static_cast<uint32_t>(gain.get_vga_gain()));
+    hackrf_set_lna_gain(device_, static_cast<uint32_t>(gain.get_lna_gain()));
 }
 
 void HackRFController::cleanup_device() {
@@ -245,12 +214,11 @@ void HackRFController::cleanup_device() {
 
 void HackRFController::set_fft_callback(FFTCallback callback) {
     std::lock_guard<std::mutex> lock(mutex_);
-    fft_callback_ = std::move(callback);
+    state_.update([&callback](HackRFControllerState& next) { next.fft_callback = std::move(callback); });
 }
 
 FFTCallback HackRFController::get_fft_callback() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return fft_callback_;
+    return state_.load()->fft_callback;
 }
 
 bool HackRFController::set_scan_ranges(const std::vector<ScanRange>& ranges) {
@@ -273,34 +241,112 @@ bool HackRFController::set_scan_ranges(const std::vector<ScanRange>& ranges) {
         }
     }
 
-    scan_ranges_ = ranges;
+    state_.update([&ranges](HackRFControllerState& next) { next.scan_ranges = ranges; });
 
     return update_device_scan_ranges();
 }
 
 bool HackRFController::update_device_scan_ranges() {
+    const std::shared_ptr<const HackRFControllerState> current = state_.load();
+    const std::vector<ScanRange>& scan_ranges = current->scan_ranges;
+
     std::vector<uint16_t> freq_ranges;
-    freq_ranges.reserve(scan_ranges_.size() * 2);
+    freq_ranges.reserve(scan_ranges.size() * 2);
 
-    for (const ScanRange& range : scan_ranges_) {
+    for (const ScanRange& range : scan_ranges) {
         freq_ranges.push_back(range.start_mhz);
         freq_ranges.push_back(range.end_mhz);
     }
 
     if (sweep_state_ && device_) {
-        int ret = hackrf_sweep_set_range(sweep_state_.get(), freq_ranges.data(), static_cast<int>(scan_ranges_.size()));
+        int ret = hackrf_sweep_set_range(sweep_state_.get(), freq_ranges.data(), static_cast<int>(scan_ranges.size()));
         if (ret != HACKRF_SUCCESS) {
             std::cerr << "Failed to set sweep range: " << ret << '\n';
             return false;
         }
+
+        if (sweep_state_->fft.size > 0) {
+            publish_sweep_config();
+        }
     }
 
     return true;
 }
 
+void HackRFController::publish_sweep_config() {
+    const std::shared_ptr<const SweepConfig> current = state_.load()->sweep_config;
+
+    auto config = std::make_shared<SweepConfig>();
+    config->generation = current ? current->generation + 1 : 1;
+    config->bin_width_hz = sweep_state_->fft.bin_width;
+    config->fft_size = sweep_state_->fft.size;
+
+    // hackrf_sweeper widens each range to whole tuning steps, so report the
+    // ranges it will actually sweep rather than the requested ones.
+    config->freq_ranges_mhz.reserve(static_cast<size_t>(sweep_state_->num_ranges) * 2);
+    for (int i = 0; i < sweep_state_->num_ranges; ++i) {
+        config->freq_ranges_mhz.push_back(sweep_state_->frequencies[i * 2]);
+        config->freq_ranges_mhz.push_back(sweep_state_->frequencies[i * 2 + 1]);
+    }
+
+    state_.update([&config](HackRFControllerState& next) { next.sweep_config = std::move(config); });
+}
+
+std::shared_ptr<const SweepConfig> HackRFController::get_sweep_config() const {
+    return state_.load()->sweep_config;
+}
+
+std::shared_ptr<const HackRFControllerState> HackRFController::get_state() const noexcept {
+    return state_.load();
+}
+
+// stop_sweep() holds mutex_ while libhackrf joins this thread, which is why
+// the transfer thread only ever reads the published state
+void HackRFController::refresh_block_state() {
+    if (block_state_ && state_.generation() == block_generation_) {
+        return;
+    }
+
+    block_state_ = state_.load();
+    block_generation_ = block_state_->generation;
+    sweep_block_.config = block_state_->sweep_config;
+}
+
+void HackRFController::process_fft_block(const hackrf_sweep_state_t* state, uint64_t current_freq) {
+    pipeline_trace_set_thread_name("libhackrf transfer");
+    PIPELINE_TRACE_SCOPE("process fft block");
+
+    refresh_block_state();
+    if (!block_state_->fft_callback || !sweep_block_.config) {
+        return;
+    }
+
+    const int quarter_fft = state->fft.size / 4;
+
+    // Lower band: offset at 5/8 of FFT size
+    fill_band(sweep_block_.band_lower,
+              state,
+              current_freq,
+              state->fft.size * 5 / 8,
+              quarter_fft);
+
+    // Upper band: starts at sample_rate/2, offset at 1/8 of FFT size
+    fill_band(sweep_block_.band_upper,
+              state,
+              current_freq + state->sample_rate_hz / 2,
+              state->fft.size / 8,
+              quarter_fft);
+
+    sweep_block_.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                    std::chrono::system_clock::now().time_since_epoch())
+                                    .count();
+    sweep_block_.capture_ns = pipeline_now_ns();
+
+    block_state_->fft_callback(sweep_block_);
+}
+
 std::vector<ScanRange> HackRFController::get_scan_ranges() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return scan_ranges_;
+    return state_.load()->scan_ranges;
 }
 
 void HackRFController::restart_sweep() {
@@ -0,0 +1,384 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "device_command_worker.hpp"
+#include "hackrf_controller.hpp"
+#include "multi_device_source.hpp"
+#include "pipeline_metrics.hpp"
+#include "pipeline_trace.hpp"
+#include "replay_source.hpp"
+#include "simulated_source.hpp"
+#include "spectrum_source.hpp"
+#include "sweep_csv.hpp"
+#include "sweep_queue.hpp"
+#include "sweep_record_format.hpp"
+#include "sweep_recorder.hpp"
+#include "sweep_scheduler.hpp"
+#include "unix_socket_server.hpp"
+#include "usb_hotplug.hpp"
+
+// Capture without Qt: sweeps go to a recording, to stdout and/or to a
+// local socket as hackrf_sweep CSV. The main thread is the only consumer
+// and sleeps whenever the queue is empty.
+
+constexpr size_t HEADLESS_QUEUE_CAPACITY = 4096;
+constexpr int HEADLESS_IDLE_SLEEP_MS = 5;
+// A schedule is first planned for an assumed sweep rate, then once more for
+// the rate measured over this long
+constexpr double HEADLESS_REPLAN_AFTER_S = 10.0;
+
+namespace {
+
+std::atomic_bool stop_requested{false};
+std::atomic_bool trace_flush_requested{false};
+
+void request_stop(int /*signal*/) {
+    stop_requested.store(true);
+}
+
+void request_trace_flush(int /*signal*/) {
+    trace_flush_requested.store(true);
+}
+
+struct HeadlessOptions {
+    std::vector<ScheduledRange> ranges;
+    HackRFGainState gain{false, 24, 0};
+    std::vector<std::string> serials;
+    int simulated_devices = 0;
+    std::string replay_path;
+    bool replay_fast = false;
+    std::string record_path;
+    sweep_record::PowerEncoding encoding = sweep_record::PowerEncoding::Float32;
+    float step_db = RECORD_WRITER_DEFAULT_STEP_DB;
+    bool to_stdout = false;
+    std::string socket_path;
+    double duration_s = 0.0;  // 0 runs until SIGINT/SIGTERM
+    std::string metrics_path;
+    std::string trace_path;
+};
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --range START:END[@S] Scan range in MHz, repeatable (default 2000:2700); @S asks for\n"
+              << "                        a revisit every S seconds, the rest is swept in the background\n"
+              << "  --lna DB --vga DB     Gains (default 24 and 0)\n"
+              << "  --amp                 Enable the RF amplifier\n"
+              << "  --devices SERIAL,...  Sweep with these HackRFs, splitting the ranges between them\n"
+              << "  --simulate N          Sweep with N simulated HackRFs instead of real ones\n"
+              << "  --replay FILE         Read hackrf_sweep CSV instead of a HackRF\n"
+              << "  --replay-fast         Replay as fast as possible\n"
+              << "  --record FILE         Write a sweep recording\n"
+              << "  --encoding NAME       float32, int16 or compressed (default float32)\n"
+              << "  --step DB             Quantization step for int16 and compressed\n"
+              << "  --stdout              Write hackrf_sweep CSV to stdout\n"
+              << "  --socket PATH         Serve hackrf_sweep CSV on a unix socket\n"
+              << "  --duration SECONDS    Stop after this long\n"
+              << "  --metrics FILE        Write pipeline metrics as JSON on exit\n"
+              << "  --trace FILE          Trace the pipeline and write a Chrome trace on exit or SIGUSR1\n";
+}
+
+bool parse_options(int argc, char* argv[], HeadlessOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (std::strcmp(arg, "--range") == 0 && has_value) {
+            unsigned start = 0;
+            unsigned end = 0;
+            double revisit_s = 0.0;
+            if (std::sscanf(argv[++i], "%u:%u@%lf", &start, &end, &revisit_s) < 2) {
+                return false;
+            }
+            options.ranges.push_back({{static_cast<uint16_t>(start), static_cast<uint16_t>(end)}, revisit_s});
+        } else if (std::strcmp(arg, "--lna") == 0 && has_value) {
+            options.gain.set_lna_gain(std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--vga") == 0 && has_value) {
+            options.gain.set_vga_gain(std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--amp") == 0) {
+            options.gain.set_amp_enable(true);
+        } else if (std::strcmp(arg, "--devices") == 0 && has_value) {
+            const std::string list = argv[++i];
+            size_t start = 0;
+            while (start <= list.size()) {
+                const size_t end = std::min(list.find(',', start), list.size());
+                if (end > start) {
+                    options.serials.push_back(list.substr(start, end - start));
+                }
+                start = end + 1;
+            }
+        } else if (std::strcmp(arg, "--simulate") == 0 && has_value) {
+            options.simulated_devices = std::atoi(argv[++i]);
+            if (options.simulated_devices <= 0) {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--replay") == 0 && has_value) {
+            options.replay_path = argv[++i];
+        } else if (std::strcmp(arg, "--replay-fast") == 0) {
+            options.replay_fast = true;
+        } else if (std::strcmp(arg, "--record") == 0 && has_value) {
+            options.record_path = argv[++i];
+        } else if (std::strcmp(arg, "--encoding") == 0 && has_value) {
+            const std::string name = argv[++i];
+            if (name == "float32") {
+                options.encoding = sweep_record::PowerEncoding::Float32;
+            } else if (name == "int16") {
+                options.encoding = sweep_record::PowerEncoding::Int16;
+            } else if (name == "compressed") {
+                options.encoding = sweep_record::PowerEncoding::RiceDelta;
+            } else {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--step") == 0 && has_value) {
+            options.step_db = static_cast<float>(std::atof(argv[++i]));
+        } else if (std::strcmp(arg, "--stdout") == 0) {
+            options.to_stdout = true;
+        } else if (std::strcmp(arg, "--socket") == 0 && has_value) {
+            options.socket_path = argv[++i];
+        } else if (std::strcmp(arg, "--duration") == 0 && has_value) {
+            options.duration_s = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--metrics") == 0 && has_value) {
+            options.metrics_path = argv[++i];
+        } else if (std::strcmp(arg, "--trace") == 0 && has_value) {
+            options.trace_path = argv[++i];
+        } else {
+            return false;
+        }
+    }
+
+    if (options.ranges.empty()) {
+        options.ranges.push_back({{2000, 2700}, 0.0});
+    }
+
+    return options.to_stdout || !options.socket_path.empty() || !options.record_path.empty();
+}
+
+// libhackrf stays initialized for as long as this lives. Declared before
+// the source, so the devices close first on every way out of main.
+class HackRFLibrary {
+   public:
+    explicit HackRFLibrary(bool init) : initialized_(init) {
+        if (initialized_) {
+            hackrf_init();
+        }
+    }
+
+    ~HackRFLibrary() {
+        if (initialized_) {
+            hackrf_exit();
+        }
+    }
+
+    HackRFLibrary(const HackRFLibrary&) = delete;
+    HackRFLibrary& operator=(const HackRFLibrary&) = delete;
+
+   private:
+    bool initialized_;
+};
+
+// One device is used directly; several are partitioned and merged
+std::unique_ptr<SpectrumSource> make_live_source(const HeadlessOptions& options) {
+    std::vector<std::unique_ptr<SpectrumSource>> devices;
+    if (options.simulated_devices > 0) {
+        for (int i = 0; i < options.simulated_devices; ++i) {
+            devices.push_back(std::make_unique<SimulatedSource>(static_cast<uint32_t>(i)));
+        }
+    } else if (options.serials.empty()) {
+        devices.push_back(std::make_unique<HackRFController>());
+    } else {
+        for (const std::string& serial : options.serials) {
+            devices.push_back(std::make_unique<HackRFController>(serial));
+        }
+    }
+
+    if (devices.size() == 1) {
+        return std::move(devices.front());
+    }
+    return std::make_unique<MultiDeviceSource>(std::move(devices));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    HeadlessOptions options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+
+    if (!options.trace_path.empty()) {
+        pipeline_trace_start();
+        pipeline_trace_set_thread_name("headless main");
+        std::signal(SIGUSR1, request_trace_flush);
+    }
+
+    const bool replay = !options.replay_path.empty();
+    const bool use_hackrf = !replay && options.simulated_devices == 0;
+    const HackRFLibrary hackrf_library(use_hackrf);
+    std::unique_ptr<SpectrumSource> source;
+    SweepScheduler* scheduler = nullptr;
+
+    if (replay) {
+        auto replay_source = std::make_unique<ReplaySource>(
+            options.replay_fast ? ReplayPace::AsFastAsPossible : ReplayPace::Original, false);
+        if (!replay_source->open(options.replay_path)) {
+            return 1;
+        }
+        replay_source->set_finished_callback([](const ReplayStats&) { stop_requested.store(true); });
+        source = std::move(replay_source);
+    } else {
+        source = make_live_source(options);
+
+        const bool scheduled = std::any_of(options.ranges.begin(), options.ranges.end(),
+                                           [](const ScheduledRange& range) { return range.revisit_s > 0.0; });
+        std::vector<ScanRange> ranges;
+        for (const ScheduledRange& range : options.ranges) {
+            ranges.push_back(range.range);
+        }
+
+        bool configured = false;
+        if (scheduled) {
+            auto sweep_scheduler = std::make_unique<SweepScheduler>(std::move(source));
+            scheduler = sweep_scheduler.get();
+            configured = scheduler->set_schedule(options.ranges);
+            source = std::move(sweep_scheduler);
+        } else {
+            configured = source->set_scan_ranges(ranges);
+        }
+
+        if (!configured) {
+            return 1;
+        }
+        source->set_gain_state(options.gain);
+    }
+
+    SweepRecorder recorder;
+    if (!options.record_path.empty() && !recorder.start(options.record_path, options.encoding, options.step_db)) {
+        return 1;
+    }
+
+    UnixSocketServer socket_server;
+    if (!options.socket_path.empty() && !socket_server.listen(options.socket_path)) {
+        return 1;
+    }
+
+    const bool stream_csv = options.to_stdout || !options.socket_path.empty();
+    SweepQueue queue(HEADLESS_QUEUE_CAPACITY, OverflowPolicy::DropOldest);
+
+    // Assembly here is formatting a block as CSV
+    PipelineMetrics metrics;
+    metrics.set_enabled(!options.metrics_path.empty());
+
+    source->set_fft_callback([&](const FFTSweepData& data) {
+        metrics.count(PipelineCounter::BlocksReceived);
+        recorder.push(data);
+        if (stream_csv) {
+            queue.push(data);
+        }
+    });
+
+    {
+        DeviceCommandWorker commands(source.get());
+        UsbHotplugMonitor hotplug(&commands);
+
+        if (!replay) {
+            if (use_hackrf) {
+                hotplug.start();
+            }
+            commands.connect_device();
+            commands.set_gain_state(options.gain);
+        }
+        commands.start_sweep();
+
+        std::string lines;
+        auto stream_pending = [&]() {
+            socket_server.accept_pending();
+
+            PIPELINE_TRACE_SCOPE("stream csv");
+            lines.clear();
+            queue.drain(
+                [&lines, &metrics](const FFTSweepData& data) {
+                    const PipelineTimer timer(metrics, PipelineTiming::Assembly);
+                    metrics.record(PipelineTiming::QueueWait, data.capture_ns, timer.start_ns());
+                    metrics.count(PipelineCounter::BlocksAssembled);
+                    append_sweep_csv(lines, data);
+                },
+                queue.capacity());
+
+            if (options.to_stdout && !lines.empty()) {
+                std::fwrite(lines.data(), 1, lines.size(), stdout);
+            }
+            socket_server.broadcast(lines);
+            return !lines.empty();
+        };
+
+        const auto started = std::chrono::steady_clock::now();
+        bool replanned = scheduler == nullptr;
+        while (!stop_requested.load()) {
+            const double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+            if (options.duration_s > 0.0 && elapsed_s >= options.duration_s) {
+                break;
+            }
+
+            if (!replanned && elapsed_s >= HEADLESS_REPLAN_AFTER_S) {
+                replanned = true;
+                const double steps_per_second = scheduler->measured_steps_per_second();
+                if (scheduler->replan()) {
+                    std::cerr << "Schedule replanned for " << steps_per_second << " tuning steps/s\n";
+                }
+            }
+
+            if (trace_flush_requested.exchange(false)) {
+                pipeline_trace_write_json(options.trace_path);
+            }
+
+            if (!stream_pending()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(HEADLESS_IDLE_SLEEP_MS));
+            }
+        }
+
+        source->stop_sweep();
+        while (stream_pending()) {
+        }
+    }
+
+    source->set_fft_callback(nullptr);
+    recorder.stop();
+    std::fflush(stdout);
+
+    const SweepRecorderStats record_stats = recorder.stats();
+    const SweepQueueStats queue_stats = queue.stats();
+    if (!options.metrics_path.empty()) {
+        metrics.count(PipelineCounter::BlocksDropped, queue_stats.dropped());
+        write_pipeline_metrics_json(metrics.snapshot(), options.metrics_path);
+    }
+    if (!options.trace_path.empty()) {
+        pipeline_trace_stop();
+        pipeline_trace_write_json(options.trace_path);
+    }
+    std::cerr << "Blocks streamed: " << queue_stats.pushed << " (" << queue_stats.dropped() << " dropped), recorded: "
+              << record_stats.blocks << " (" << record_stats.dropped << " dropped)\n";
+
+    if (scheduler != nullptr) {
+        for (const RangeRevisit& revisit : scheduler->revisit_report()) {
+            std::cerr << "Range " << revisit.target.range.start_mhz << '-' << revisit.target.range.end_mhz
+                      << " MHz: revisit " << revisit.achieved_s << " s (target " << revisit.target.revisit_s
+                      << " s, planned " << revisit.expected_s << " s, " << revisit.visits << " visits)\n";
+        }
+    }
+
+    return 0;
+}
@@ -1,94 +1,235 @@
-#include <libusb-1.0/libusb.h>
-
 #include <QApplication>
-#include <atomic>
-#include <chrono>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QMetaObject>
+#include <QStringList>
 #include <iostream>
-#include <thread>
+#include <memory>
+#include <vector>
 
+#include "device_command_worker.hpp"
 #include "hackrf_controller.hpp"
 #include "main_window.hpp"
+#include "multi_device_source.hpp"
+#include "pipeline_metrics.hpp"
+#include "pipeline_trace.hpp"
+#include "replay_source.hpp"
+#include "simulated_source.hpp"
+#include "usb_hotplug.hpp"
+#include "waterfall_history.hpp"
+
+// Settings of the window that do not depend on where the sweeps come from
+struct WindowOptions {
+    QString metrics_path;
+    WaterfallHistoryConfig history;
+};
+
+// Shows the window until the application quits. With a metrics path the
+// pipeline is instrumented from the start and its metrics written on exit.
+int exec_main_window(QApplication& app, MainWindow& main_window, const WindowOptions& options) {
+    if (!main_window.set_history_config(options.history)) {
+        return 1;
+    }
+    main_window.set_metrics_enabled(!options.metrics_path.isEmpty());
+    main_window.showMaximized();
 
-using namespace std::chrono_literals;
+    const int ret = app.exec();
 
-constexpr int HACKRF_VENDOR_ID = 0x1d50;
-constexpr auto HOTPLUG_DELAY = 200ms;
+    if (!options.metrics_path.isEmpty()) {
+        write_pipeline_metrics_json(main_window.pipeline_metrics().snapshot(), options.metrics_path.toStdString());
+    }
+    return ret;
+}
 
-int hotplug_callback(struct libusb_context* /*ctx*/, struct libusb_device* /*dev*/,
-                     libusb_hotplug_event /*event*/, void* user_data) {
-    auto* controller = static_cast<HackRFController*>(user_data);
+int run_replay(QApplication& app, const QString& path, ReplayPace pace, bool loop, bool exit_at_end,
+               const WindowOptions& options) {
+    ReplaySource replay(pace, loop);
+    if (!replay.open(path.toStdString())) {
+        return 1;
+    }
 
-    std::this_thread::sleep_for(HOTPLUG_DELAY);
+    replay.set_finished_callback([&app, exit_at_end](const ReplayStats& stats) {
+        std::cerr << "Replayed " << stats.blocks << " blocks in " << stats.elapsed_s << " s ("
+                  << (stats.elapsed_s > 0.0 ? stats.blocks / stats.elapsed_s : 0.0) << " blocks/s)\n";
+        if (exit_at_end) {
+            QMetaObject::invokeMethod(&app, &QApplication::quit, Qt::QueuedConnection);
+        }
+    });
 
-    controller->connect_device();
-    controller->start_sweep();
-    return 0;
-}
+    int ret = 0;
+    {
+        DeviceCommandWorker commands(&replay);
+        MainWindow main_window(&replay, &commands);
 
-int main(int argc, char* argv[]) {
-    hackrf_init();
+        commands.start_sweep();
+        ret = exec_main_window(app, main_window, options);
+    }
+    replay.stop_sweep();
 
-    HackRFController controller;
-    controller.set_scan_ranges({{2000, 2700}});  // Default 2 GHz to 2.7 GHz
+    return ret;
+}
 
-    if (controller.connect_device()) {
-        controller.start_sweep();
+int run_live(QApplication& app, SpectrumSource& source, bool use_hotplug, const WindowOptions& options) {
+    source.set_scan_ranges({{2000, 2700}});  // Default 2 GHz to 2.7 GHz
+
+    if (source.connect_device()) {
+        source.start_sweep();
 
         HackRFGainState gain_state{false, 24, 0};
-        controller.set_gain_state(gain_state);
-    }
-
-    libusb_hotplug_callback_handle callback_handle{};
-    libusb_context* libusb_ctx = nullptr;
-    int rc = libusb_init(&libusb_ctx);
-
-    if (rc != LIBUSB_SUCCESS) {
-        std::cerr << "Failed to initialize libusb: " << rc << "\n";
-    } else {
-        rc = libusb_hotplug_register_callback(
-            libusb_ctx,
-            LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED,
-            0, HACKRF_VENDOR_ID, USB_BOARD_ID_HACKRF_ONE, LIBUSB_HOTPLUG_MATCH_ANY,
-            hotplug_callback, &controller, &callback_handle);
-
-        if (rc != LIBUSB_SUCCESS) {
-            std::cerr << "Error creating a hotplug callback: " << rc << "\n";
-            libusb_hotplug_deregister_callback(libusb_ctx, callback_handle);
-            libusb_exit(libusb_ctx);
-            libusb_ctx = nullptr;
+        source.set_gain_state(gain_state);
+    }
+
+    int ret = 0;
+    {
+        // Declared first so it outlives the hotplug monitor and the window
+        DeviceCommandWorker commands(&source);
+
+        UsbHotplugMonitor hotplug(&commands);
+        if (use_hotplug) {
+            hotplug.start();
         }
+
+        MainWindow main_window(&source, &commands);
+        ret = exec_main_window(app, main_window, options);
     }
 
-    std::atomic_bool libusb_running{libusb_ctx != nullptr};
-    std::thread libusb_refresh_events;
-    if (libusb_ctx) {
-        libusb_refresh_events = std::thread([&libusb_running, libusb_ctx]() {
-            while (libusb_running.load(std::memory_order_relaxed)) {
-                libusb_handle_events_completed(libusb_ctx, nullptr);
-            }
-        });
+    if (source.is_connected()) {
+        source.stop_sweep();
     }
 
-    QApplication app(argc, argv);
-    MainWindow main_window(&controller);
-    main_window.showMaximized();
+    return ret;
+}
 
-    int ret = app.exec();
+// Several devices are partitioned and merged into one source
+std::unique_ptr<SpectrumSource> make_multi_device(std::vector<std::unique_ptr<SpectrumSource>> devices) {
+    if (devices.size() == 1) {
+        return std::move(devices.front());
+    }
+    return std::make_unique<MultiDeviceSource>(std::move(devices));
+}
 
-    if (libusb_ctx) {
-        libusb_running.store(false, std::memory_order_relaxed);
-        if (libusb_refresh_events.joinable()) {
-            libusb_refresh_events.join();
-        }
-        libusb_hotplug_deregister_callback(libusb_ctx, callback_handle);
-        libusb_exit(libusb_ctx);
+int run_hackrf(QApplication& app, const QStringList& serials, const WindowOptions& options) {
+    hackrf_init();
+
+    std::vector<std::unique_ptr<SpectrumSource>> devices;
+    if (serials.isEmpty()) {
+        devices.push_back(std::make_unique<HackRFController>());
+    }
+    for (const QString& serial : serials) {
+        devices.push_back(std::make_unique<HackRFController>(serial.toStdString()));
     }
 
-    if (controller.is_connected()) {
-        controller.stop_sweep();
+    int ret = 0;
+    {
+        const std::unique_ptr<SpectrumSource> source = make_multi_device(std::move(devices));
+        ret = run_live(app, *source, true, options);
     }
 
     hackrf_exit();
 
     return ret;
 }
+
+int run_simulated(QApplication& app, int count, const WindowOptions& options) {
+    std::vector<std::unique_ptr<SpectrumSource>> devices;
+    for (int i = 0; i < count; ++i) {
+        devices.push_back(std::make_unique<SimulatedSource>(static_cast<uint32_t>(i)));
+    }
+
+    const std::unique_ptr<SpectrumSource> source = make_multi_device(std::move(devices));
+    return run_live(app, *source, false, options);
+}
+
+int main(int argc, char* argv[]) {
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+
+    QCommandLineOption replay_option(
+        "replay", "Play back sweeps recorded by hackrf_sweep from <file> instead of using a HackRF.", "file");
+    QCommandLineOption replay_fast_option(
+        "replay-fast", "Replay as fast as possible instead of at the recorded pace.");
+    QCommandLineOption replay_loop_option(
+        "replay-loop", "Start the replay over when the end of the file is reached.");
+    QCommandLineOption replay_exit_option(
+        "replay-exit", "Quit once the replay has finished and print its throughput.");
+    QCommandLineOption devices_option(
+        "devices", "Sweep with the HackRFs with these comma-separated serials, splitting the ranges between them.",
+        "serials");
+    QCommandLineOption simulate_option(
+        "simulate", "Sweep with <count> simulated HackRFs instead of real ones.", "count");
+    QCommandLineOption metrics_option(
+        "metrics", "Show the pipeline metrics overlay and write the metrics to <file> as JSON on exit.", "file");
+    QCommandLineOption trace_option(
+        "trace", "Trace the pipeline from the start and write a Chrome trace to <file> on exit.", "file");
+    QCommandLineOption history_memory_option(
+        "history-memory", "Keep at most <MiB> of waterfall history in memory (default 256).", "MiB");
+    QCommandLineOption history_spill_option(
+        "history-spill", "Spill older full-resolution waterfall history to the scratch file <file>.", "file");
+    QCommandLineOption history_spill_size_option(
+        "history-spill-size", "Size of the history spill file in MiB (default 4096).", "MiB");
+
+    parser.addOption(replay_option);
+    parser.addOption(replay_fast_option);
+    parser.addOption(replay_loop_option);
+    parser.addOption(replay_exit_option);
+    parser.addOption(devices_option);
+    parser.addOption(simulate_option);
+    parser.addOption(metrics_option);
+    parser.addOption(trace_option);
+    parser.addOption(history_memory_option);
+    parser.addOption(history_spill_option);
+    parser.addOption(history_spill_size_option);
+    parser.process(app);
+
+    constexpr size_t MIB = size_t{1} << 20;
+
+    WindowOptions options;
+    options.metrics_path = parser.value(metrics_option);
+    if (parser.isSet(history_memory_option)) {
+        options.history.memory_bytes = parser.value(history_memory_option).toULongLong() * MIB;
+    }
+    if (parser.isSet(history_spill_option)) {
+        options.history.spill_path = parser.value(history_spill_option).toStdString();
+        options.history.spill_bytes =
+            (parser.isSet(history_spill_size_option) ? parser.value(history_spill_size_option).toULongLong() : 4096) *
+            MIB;
+    }
+    if (options.history.memory_bytes == 0 || (parser.isSet(history_spill_option) && options.history.spill_bytes == 0)) {
+        std::cerr << "--history-memory and --history-spill-size need a size in MiB\n";
+        return 1;
+    }
+
+    const QString trace_path = parser.value(trace_option);
+    if (!trace_path.isEmpty()) {
+        pipeline_trace_set_thread_name("GUI");
+        pipeline_trace_start();
+    }
+
+    const int ret = [&]() {
+        if (parser.isSet(replay_option)) {
+            const ReplayPace pace =
+                parser.isSet(replay_fast_option) ? ReplayPace::AsFastAsPossible : ReplayPace::Original;
+            return run_replay(app, parser.value(replay_option), pace,
+                              parser.isSet(replay_loop_option), parser.isSet(replay_exit_option), options);
+        }
+
+        if (parser.isSet(simulate_option)) {
+            const int count = parser.value(simulate_option).toInt();
+            if (count <= 0) {
+                std::cerr << "--simulate needs a device count\n";
+                return 1;
+            }
+            return run_simulated(app, count, options);
+        }
+
+        return run_hackrf(app, parser.value(devices_option).split(',', Qt::SkipEmptyParts), options);
+    }();
+
+    if (!trace_path.isEmpty()) {
+        pipeline_trace_stop();
+        pipeline_trace_write_json(trace_path.toStdString());
+    }
+    return ret;
+}
@@ -1,27 +1,83 @@
 #include "main_window.hpp"
 
+#include <qwt_plot_magnifier.h>
+#include <qwt_plot_marker.h>
+#include <qwt_plot_panner.h>
+#include <qwt_scale_widget.h>
+
 #include <QCheckBox>
+#include <QComboBox>
+#include <QDateTime>
+#include <QDoubleSpinBox>
+#include <QFileDialog>
+#include <QFileInfo>
 #include <QFormLayout>
 #include <QGroupBox>
 #include <QHBoxLayout>
+#include <QHeaderView>
 #include <QLabel>
 #include <QLineEdit>
 #include <QListWidget>
 #include <QMessageBox>
 #include <QMetaObject>
+#include <QPen>
 #include <QPushButton>
+#include <QSignalBlocker>
 #include <QSlider>
 #include <QSpinBox>
 #include <QSplitter>
+#include <QStatusBar>
+#include <QTableView>
 #include <QVBoxLayout>
 #include <QVector>
 #include <QWidget>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <span>
+#include <utility>
 
+#include "frequency_scale.hpp"
+#include "pipeline_trace.hpp"
 #include "thermal_color_map.hpp"
 
-MainWindow::MainWindow(HackRFController* ctrl, QWidget* parent)
-    : QMainWindow(parent), controller_(ctrl) {
+namespace {
+
+struct ChannelPlanPreset {
+    const char* label;
+    RadioTechnology technology;
+    uint32_t bandwidth_hz;
+};
+
+// Channel plans built from the band tables, tiling every band in range
+constexpr std::array<ChannelPlanPreset, 5> CHANNEL_PLAN_PRESETS = {{
+    {"LTE, 5 MHz", RadioTechnology::LTE, 5'000'000},
+    {"LTE, 10 MHz", RadioTechnology::LTE, 10'000'000},
+    {"LTE, 20 MHz", RadioTechnology::LTE, 20'000'000},
+    {"NR, 20 MHz", RadioTechnology::NR, 20'000'000},
+    {"NR, 100 MHz", RadioTechnology::NR, 100'000'000},
+}};
+
+// Combo entries around the presets
+constexpr int CHANNEL_PLAN_NONE = 0;
+constexpr int CHANNEL_PLAN_FILE = static_cast<int>(CHANNEL_PLAN_PRESETS.size()) + 1;
+
+bool same_layout(const SpectrumLayout& a, const SpectrumLayout& b) {
+    return a.bin_width_hz() == b.bin_width_hz() &&
+           std::equal(a.segments().begin(), a.segments().end(), b.segments().begin(), b.segments().end(),
+                      [](const SpectrumSegment& x, const SpectrumSegment& y) {
+                          return x.start_hz == y.start_hz && x.end_hz == y.end_hz && x.num_bins == y.num_bins;
+                      });
+}
+
+}  // namespace
+
+MainWindow::MainWindow(SpectrumSource* source, DeviceCommandWorker* commands, QWidget* parent)
+    : QMainWindow(parent),
+      source_(source),
+      commands_(commands),
+      gain_state_(source->get_gain_state()),
+      scan_ranges_(source->get_scan_ranges()) {
     auto* central_widget = new QWidget(this);
     auto* main_layout = new QHBoxLayout(central_widget);
 
@@ -38,17 +94,52 @@ MainWindow::MainWindow(HackRFController* ctrl, QWidget* parent)
     custom_plot_->setAxisTitle(QwtPlot::yLeft, "Power (dB)");
     custom_plot_->setAxisScale(QwtPlot::yLeft, -110, 20);
 
+    // Both plots are drawn in layout columns, so disjoint scan ranges sit
+    // side by side and the axis maps the columns back to frequency
+    custom_plot_->setAxisScaleEngine(QwtPlot::xBottom, new FrequencyScaleEngine(&dataset_spectrum_));
+    custom_plot_->setAxisScaleDraw(QwtPlot::xBottom, new FrequencyScaleDraw(&dataset_spectrum_));
+
     curve_ = new QwtPlotCurve();
     curve_->setTitle("Sweep Data");
+    spectrum_series_ = new SpectrumSeriesData(&dataset_spectrum_);
+    curve_->setData(spectrum_series_);
     curve_->attach(custom_plot_);
 
+    const std::array<const char*, TRACE_KIND_COUNT> trace_titles = {"Max Hold", "Min Hold", "Average"};
+    const std::array<QColor, TRACE_KIND_COUNT> trace_colors = {Qt::red, Qt::darkCyan, Qt::darkGreen};
+    for (size_t i = 0; i < TRACE_KIND_COUNT; ++i) {
+        trace_curves_[i] = new QwtPlotCurve(trace_titles[i]);
+        trace_curves_[i]->setPen(QPen(trace_colors[i]));
+        trace_series_[i] = new SpectrumSeriesData(&dataset_spectrum_, static_cast<TraceKind>(i));
+        trace_curves_[i]->setData(trace_series_[i]);
+        trace_curves_[i]->setVisible(false);
+        trace_curves_[i]->attach(custom_plot_);
+    }
+
+    // Zoom and pan along frequency only; the curve is re-decimated for
+    // whatever span ends up visible.
+    auto* magnifier = new QwtPlotMagnifier(custom_plot_->canvas());
+    magnifier->setAxisEnabled(QwtPlot::yLeft, false);
+    auto* panner = new QwtPlotPanner(custom_plot_->canvas());
+    panner->setAxisEnabled(QwtPlot::yLeft, false);
+    connect(custom_plot_->axisWidget(QwtPlot::xBottom), &QwtScaleWidget::scaleDivChanged,
+            this, &MainWindow::refresh_spectrum_curve, Qt::QueuedConnection);
+
     plot_layout->addWidget(custom_plot_);
 
+    // Drawn over the spectrum canvas while pipeline metrics are enabled
+    metrics_overlay_ = new QLabel(custom_plot_->canvas());
+    metrics_overlay_->setStyleSheet(
+        "QLabel { background: rgba(0, 0, 0, 160); color: white; font-family: monospace; padding: 4px; }");
+    metrics_overlay_->move(8, 8);
+    metrics_overlay_->hide();
+
     color_plot_ = new QwtPlot();
+    color_plot_->setAxisScaleEngine(QwtPlot::xBottom, new FrequencyScaleEngine(&dataset_spectrum_));
+    color_plot_->setAxisScaleDraw(QwtPlot::xBottom, new FrequencyScaleDraw(&dataset_spectrum_));
 
     color_map_ = new QwtPlotSpectrogram();
     color_map_->setColorMap(new ThermalColorMap());
-    color_map_->attach(color_plot_);
 
     plot_layout->addWidget(color_plot_);
 
@@ -66,13 +157,62 @@ MainWindow::MainWindow(HackRFController* ctrl, QWidget* parent)
     main_layout->addWidget(splitter);
     setCentralWidget(central_widget);
 
-    controller_->set_fft_callback([this](const FFTSweepData& data) {
-        QMetaObject::invokeMethod(this, [this, data]() { update_plot(data); }, Qt::QueuedConnection);
+    dropped_blocks_label_ = new QLabel("Dropped blocks: 0");
+    statusBar()->addPermanentWidget(dropped_blocks_label_);
+
+    source_->set_fft_callback([this](const FFTSweepData& data) {
+        metrics_.count(PipelineCounter::BlocksReceived);
+        sweep_queue_.push(data);
+        recorder_.push(data);
     });
 
+    commands_->set_completion_callback([this](const DeviceCommandResult& result) {
+        QMetaObject::invokeMethod(this, [this, result]() { handle_command_result(result); }, Qt::QueuedConnection);
+    });
+
+    noise_floor_label_ = new QLabel();
+    statusBar()->addPermanentWidget(noise_floor_label_);
+
+    render_stats_label_ = new QLabel();
+    statusBar()->addPermanentWidget(render_stats_label_);
+
+    render_scheduler_ = new RenderScheduler(this);
+    connect(render_scheduler_, &RenderScheduler::frame_due, this, &MainWindow::render_frame);
+
+    drain_timer_ = new QTimer(this);
+    connect(drain_timer_, &QTimer::timeout, this, &MainWindow::drain_sweep_queue);
+    drain_timer_->start(SWEEP_DRAIN_INTERVAL_MS);
+
+    playback_timer_ = new QTimer(this);
+    playback_timer_->setTimerType(Qt::PreciseTimer);
+    connect(playback_timer_, &QTimer::timeout, this, &MainWindow::advance_playback);
+
     refresh_range_list();
 }
 
+MainWindow::~MainWindow() {
+    commands_->set_completion_callback(nullptr);
+    source_->set_fft_callback(nullptr);
+}
+
+void MainWindow::drain_sweep_queue() {
+    PIPELINE_TRACE_SCOPE("drain sweep queue");
+
+    if (playback_.is_open()) {
+        sweep_queue_.drain([](const FFTSweepData&) {}, sweep_queue_.capacity());
+        return;
+    }
+
+    sweep_queue_.drain([this](const FFTSweepData& data) { update_plot(data); }, sweep_queue_.capacity());
+
+    const uint64_t dropped = sweep_queue_.stats().dropped();
+    if (dropped != reported_dropped_blocks_) {
+        metrics_.count(PipelineCounter::BlocksDropped, dropped - reported_dropped_blocks_);
+        reported_dropped_blocks_ = dropped;
+        dropped_blocks_label_->setText(QString("Dropped blocks: %1").arg(dropped));
+    }
+}
+
 void MainWindow::setup_sidebar(QWidget* sidebar) {
     auto* sidebar_layout = new QVBoxLayout(sidebar);
 
@@ -82,9 +222,10 @@ void MainWindow::setup_sidebar(QWidget* sidebar) {
 
     // AMP Enable
     auto* amp_check_box = new QCheckBox("AMP (+14 dB)");
-    amp_check_box->setChecked(controller_->get_gain_state().get_amp_enable());
+    amp_check_box->setChecked(gain_state_.get_amp_enable());
     connect(amp_check_box, &QCheckBox::stateChanged, [this](int state) {
-        controller_->set_amp_enable(state == Qt::Checked);
+        gain_state_.set_amp_enable(state == Qt::Checked);
+        commands_->set_gain_state(gain_state_);
         update_total_gain();
     });
     gain_layout->addWidget(amp_check_box);
@@ -96,15 +237,16 @@ void MainWindow::setup_sidebar(QWidget* sidebar) {
 
     auto* lna_slider = new QSlider(Qt::Horizontal);
     lna_slider->setRange(0, hackrf_hardware::LNA_MAX / hackrf_hardware::LNA_STEP);
-    lna_slider->setValue(controller_->get_gain_state().get_lna_gain() / hackrf_hardware::LNA_STEP);
+    lna_slider->setValue(gain_state_.get_lna_gain() / hackrf_hardware::LNA_STEP);
     lna_slider->setTickInterval(1);
     lna_slider->setSingleStep(1);
     lna_slider->setTickPosition(QSlider::TicksBelow);
 
-    auto* lna_value_label = new QLabel(QString::number(controller_->get_gain_state().get_lna_gain()) + " dB");
+    auto* lna_value_label = new QLabel(QString::number(gain_state_.get_lna_gain()) + " dB");
     connect(lna_slider, &QSlider::valueChanged, [this, lna_value_label](int value) {
         int gain = value * hackrf_hardware::LNA_STEP;
-        controller_->set_lna_gain(gain);
+        gain_state_.set_lna_gain(gain);
+        commands_->set_gain_state(gain_state_);
         lna_value_label->setText(QString::number(gain) + " dB");
         update_total_gain();
     });
@@ -120,15 +262,16 @@ void MainWindow::setup_sidebar(QWidget* sidebar) {
 
     auto* vga_slider = new QSlider(Qt::Horizontal);
     vga_slider->setRange(0, hackrf_hardware::VGA_MAX / hackrf_hardware::VGA_STEP);
-    vga_slider->setValue(controller_->get_gain_state().get_vga_gain() / hackrf_hardware::VGA_STEP);
+    vga_slider->setValue(gain_state_.get_vga_gain() / hackrf_hardware::VGA_STEP);
     vga_slider->setTickInterval(1);
     vga_slider->setSingleStep(1);
     vga_slider->setTickPosition(QSlider::TicksBelow);
 
-    auto* vga_value_label = new QLabel(QString::number(controller_->get_gain_state().get_vga_gain()) + " dB");
+    auto* vga_value_label = new QLabel(QString::number(gain_state_.get_vga_gain()) + " dB");
     connect(vga_slider, &QSlider::valueChanged, [this, vga_value_label](int value) {
         int gain = value * hackrf_hardware::VGA_STEP;
-        controller_->set_vga_gain(gain);
+        gain_state_.set_vga_gain(gain);
+        commands_->set_gain_state(gain_state_);
         vga_value_label->setText(QString::number(gain) + " dB");
         update_total_gain();
     });
@@ -199,14 +342,242 @@ void MainWindow::setup_sidebar(QWidget* sidebar) {
 
     sidebar_layout->addWidget(ranges_group);
 
+    // Recording Group
+    auto* record_group = new QGroupBox("Recording");
+    auto* record_layout = new QFormLayout(record_group);
+
+    record_encoding_combo_ = new QComboBox();
+    record_encoding_combo_->addItem("Float32", static_cast<int>(sweep_record::PowerEncoding::Float32));
+    record_encoding_combo_->addItem("Int16", static_cast<int>(sweep_record::PowerEncoding::Int16));
+    record_encoding_combo_->addItem("Compressed", static_cast<int>(sweep_record::PowerEncoding::RiceDelta));
+    record_layout->addRow("Samples:", record_encoding_combo_);
+
+    // Quantization step of the Int16 and Compressed encodings
+    record_step_spin_ = new QDoubleSpinBox();
+    record_step_spin_->setRange(0.01, 2.0);
+    record_step_spin_->setSingleStep(0.01);
+    record_step_spin_->setValue(SWEEP_CODEC_DEFAULT_STEP_DB);
+    record_step_spin_->setSuffix(" dB");
+    record_layout->addRow("Step:", record_step_spin_);
+
+    record_btn_ = new QPushButton("Record");
+    record_btn_->setCheckable(true);
+    connect(record_btn_, &QPushButton::toggled, this, &MainWindow::toggle_recording);
+    record_layout->addRow(record_btn_);
+
+    record_stats_label_ = new QLabel("Not recording");
+    record_layout->addRow(record_stats_label_);
+
+    sidebar_layout->addWidget(record_group);
+
+    // Playback Group
+    auto* playback_group = new QGroupBox("Playback");
+    auto* playback_layout = new QFormLayout(playback_group);
+
+    auto* open_recording_btn = new QPushButton("Open Recording...");
+    connect(open_recording_btn, &QPushButton::clicked, this, &MainWindow::open_recording);
+    playback_layout->addRow(open_recording_btn);
+
+    playback_slider_ = new QSlider(Qt::Horizontal);
+    playback_slider_->setRange(0, PLAYBACK_SLIDER_STEPS);
+    connect(playback_slider_, &QSlider::valueChanged, this, &MainWindow::seek_playback);
+    playback_layout->addRow(playback_slider_);
+
+    playback_position_label_ = new QLabel("Live");
+    playback_layout->addRow(playback_position_label_);
+
+    playback_speed_combo_ = new QComboBox();
+    for (const double speed : {-16.0, -4.0, -1.0, 0.25, 1.0, 4.0, 16.0, 64.0, 256.0}) {
+        playback_speed_combo_->addItem(QString("%1x").arg(speed), speed);
+    }
+    playback_speed_combo_->setCurrentIndex(playback_speed_combo_->findData(1.0));
+    connect(playback_speed_combo_, QOverload<int>::of(&QComboBox::currentIndexChanged), [this](int index) {
+        playback_speed_ = playback_speed_combo_->itemData(index).toDouble();
+    });
+    playback_layout->addRow("Speed:", playback_speed_combo_);
+
+    auto* playback_buttons = new QWidget();
+    auto* playback_buttons_layout = new QHBoxLayout(playback_buttons);
+    playback_buttons_layout->setContentsMargins(0, 0, 0, 0);
+
+    playback_play_btn_ = new QPushButton("Play");
+    playback_play_btn_->setCheckable(true);
+    connect(playback_play_btn_, &QPushButton::toggled, this, &MainWindow::set_playback_playing);
+    playback_buttons_layout->addWidget(playback_play_btn_);
+
+    playback_live_btn_ = new QPushButton("Live");
+    connect(playback_live_btn_, &QPushButton::clicked, this, &MainWindow::return_to_live);
+    playback_buttons_layout->addWidget(playback_live_btn_);
+
+    playback_layout->addRow(playback_buttons);
+
+    set_playback_controls_enabled(false);
+
+    sidebar_layout->addWidget(playback_group);
+
+    // Traces Group
+    auto* traces_group = new QGroupBox("Traces");
+    auto* traces_layout = new QFormLayout(traces_group);
+
+    auto* trace_checks = new QWidget();
+    auto* trace_checks_layout = new QHBoxLayout(trace_checks);
+    trace_checks_layout->setContentsMargins(0, 0, 0, 0);
+    const std::array<const char*, TRACE_KIND_COUNT> trace_labels = {"Max", "Min", "Average"};
+    for (size_t i = 0; i < TRACE_KIND_COUNT; ++i) {
+        trace_checks_[i] = new QCheckBox(trace_labels[i]);
+        connect(trace_checks_[i], &QCheckBox::toggled, this, &MainWindow::apply_trace_settings);
+        trace_checks_layout->addWidget(trace_checks_[i]);
+    }
+    traces_layout->addRow(trace_checks);
+
+    // How fast max/min hold let go of a value, per sweep of that bin
+    trace_decay_spin_ = new QDoubleSpinBox();
+    trace_decay_spin_->setRange(0.0, 10.0);
+    trace_decay_spin_->setSingleStep(0.1);
+    trace_decay_spin_->setValue(TRACE_DEFAULT_DECAY_DB);
+    trace_decay_spin_->setSpecialValueText("Hold");
+    trace_decay_spin_->setSuffix(" dB/sweep");
+    connect(trace_decay_spin_, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            this, &MainWindow::apply_trace_settings);
+    traces_layout->addRow("Decay:", trace_decay_spin_);
+
+    trace_average_spin_ = new QSpinBox();
+    trace_average_spin_->setRange(1, 1000);
+    trace_average_spin_->setValue(static_cast<int>(TRACE_DEFAULT_AVERAGE_COUNT));
+    trace_average_spin_->setSuffix(" sweeps");
+    connect(trace_average_spin_, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &MainWindow::apply_trace_settings);
+    traces_layout->addRow("Average:", trace_average_spin_);
+
+    auto* reset_traces_btn = new QPushButton("Reset Traces");
+    connect(reset_traces_btn, &QPushButton::clicked, this, &MainWindow::reset_traces);
+    traces_layout->addRow(reset_traces_btn);
+
+    sidebar_layout->addWidget(traces_group);
+
+    // Channel Power Group
+    auto* channel_group = new QGroupBox("Channel Power");
+    auto* channel_layout = new QVBoxLayout(channel_group);
+
+    auto* channel_plan_row = new QHBoxLayout();
+    channel_plan_combo_ = new QComboBox();
+    channel_plan_combo_->addItem("None");
+    for (const ChannelPlanPreset& preset : CHANNEL_PLAN_PRESETS) {
+        channel_plan_combo_->addItem(preset.label);
+    }
+    connect(channel_plan_combo_, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::configure_channel_power);
+    channel_plan_row->addWidget(channel_plan_combo_, 1);
+
+    auto* load_plan_btn = new QPushButton("Load...");
+    connect(load_plan_btn, &QPushButton::clicked, this, &MainWindow::load_channel_plan_file);
+    channel_plan_row->addWidget(load_plan_btn);
+    channel_layout->addLayout(channel_plan_row);
+
+    channel_model_ = new ChannelPowerModel(&channel_power_, this);
+    channel_table_ = new QTableView();
+    channel_table_->setModel(channel_model_);
+    channel_table_->setSelectionBehavior(QAbstractItemView::SelectRows);
+    channel_table_->setSelectionMode(QAbstractItemView::SingleSelection);
+    channel_table_->verticalHeader()->setVisible(false);
+    channel_table_->verticalHeader()->setDefaultSectionSize(channel_table_->fontMetrics().height() + 4);
+    channel_table_->horizontalHeader()->setSectionResizeMode(ChannelPowerModel::ChannelColumn, QHeaderView::Stretch);
+    connect(channel_table_->selectionModel(), &QItemSelectionModel::currentRowChanged,
+            this, &MainWindow::refresh_channel_power);
+    channel_layout->addWidget(channel_table_);
+
+    // Time series of the selected channel, newest sweep at 0 s
+    channel_plot_ = new QwtPlot();
+    channel_plot_->setMinimumHeight(140);
+    channel_plot_->setAxisTitle(QwtPlot::xBottom, "s");
+    channel_plot_->setAxisTitle(QwtPlot::yLeft, "dB");
+    channel_curve_ = new QwtPlotCurve();
+    channel_curve_->attach(channel_plot_);
+    channel_layout->addWidget(channel_plot_);
+
+    sidebar_layout->addWidget(channel_group);
+
+    // Display Group
+    auto* display_group = new QGroupBox("Display");
+    auto* display_layout = new QFormLayout(display_group);
+
+    auto* waterfall_mode_combo = new QComboBox();
+    waterfall_mode_combo->addItem("Image (fast)", static_cast<int>(WaterfallMode::Image));
+    waterfall_mode_combo->addItem("Raster", static_cast<int>(WaterfallMode::Raster));
+    connect(waterfall_mode_combo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            [this, waterfall_mode_combo](int index) {
+                set_waterfall_mode(static_cast<WaterfallMode>(waterfall_mode_combo->itemData(index).toInt()));
+            });
+    display_layout->addRow("Waterfall:", waterfall_mode_combo);
+
+    auto* history_combo = new QComboBox();
+    history_combo->addItem("Live", qlonglong{0});
+    history_combo->addItem("Last minute", qlonglong{60});
+    history_combo->addItem("Last 10 minutes", qlonglong{600});
+    history_combo->addItem("Last hour", qlonglong{3600});
+    history_combo->addItem("Last 6 hours", qlonglong{6 * 3600});
+    history_combo->addItem("Last 24 hours", qlonglong{24 * 3600});
+    connect(history_combo, QOverload<int>::of(&QComboBox::currentIndexChanged), [this, history_combo](int index) {
+        set_history_span(history_combo->itemData(index).toLongLong() * 1'000'000);
+    });
+    display_layout->addRow("History:", history_combo);
+
+    history_label_ = new QLabel();
+    display_layout->addRow(history_label_);
+
+    auto* fps_spin = new QSpinBox();
+    fps_spin->setRange(0, 240);
+    fps_spin->setValue(DEFAULT_TARGET_FPS);
+    fps_spin->setSpecialValueText("Display refresh");
+    fps_spin->setSuffix(" FPS");
+    connect(fps_spin, QOverload<int>::of(&QSpinBox::valueChanged), [this](int fps) {
+        render_scheduler_->set_target_fps(fps);
+    });
+    display_layout->addRow("Target rate:", fps_spin);
+
+    auto_scale_check_ = new QCheckBox("Auto colour scale");
+    connect(auto_scale_check_, &QCheckBox::toggled, [this](bool enabled) {
+        if (enabled) {
+            auto_scale_clock_.invalidate();  // Rescale on the next frame
+        } else {
+            set_waterfall_z_interval(QwtInterval(WATERFALL_Z_MIN_DB, WATERFALL_Z_MAX_DB));
+        }
+    });
+    display_layout->addRow(auto_scale_check_);
+
+    auto* metrics_row = new QHBoxLayout();
+    metrics_check_ = new QCheckBox("Pipeline metrics");
+    connect(metrics_check_, &QCheckBox::toggled, [this](bool enabled) {
+        metrics_.set_enabled(enabled);
+        metrics_overlay_snapshot_ = metrics_.snapshot();
+        metrics_overlay_clock_.start();
+        metrics_overlay_->setText("Collecting...");
+        metrics_overlay_->adjustSize();
+        metrics_overlay_->setVisible(enabled);
+    });
+    metrics_row->addWidget(metrics_check_, 1);
+
+    auto* save_metrics_btn = new QPushButton("Save...");
+    connect(save_metrics_btn, &QPushButton::clicked, this, &MainWindow::save_pipeline_metrics);
+    metrics_row->addWidget(save_metrics_btn);
+    display_layout->addRow(metrics_row);
+
+    // Checked at startup when tracing was asked for on the command line
+    trace_btn_ = new QPushButton("Capture trace");
+    trace_btn_->setCheckable(true);
+    trace_btn_->setChecked(pipeline_trace_enabled());
+    connect(trace_btn_, &QPushButton::toggled, this, &MainWindow::capture_trace);
+    display_layout->addRow(trace_btn_);
+
+    sidebar_layout->addWidget(display_group);
+
     sidebar_layout->addStretch();
 }
 
 void MainWindow::refresh_range_list() {
     range_list_->clear();
 
-    const auto ranges = controller_->get_scan_ranges();
-    for (const auto& range : ranges) {
+    for (const auto& range : scan_ranges_) {
         QString item_text = QString("%1 - %2 MHz")
                                 .arg(range.start_mhz)
                                 .arg(range.end_mhz);
@@ -224,15 +595,9 @@ void MainWindow::add_scan_range() {
         return;
     }
 
-    auto ranges = controller_->get_scan_ranges();
-    ranges.push_back({start, end});
-
-    if (controller_->set_scan_ranges(ranges)) {
-        refresh_range_list();
-    } else {
-        QMessageBox::warning(this, "Error",
-                             "Failed to add scan range. Check frequency limits (1-6000 MHz).");
-    }
+    scan_ranges_.push_back({start, end});
+    commands_->set_scan_ranges(scan_ranges_);
+    refresh_range_list();
 }
 
 void MainWindow::remove_selected_range() {
@@ -242,61 +607,756 @@ void MainWindow::remove_selected_range() {
         return;
     }
 
-    auto ranges = controller_->get_scan_ranges();
-    if (ranges.size() <= 1) {
+    if (scan_ranges_.size() <= 1) {
         QMessageBox::warning(this, "Cannot Remove", "At least one scan range is required.");
         return;
     }
 
-    ranges.erase(ranges.begin() + row);
+    scan_ranges_.erase(scan_ranges_.begin() + row);
+    commands_->set_scan_ranges(scan_ranges_);
+    refresh_range_list();
+}
+
+// The displays follow the new ranges as their first blocks arrive, keeping
+// the history of frequencies that stay in the scan
+void MainWindow::apply_scan_ranges() {
+    if (source_->applies_scan_ranges_live()) {
+        statusBar()->showMessage("Scan ranges applied");
+        return;
+    }
+
+    commands_->restart_sweep();
+    statusBar()->showMessage("Applying scan ranges, the sweep will restart");
+}
 
-    if (controller_->set_scan_ranges(ranges)) {
-        refresh_range_list();
+void MainWindow::handle_command_result(const DeviceCommandResult& result) {
+    switch (result.kind) {
+        case DeviceCommandKind::Connect:
+            statusBar()->showMessage(result.ok ? "HackRF connected" : "HackRF connection failed");
+            break;
+        case DeviceCommandKind::RestartSweep:
+            statusBar()->showMessage(result.ok ? "Scan ranges applied" : "Sweep restart failed");
+            break;
+        case DeviceCommandKind::SetScanRanges:
+            if (!result.ok) {
+                // Fall back to whatever the source kept
+                scan_ranges_ = result.scan_ranges;
+                refresh_range_list();
+                QMessageBox::warning(this, "Error",
+                                     "Failed to set scan ranges. Check frequency limits (1-6000 MHz).");
+            }
+            break;
+        default:
+            break;
     }
 }
 
-void MainWindow::apply_scan_ranges() {
-    dataset_spectrum_ = DatasetSpectrum();
+void MainWindow::toggle_recording(bool record) {
+    if (!record) {
+        recorder_.stop();
+        record_encoding_combo_->setEnabled(true);
+        record_step_spin_->setEnabled(true);
+        update_record_stats();
+        return;
+    }
+
+    const QString path = QFileDialog::getSaveFileName(this, "Record Sweeps", QString(),
+                                                      "Sweep recordings (*.hrfsweep)");
+    const auto encoding = static_cast<sweep_record::PowerEncoding>(record_encoding_combo_->currentData().toInt());
+
+    const auto step_db = static_cast<float>(record_step_spin_->value());
 
-    controller_->restart_sweep();
+    if (path.isEmpty() || !recorder_.start(path.toStdString(), encoding, step_db)) {
+        const QSignalBlocker blocker(record_btn_);
+        record_btn_->setChecked(false);
+        return;
+    }
 
-    QMessageBox::information(this, "Ranges Applied", "Scan ranges have been applied. The sweep will restart.");
+    record_encoding_combo_->setEnabled(false);
+    record_step_spin_->setEnabled(false);
+    update_record_stats();
+}
+
+void MainWindow::update_record_stats() {
+    const SweepRecorderStats stats = recorder_.stats();
+    record_stats_label_->setText(QString("%1%2 blocks, %3 MB (%4x), %5 dropped")
+                                     .arg(recorder_.is_recording() ? "Recording: " : "Stopped: ")
+                                     .arg(stats.blocks)
+                                     .arg(static_cast<double>(stats.bytes) / 1e6, 0, 'f', 1)
+                                     .arg(stats.compression_ratio(), 0, 'f', 1)
+                                     .arg(stats.dropped));
 }
 
 void MainWindow::update_plot(const FFTSweepData& data) {
-    if (!dataset_spectrum_.is_initialized()) {
-        dataset_spectrum_ = DatasetSpectrum(data.bin_width_hz, data.freq_ranges_mhz);
+    PIPELINE_TRACE_SCOPE("assemble block");
+    const PipelineTimer timer(metrics_, PipelineTiming::Assembly);
+    metrics_.record(PipelineTiming::QueueWait, data.capture_ns, timer.start_ns());
+    metrics_.count(PipelineCounter::BlocksAssembled);
+    frame_capture_ns_ = data.capture_ns;
 
-        custom_plot_->setAxisScale(QwtPlot::xBottom, data.freq_ranges_mhz.front(), data.freq_ranges_mhz.back());
+    const SweepConfig& config = *data.config;
 
-        raster_data_ = new WaterfallRasterData(
-            COLOR_MAP_SAMPLES,
-            dataset_spectrum_.get_total_num_datapoints(),
-            data.bin_width_hz,
-            -90);
+    ensure_dataset(config);
 
-        raster_data_->setInterval(Qt::ZAxis, QwtInterval(-90, -25));
-        color_plot_->setAxisScale(QwtPlot::xBottom, 0, dataset_spectrum_.get_total_num_datapoints());
+    dataset_spectrum_.add_new_data(data.band_lower.start_hz, data.band_lower.end_hz, data.band_lower.power_db);
+    dataset_spectrum_.add_new_data(data.band_upper.start_hz, data.band_upper.end_hz, data.band_upper.power_db);
 
-        color_map_->setData(raster_data_);
+    complete_sweep_if_started(config, data.band_lower.start_hz, data.timestamp_us);
+}
+
+void MainWindow::open_recording() {
+    const QString path = QFileDialog::getOpenFileName(this, "Open Recording", QString(),
+                                                      "Sweep recordings (*.hrfsweep);;All files (*)");
+    if (path.isEmpty()) {
+        return;
     }
 
-    dataset_spectrum_.add_new_data(data.band_lower.start_hz, data.band_lower.end_hz, data.band_lower.power_db);
-    dataset_spectrum_.add_new_data(data.band_upper.start_hz, data.band_upper.end_hz, data.band_upper.power_db);
+    if (!playback_.open(path.toStdString())) {
+        QMessageBox::warning(this, "Playback", "Failed to open the recording.");
+        return;
+    }
+
+    playback_config_.reset();
+    playback_position_us_ = playback_.first_timestamp_us();
+    dataset_spectrum_ = DatasetSpectrum();
+    frame_peak_valid_ = false;
+    if (history_span_us_ > 0) {
+        show_history();
+    }
+
+    set_playback_controls_enabled(true);
+
+    update_playback_position();
+    playback_play_btn_->setChecked(true);
+}
+
+void MainWindow::return_to_live() {
+    playback_play_btn_->setChecked(false);
+    playback_.close();
+    playback_config_.reset();
+
+    dataset_spectrum_ = DatasetSpectrum();
+    frame_peak_valid_ = false;
 
+    set_playback_controls_enabled(false);
+    playback_position_label_->setText("Live");
+}
+
+void MainWindow::set_playback_controls_enabled(bool enabled) {
+    playback_slider_->setEnabled(enabled);
+    playback_speed_combo_->setEnabled(enabled);
+    playback_play_btn_->setEnabled(enabled);
+    playback_live_btn_->setEnabled(enabled);
+}
+
+void MainWindow::set_playback_playing(bool playing) {
+    playback_play_btn_->setText(playing ? "Pause" : "Play");
+    if (playing && playback_.is_open()) {
+        playback_clock_.start();
+        playback_timer_->start(PLAYBACK_TICK_MS);
+    } else {
+        playback_timer_->stop();
+    }
+}
+
+void MainWindow::seek_playback(int slider_value) {
+    if (!playback_.is_open()) {
+        return;
+    }
+
+    const double span_us = static_cast<double>(playback_.last_timestamp_us() - playback_.first_timestamp_us());
+    playback_position_us_ = playback_.first_timestamp_us() +
+                            static_cast<int64_t>(span_us * slider_value / PLAYBACK_SLIDER_STEPS);
+    playback_.seek(playback_position_us_);
+    update_playback_position();
+}
+
+void MainWindow::advance_playback() {
+    const bool forward = playback_speed_ > 0.0;
+    const int64_t target_us = playback_position_us_ +
+                              static_cast<int64_t>(static_cast<double>(playback_clock_.restart()) * 1000.0 *
+                                                   playback_speed_);
+
+    PlaybackBand band;
+    size_t bands = 0;
+    bool at_end = false;
+
+    while (bands < PLAYBACK_MAX_BANDS_PER_TICK) {
+        if (!(forward ? playback_.next(band) : playback_.previous(band))) {
+            at_end = true;
+            break;
+        }
+
+        if (!playback_.config()) {
+            continue;  // Bands written before any config record
+        }
+
+        // A new config (e.g. different scan ranges) needs a fresh dataset
+        const SweepConfig& config = *playback_.config();
+        if (playback_.config() != playback_config_) {
+            playback_config_ = playback_.config();
+            dataset_spectrum_ = DatasetSpectrum();
+            frame_peak_valid_ = false;
+        }
+
+        ensure_dataset(config);
+        dataset_spectrum_.add_new_data(band.start_hz, band.end_hz, band.power_db);
+        if (!band.upper) {
+            complete_sweep_if_started(config, band.start_hz, band.timestamp_us);
+        }
+
+        ++bands;
+        if (forward ? band.timestamp_us >= target_us : band.timestamp_us <= target_us) {
+            break;
+        }
+    }
+
+    // Fell behind the requested speed: continue from where we got to
+    playback_position_us_ = bands == PLAYBACK_MAX_BANDS_PER_TICK ? band.timestamp_us : target_us;
+    playback_position_us_ = std::clamp(playback_position_us_, playback_.first_timestamp_us(),
+                                       playback_.last_timestamp_us());
+    update_playback_position();
+
+    if (at_end) {
+        playback_play_btn_->setChecked(false);
+    }
+}
+
+void MainWindow::update_playback_position() {
+    const int64_t span_us = playback_.last_timestamp_us() - playback_.first_timestamp_us();
+    if (span_us > 0) {
+        const QSignalBlocker blocker(playback_slider_);
+        playback_slider_->setValue(static_cast<int>(
+            static_cast<double>(playback_position_us_ - playback_.first_timestamp_us()) * PLAYBACK_SLIDER_STEPS /
+            static_cast<double>(span_us)));
+    }
+
+    playback_position_label_->setText(
+        QString("%1, %2 blocks dropped")
+            .arg(QDateTime::fromMSecsSinceEpoch(playback_position_us_ / 1000).toString("yyyy-MM-dd hh:mm:ss.zzz"))
+            .arg(playback_.dropped_blocks()));
+}
+
+void MainWindow::ensure_dataset(const SweepConfig& config) {
+    if (dataset_spectrum_.has_config(config.bin_width_hz, config.freq_ranges_mhz)) {
+        return;
+    }
+
+    if (dataset_spectrum_.is_initialized() &&
+        dataset_spectrum_.get_layout().bin_width_hz() == config.bin_width_hz) {
+        reconfigure_dataset(config);
+        return;
+    }
+
+    dataset_spectrum_ = DatasetSpectrum(config.bin_width_hz, config.freq_ranges_mhz);
+    dataset_spectrum_.enable_statistics();
+    apply_trace_settings();
+    configure_channel_power();
+    follow_live_layout();
+
+    custom_plot_->setAxisScale(QwtPlot::xBottom, 0, dataset_spectrum_.get_total_num_datapoints());
+    update_range_breaks();
+
+    reset_waterfall();
+}
+
+void MainWindow::reconfigure_dataset(const SweepConfig& config) {
+    const std::vector<BinRun> runs = dataset_spectrum_.reconfigure(config.freq_ranges_mhz);
+    configure_channel_power();
+
+    const int cols = dataset_spectrum_.get_total_num_datapoints();
+    custom_plot_->setAxisScale(QwtPlot::xBottom, 0, cols);
+    update_range_breaks();
+
+    follow_live_layout();
+    if (waterfall_image_) {
+        waterfall_image_->remap(runs, cols);
+    } else if (raster_data_) {
+        raster_data_->remap(runs, cols);
+    }
+    color_plot_->setAxisScale(QwtPlot::xBottom, 0, cols);
+    frame_peak_valid_ = false;
+}
+
+// The history holds live sweeps only. It follows the live layout, carrying
+// the columns the old and new layouts share, and a recording's layout
+// never touches it.
+void MainWindow::follow_live_layout() {
+    if (playback_.is_open()) {
+        return;
+    }
+
+    const SpectrumLayout& layout = dataset_spectrum_.get_layout();
+    if (same_layout(history_layout_, layout)) {
+        return;
+    }
+    waterfall_history_.remap(history_layout_.shared_bins(layout), layout.num_bins());
+    history_layout_ = layout;
+}
+
+// One dashed line wherever two neighbouring columns are not neighbours in
+// frequency, i.e. where a gap between scan ranges was left out
+void MainWindow::update_range_breaks() {
+    for (QwtPlotMarker* marker : range_breaks_) {
+        marker->detach();
+        delete marker;
+    }
+    range_breaks_.clear();
+
+    const std::vector<SpectrumSegment>& segments = dataset_spectrum_.get_layout().segments();
+    for (size_t i = 1; i < segments.size(); ++i) {
+        if (segments[i].start_hz == segments[i - 1].end_hz) {
+            continue;
+        }
+
+        for (QwtPlot* plot : {custom_plot_, color_plot_}) {
+            auto* marker = new QwtPlotMarker();
+            marker->setLineStyle(QwtPlotMarker::VLine);
+            marker->setLinePen(Qt::gray, 0, Qt::DashLine);
+            marker->setXValue(static_cast<double>(segments[i].first_bin));
+            marker->setZ(10);
+            marker->attach(plot);
+            range_breaks_.push_back(marker);
+        }
+    }
+
+    // Labels are cached per column value, which now maps to other frequencies
+    custom_plot_->axisScaleDraw(QwtPlot::xBottom)->invalidateCache();
+    color_plot_->axisScaleDraw(QwtPlot::xBottom)->invalidateCache();
+}
+
+void MainWindow::complete_sweep_if_started(const SweepConfig& config, uint64_t band_start_hz, int64_t timestamp_us) {
     constexpr uint64_t MHZ_TO_HZ = 1'000'000ULL;
-    if (data.band_lower.start_hz == data.freq_ranges_mhz.front() * MHZ_TO_HZ) {
-        const QVector<double> freq_vec = dataset_spectrum_.get_frequency_array();
-        const QVector<double> pwr_vec = dataset_spectrum_.get_power_array();
+    if (band_start_hz == config.freq_ranges_mhz.front() * MHZ_TO_HZ) {
+        metrics_.count(PipelineCounter::SweepsCompleted);
+        fold_completed_sweep();
+        if (!playback_.is_open()) {
+            PIPELINE_TRACE_SCOPE("history insert");
+            waterfall_history_.add_row(timestamp_us, dataset_spectrum_.get_spectrum());
+        }
+        channel_power_.update(timestamp_us, dataset_spectrum_.get_spectrum());
+        render_scheduler_->sweep_completed();
+    }
+}
 
-        curve_->setSamples(freq_vec, pwr_vec);
-        custom_plot_->replot();
+void MainWindow::fold_completed_sweep() {
+    const std::span<const float> spectrum = dataset_spectrum_.get_spectrum();
 
-        raster_data_->addRow(dataset_spectrum_.get_spectrum());
+    if (!frame_peak_valid_ || frame_peak_.size() != spectrum.size()) {
+        frame_peak_.assign(spectrum.begin(), spectrum.end());
+        frame_peak_valid_ = true;
+        return;
+    }
+
+    for (size_t i = 0; i < spectrum.size(); ++i) {
+        frame_peak_[i] = std::max(frame_peak_[i], spectrum[i]);
+    }
+}
+
+void MainWindow::render_frame(int sweeps) {
+    if (!dataset_spectrum_.is_initialized() || !frame_peak_valid_) {
+        return;
+    }
+
+    PIPELINE_TRACE_SCOPE("render frame");
+
+    {
+        // One waterfall row per frame holding the peak of every sweep it covers
+        PIPELINE_TRACE_SCOPE("waterfall insert");
+        const PipelineTimer timer(metrics_, PipelineTiming::WaterfallInsert);
+        if (history_span_us_ > 0 && !playback_.is_open()) {
+            if (!history_refresh_clock_.isValid() || history_refresh_clock_.elapsed() >= HISTORY_REFRESH_MS) {
+                show_history();
+            }
+        } else if (waterfall_image_) {
+            waterfall_image_->addRow(dataset_spectrum_.get_layout(), frame_peak_);
+        } else if (raster_data_) {
+            raster_data_->addRow(dataset_spectrum_.get_layout(), frame_peak_);
+        }
+        frame_peak_valid_ = false;
+    }
+
+    {
+        const PipelineTimer timer(metrics_, PipelineTiming::Repaint);
+        refresh_spectrum_curve();
+
+        PIPELINE_TRACE_SCOPE("waterfall replot");
+        color_plot_->replot();
+    }
+    metrics_.record(PipelineTiming::CaptureToScreen, frame_capture_ns_,
+                    metrics_.is_enabled() ? pipeline_now_ns() : 0);
+    metrics_.count(PipelineCounter::FramesRendered);
+
+    render_stats_label_->setText(QString("%1/%2 FPS, %3 sweeps/frame, %4 folded")
+                                     .arg(render_scheduler_->achieved_fps(), 0, 'f', 1)
+                                     .arg(render_scheduler_->target_fps(), 0, 'f', 0)
+                                     .arg(sweeps)
+                                     .arg(render_scheduler_->dropped_frames()));
+
+    if (recorder_.is_recording()) {
+        update_record_stats();
+    }
+
+    refresh_channel_power();
+
+    if (!auto_scale_clock_.isValid() || auto_scale_clock_.elapsed() >= AUTO_SCALE_INTERVAL_MS) {
+        auto_scale_clock_.start();
+        update_noise_floor();
+    }
+
+    if (metrics_.is_enabled() && metrics_overlay_clock_.elapsed() >= METRICS_OVERLAY_INTERVAL_MS) {
+        metrics_overlay_clock_.start();
+        update_metrics_overlay();
+    }
+}
+
+void MainWindow::configure_channel_power() {
+    std::vector<CellularChannel> channels;
+
+    const int plan = channel_plan_combo_->currentIndex();
+    if (plan == CHANNEL_PLAN_FILE) {
+        channels = loaded_channel_plan_;
+    } else if (plan != CHANNEL_PLAN_NONE && dataset_spectrum_.is_initialized()) {
+        // Presets follow the ranges actually being swept
+        std::vector<ScanRange> ranges;
+        for (const SpectrumSegment& segment : dataset_spectrum_.get_layout().segments()) {
+            constexpr uint64_t MHZ_TO_HZ = 1'000'000ULL;
+            ranges.push_back({static_cast<uint16_t>(segment.start_hz / MHZ_TO_HZ),
+                              static_cast<uint16_t>(segment.end_hz / MHZ_TO_HZ)});
+        }
+
+        const ChannelPlanPreset& preset = CHANNEL_PLAN_PRESETS[static_cast<size_t>(plan - 1)];
+        channels = make_band_plan(preset.technology, ranges, preset.bandwidth_hz, preset.bandwidth_hz);
+    }
+
+    channel_power_.configure(dataset_spectrum_.get_layout(), std::move(channels));
+    channel_model_->reload();
+    channel_curve_->setSamples(QVector<double>(), QVector<double>());
+    channel_plot_->replot();
+}
+
+void MainWindow::load_channel_plan_file() {
+    const QString path = QFileDialog::getOpenFileName(this, "Load Channel Plan", QString(),
+                                                      "Channel plans (*.csv *.txt);;All files (*)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    if (!load_channel_plan(path.toStdString(), loaded_channel_plan_)) {
+        QMessageBox::warning(this, "Channel Power", "Failed to load the channel plan.");
+        return;
+    }
+
+    if (channel_plan_combo_->count() <= CHANNEL_PLAN_FILE) {
+        channel_plan_combo_->addItem(QString());
+    }
+    channel_plan_combo_->setItemText(CHANNEL_PLAN_FILE, QFileInfo(path).fileName());
+
+    if (channel_plan_combo_->currentIndex() == CHANNEL_PLAN_FILE) {
+        configure_channel_power();
+    } else {
+        channel_plan_combo_->setCurrentIndex(CHANNEL_PLAN_FILE);
+    }
+}
+
+void MainWindow::refresh_channel_power() {
+    if (channel_power_.channels().empty()) {
+        return;
+    }
+
+    PIPELINE_TRACE_SCOPE("channel power");
+
+    channel_model_->refresh_power();
+
+    const QModelIndex current = channel_table_->currentIndex();
+    if (!current.isValid()) {
+        return;
+    }
+
+    std::vector<int64_t> timestamps_us;
+    std::vector<float> power_db;
+    channel_power_.history(static_cast<size_t>(current.row()), timestamps_us, power_db);
+    if (timestamps_us.empty()) {
+        return;
+    }
+
+    QVector<double> x;
+    QVector<double> y;
+    x.reserve(static_cast<int>(timestamps_us.size()));
+    y.reserve(static_cast<int>(power_db.size()));
+    for (size_t i = 0; i < timestamps_us.size(); ++i) {
+        if (power_db[i] > CHANNEL_NO_DATA_DB) {
+            x.append(static_cast<double>(timestamps_us[i] - timestamps_us.back()) / 1e6);
+            y.append(power_db[i]);
+        }
+    }
+    channel_curve_->setSamples(x, y);
+    channel_plot_->replot();
+}
+
+void MainWindow::update_noise_floor() {
+    PIPELINE_TRACE_SCOPE("noise floor");
+
+    const SpectrumStatistics* statistics = dataset_spectrum_.get_statistics();
+    if (statistics == nullptr) {
+        return;
+    }
+
+    const double floor_db = statistics->noise_floor_db();
+    noise_floor_label_->setText(QString("Noise floor: %1 dB").arg(floor_db, 0, 'f', 1));
+
+    if (!auto_scale_check_->isChecked()) {
+        return;
+    }
+
+    const double min_db = floor_db - AUTO_SCALE_MARGIN_DB;
+    const double max_db = std::max(statistics->percentile_db(AUTO_SCALE_PEAK_PERCENTILE) + AUTO_SCALE_MARGIN_DB,
+                                   min_db + AUTO_SCALE_MIN_SPAN_DB);
+
+    // Small moves would only make the colours shimmer
+    if (std::abs(min_db - waterfall_z_interval_.minValue()) >= AUTO_SCALE_HYSTERESIS_DB ||
+        std::abs(max_db - waterfall_z_interval_.maxValue()) >= AUTO_SCALE_HYSTERESIS_DB) {
+        set_waterfall_z_interval(QwtInterval(min_db, max_db));
+    }
+}
+
+void MainWindow::set_waterfall_z_interval(const QwtInterval& interval) {
+    waterfall_z_interval_ = interval;
+
+    if (waterfall_image_) {
+        waterfall_image_->setZInterval(interval);
+    } else if (raster_data_) {
+        raster_data_->setInterval(Qt::ZAxis, interval);
+    }
+    color_plot_->replot();
+}
+
+void MainWindow::refresh_spectrum_curve() {
+    PIPELINE_TRACE_SCOPE("spectrum replot");
+
+    const QwtInterval visible = custom_plot_->axisInterval(QwtPlot::xBottom);
+    const int pixels = custom_plot_->canvas()->width();
+    spectrum_series_->update_envelope(visible.minValue(), visible.maxValue(), pixels);
+    for (size_t i = 0; i < TRACE_KIND_COUNT; ++i) {
+        if (trace_curves_[i]->isVisible()) {
+            trace_series_[i]->update_envelope(visible.minValue(), visible.maxValue(), pixels);
+        }
+    }
+    custom_plot_->replot();
+}
+
+void MainWindow::apply_trace_settings() {
+    for (size_t i = 0; i < TRACE_KIND_COUNT; ++i) {
+        const auto kind = static_cast<TraceKind>(i);
+        const bool enabled = trace_checks_[i]->isChecked();
+        trace_curves_[i]->setVisible(enabled);
+
+        if (!enabled) {
+            dataset_spectrum_.disable_trace(kind);
+            continue;
+        }
+
+        if (!dataset_spectrum_.is_initialized()) {
+            continue;  // Picked up by ensure_dataset()
+        }
+
+        TraceProcessor& trace = dataset_spectrum_.enable_trace(kind);
+        trace.set_decay_db(static_cast<float>(trace_decay_spin_->value()));
+        trace.set_average_count(static_cast<uint32_t>(trace_average_spin_->value()));
+    }
+
+    if (dataset_spectrum_.is_initialized()) {
+        refresh_spectrum_curve();
+    }
+}
+
+void MainWindow::reset_traces() {
+    dataset_spectrum_.reset_traces();
+    if (dataset_spectrum_.is_initialized()) {
+        refresh_spectrum_curve();
+    }
+}
+
+void MainWindow::reset_waterfall() {
+    const int cols = dataset_spectrum_.get_total_num_datapoints();
+    color_plot_->setAxisScale(QwtPlot::xBottom, 0, cols);
+    frame_peak_valid_ = false;
+
+    // Only the active renderer holds history; the other one is released
+    delete waterfall_image_;
+    waterfall_image_ = nullptr;
+    color_map_->detach();
+    color_map_->setData(nullptr);  // Deletes the previous raster_data_
+    raster_data_ = nullptr;
+
+    if (waterfall_mode_ == WaterfallMode::Image) {
+        waterfall_image_ = new WaterfallImageItem(
+            COLOR_MAP_SAMPLES,
+            cols,
+            waterfall_z_interval_);
+        waterfall_image_->attach(color_plot_);
+        return;
+    }
+
+    raster_data_ = new WaterfallRasterData(
+        COLOR_MAP_SAMPLES,
+        cols,
+        dataset_spectrum_.get_layout().bin_width_hz(),
+        WATERFALL_Z_MIN_DB);
+
+    raster_data_->setInterval(Qt::ZAxis, waterfall_z_interval_);
+
+    color_map_->setData(raster_data_);
+    color_map_->attach(color_plot_);
+}
+
+void MainWindow::set_waterfall_mode(WaterfallMode mode) {
+    if (mode == waterfall_mode_) {
+        return;
+    }
+
+    waterfall_mode_ = mode;
+
+    if (dataset_spectrum_.is_initialized()) {
+        reset_waterfall();
+        if (history_span_us_ > 0) {
+            show_history();
+        }
         color_plot_->replot();
     }
 }
 
+void MainWindow::set_history_span(int64_t span_us) {
+    history_span_us_ = span_us;
+    history_label_->clear();
+
+    if (!dataset_spectrum_.is_initialized()) {
+        return;
+    }
+
+    // Back to live starts an empty waterfall, as after a mode change
+    if (history_span_us_ > 0) {
+        show_history();
+    } else {
+        reset_waterfall();
+    }
+    color_plot_->replot();
+}
+
+// Rebuilds the waterfall from the history: the newest rows of the finest
+// level that fits the span into the waterfall's rows
+void MainWindow::show_history() {
+    if (playback_.is_open()) {
+        history_label_->setText("History holds live sweeps, shown again on return to live");
+        return;
+    }
+
+    PIPELINE_TRACE_SCOPE("history read");
+    history_refresh_clock_.start();
+
+    reset_waterfall();
+
+    const int64_t end_us = waterfall_history_.newest_us();
+    WaterfallHistoryRows rows;
+    if (!waterfall_history_.read(end_us - history_span_us_, end_us, COLOR_MAP_SAMPLES, rows)) {
+        history_label_->setText("No sweeps in this span yet");
+        return;
+    }
+
+    const SpectrumLayout& layout = history_layout_;
+    const size_t cols = waterfall_history_.cols();
+    for (size_t i = 0; i < rows.timestamps_us.size(); ++i) {
+        const std::span<const float> row(rows.power.data() + i * cols, cols);
+        if (waterfall_image_) {
+            waterfall_image_->addRow(layout, row);
+        } else if (raster_data_) {
+            raster_data_->addRow(layout, row);
+        }
+    }
+
+    const auto sweeps_per_row = static_cast<qulonglong>(std::pow(WATERFALL_HISTORY_DECIMATION, rows.level));
+    history_label_->setText(QString("%1 rows, peak of %2 sweeps each, from %3")
+                                .arg(rows.timestamps_us.size())
+                                .arg(sweeps_per_row)
+                                .arg(QDateTime::fromMSecsSinceEpoch(rows.timestamps_us.front() / 1000)
+                                         .toString("hh:mm:ss")));
+}
+
+bool MainWindow::set_history_config(const WaterfallHistoryConfig& config) {
+    return waterfall_history_.configure(config);
+}
+
 void MainWindow::update_total_gain() {
-    total_gain_field_->setText(QString::number(controller_->get_gain_state().total_gain()) + " dB");
+    total_gain_field_->setText(QString::number(gain_state_.total_gain()) + " dB");
+}
+
+void MainWindow::set_metrics_enabled(bool enabled) {
+    metrics_check_->setChecked(enabled);
+}
+
+const PipelineMetrics& MainWindow::pipeline_metrics() const {
+    return metrics_;
+}
+
+void MainWindow::update_metrics_overlay() {
+    const PipelineSnapshot snapshot = metrics_.snapshot();
+    const PipelineSnapshot& earlier = metrics_overlay_snapshot_;
+
+    auto us = [](uint64_t ns) { return QString::number(static_cast<double>(ns) / 1e3, 'f', 0); };
+    auto timing = [&snapshot, &us](PipelineTiming which) {
+        const LatencySnapshot& latency = snapshot.timing(which);
+        return QString("%1 / %2 / %3 us")
+            .arg(us(latency.percentile_ns(0.5)), us(latency.percentile_ns(0.99)), us(latency.max_ns));
+    };
+
+    metrics_overlay_->setText(
+        QString("%1 blocks/s, %2 sweeps/s, %3 frames/s, %4 dropped\n"
+                "                p50 / p99 / max\n"
+                "queue wait      %5\n"
+                "assembly        %6\n"
+                "waterfall row   %7\n"
+                "repaint         %8\n"
+                "capture->screen %9")
+            .arg(snapshot.rate(PipelineCounter::BlocksReceived, earlier), 0, 'f', 0)
+            .arg(snapshot.rate(PipelineCounter::SweepsCompleted, earlier), 0, 'f', 1)
+            .arg(snapshot.rate(PipelineCounter::FramesRendered, earlier), 0, 'f', 1)
+            .arg(snapshot.counter(PipelineCounter::BlocksDropped))
+            .arg(timing(PipelineTiming::QueueWait), timing(PipelineTiming::Assembly),
+                 timing(PipelineTiming::WaterfallInsert), timing(PipelineTiming::Repaint),
+                 timing(PipelineTiming::CaptureToScreen)));
+    metrics_overlay_->adjustSize();
+
+    metrics_overlay_snapshot_ = snapshot;
+}
+
+void MainWindow::save_pipeline_metrics() {
+    const QString path = QFileDialog::getSaveFileName(this, "Save Pipeline Metrics", "pipeline-metrics.json",
+                                                      "JSON (*.json);;All files (*)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    if (!write_pipeline_metrics_json(metrics_.snapshot(), path.toStdString())) {
+        QMessageBox::warning(this, "Pipeline Metrics", "Failed to write the metrics file.");
+    }
+}
+
+void MainWindow::capture_trace(bool capture) {
+    if (capture) {
+        pipeline_trace_set_thread_name("GUI");
+        pipeline_trace_start();
+        return;
+    }
+
+    pipeline_trace_stop();
+
+    const QString path = QFileDialog::getSaveFileName(this, "Save Trace", "pipeline-trace.json",
+                                                      "Chrome trace (*.json);;All files (*)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    if (!pipeline_trace_write_json(path.toStdString())) {
+        QMessageBox::warning(this, "Trace", "Failed to write the trace file.");
+    }
 }
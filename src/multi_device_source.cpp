@@ -0,0 +1,349 @@
+#include "multi_device_source.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "hackrf_gain_state.hpp"
+#include "pipeline_trace.hpp"
+#include "sweep_partition.hpp"
+
+MultiDeviceSource::MultiDeviceSource(std::vector<std::unique_ptr<SpectrumSource>> devices) {
+    devices_.reserve(devices.size());
+    for (std::unique_ptr<SpectrumSource>& source : devices) {
+        auto device = std::make_unique<Device>();
+        device->queue = std::make_unique<SweepQueue>(MULTI_DEVICE_QUEUE_CAPACITY, OverflowPolicy::DropOldest);
+        device->source = std::move(source);
+
+        // Each device delivers on its own thread, the single producer of its queue
+        device->source->set_fft_callback([queue = device->queue.get()](const FFTSweepData& data) { queue->push(data); });
+        devices_.push_back(std::move(device));
+    }
+
+    running_.store(true);
+    thread_ = std::thread(&MultiDeviceSource::run_merge, this);
+}
+
+MultiDeviceSource::~MultiDeviceSource() {
+    for (const std::unique_ptr<Device>& device : devices_) {
+        device->source->stop_sweep();
+        device->source->set_fft_callback(nullptr);
+    }
+
+    running_.store(false);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+size_t MultiDeviceSource::device_count() const noexcept {
+    return devices_.size();
+}
+
+SpectrumSource& MultiDeviceSource::device(size_t index) const {
+    return *devices_[index]->source;
+}
+
+std::vector<ScanRange> MultiDeviceSource::device_scan_ranges(size_t index) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return devices_[index]->ranges;
+}
+
+bool MultiDeviceSource::is_active(size_t index) const {
+    // Before any ranges are set every device is considered in use
+    return scan_ranges_.empty() || !devices_[index]->ranges.empty();
+}
+
+bool MultiDeviceSource::is_connected() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    bool connected = false;
+    for (size_t i = 0; i < devices_.size(); ++i) {
+        if (!is_active(i)) {
+            continue;
+        }
+        if (!devices_[i]->source->is_connected()) {
+            return false;
+        }
+        connected = true;
+    }
+    return connected;
+}
+
+bool MultiDeviceSource::connect_device() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::vector<bool> active(devices_.size());
+    for (size_t i = 0; i < devices_.size(); ++i) {
+        active[i] = is_active(i);
+    }
+    lock.unlock();
+
+    for (size_t i = 0; i < devices_.size(); ++i) {
+        if (active[i]) {
+            devices_[i]->source->connect_device();
+            devices_[i]->sweeping.store(false);
+        }
+    }
+
+    return is_connected();
+}
+
+void MultiDeviceSource::start_sweep() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::vector<bool> active(devices_.size());
+    for (size_t i = 0; i < devices_.size(); ++i) {
+        active[i] = is_active(i);
+    }
+    lock.unlock();
+
+    for (size_t i = 0; i < devices_.size(); ++i) {
+        Device& device = *devices_[i];
+        if (!active[i]) {
+            continue;
+        }
+        if (!device.source->is_connected() && !device.source->connect_device()) {
+            continue;
+        }
+        device.source->start_sweep();
+        device.sweeping.store(true);
+    }
+}
+
+void MultiDeviceSource::stop_sweep() {
+    for (const std::unique_ptr<Device>& device : devices_) {
+        device->source->stop_sweep();
+        device->sweeping.store(false);
+    }
+
+    // With no device sweeping the merge no longer waits, so this is brief
+    auto pending = [this]() {
+        size_t blocks = held_blocks_.load();
+        for (const std::unique_ptr<Device>& device : devices_) {
+            blocks += device->queue->size();
+        }
+        // Checked last: set before the merge pops a block off a queue
+        return blocks + (merging_.load() ? 1 : 0);
+    };
+    while (running_.load() && pending() > 0) {
+        std::this_thread::sleep_for(MULTI_DEVICE_IDLE_SLEEP);
+    }
+}
+
+void MultiDeviceSource::restart_sweep() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::vector<bool> active(devices_.size());
+    for (size_t i = 0; i < devices_.size(); ++i) {
+        active[i] = is_active(i);
+    }
+    lock.unlock();
+
+    for (size_t i = 0; i < devices_.size(); ++i) {
+        Device& device = *devices_[i];
+        if (!active[i]) {
+            // Left without ranges by the last repartition
+            if (device.sweeping.exchange(false)) {
+                device.source->stop_sweep();
+            }
+            continue;
+        }
+
+        if (!device.source->is_connected()) {
+            if (!device.source->connect_device()) {
+                continue;
+            }
+            device.source->start_sweep();
+        } else {
+            device.source->restart_sweep();
+        }
+        device.sweeping.store(true);
+    }
+}
+
+void MultiDeviceSource::set_gain_state(const HackRFGainState& state) {
+    for (const std::unique_ptr<Device>& device : devices_) {
+        device->source->set_gain_state(state);
+    }
+}
+
+HackRFGainState MultiDeviceSource::get_gain_state() const {
+    return devices_.empty() ? HackRFGainState() : devices_.front()->source->get_gain_state();
+}
+
+void MultiDeviceSource::set_amp_enable(bool enable) noexcept {
+    for (const std::unique_ptr<Device>& device : devices_) {
+        device->source->set_amp_enable(enable);
+    }
+}
+
+void MultiDeviceSource::set_vga_gain(int gain) {
+    for (const std::unique_ptr<Device>& device : devices_) {
+        device->source->set_vga_gain(gain);
+    }
+}
+
+void MultiDeviceSource::set_lna_gain(int gain) {
+    for (const std::unique_ptr<Device>& device : devices_) {
+        device->source->set_lna_gain(gain);
+    }
+}
+
+void MultiDeviceSource::set_fft_callback(FFTCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fft_callback_ = std::move(callback);
+    fft_callback_generation_.fetch_add(1, std::memory_order_release);
+}
+
+bool MultiDeviceSource::set_scan_ranges(const std::vector<ScanRange>& ranges) {
+    if (ranges.empty()) {
+        std::cerr << "At least one scan range is required\n";
+        return false;
+    }
+
+    const std::vector<std::vector<ScanRange>> partitions = partition_scan_ranges(ranges, devices_.size());
+    for (size_t i = 0; i < devices_.size(); ++i) {
+        if (!partitions[i].empty() && !devices_[i]->source->set_scan_ranges(partitions[i])) {
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    scan_ranges_ = ranges;
+    for (size_t i = 0; i < devices_.size(); ++i) {
+        devices_[i]->ranges = partitions[i];
+    }
+    return true;
+}
+
+std::vector<ScanRange> MultiDeviceSource::get_scan_ranges() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return scan_ranges_;
+}
+
+void MultiDeviceSource::run_merge() {
+    pipeline_trace_set_thread_name("multi-device merge");
+
+    while (running_.load(std::memory_order_relaxed)) {
+        const int64_t now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                   std::chrono::system_clock::now().time_since_epoch())
+                                   .count();
+        merging_.store(true);
+        const bool merged = merge_next(now_us);
+        merging_.store(false);
+
+        if (!merged) {
+            std::this_thread::sleep_for(MULTI_DEVICE_IDLE_SLEEP);
+        }
+    }
+}
+
+bool MultiDeviceSource::merge_next(int64_t now_us) {
+    Device* oldest = nullptr;
+    bool all_present = true;
+
+    for (const std::unique_ptr<Device>& device : devices_) {
+        if (!device->has_head) {
+            device->has_head = device->queue->drain([&device](const FFTSweepData& data) { device->head = data; }, 1) == 1;
+            if (device->has_head) {
+                held_blocks_.fetch_add(1);
+                if (device->head.config != device->config) {
+                    device->config = device->head.config;
+                    merged_config_stale_ = true;
+                }
+            }
+        }
+
+        if (!device->has_head) {
+            // Only a device that is sweeping can still deliver an older block
+            all_present = all_present && !device->sweeping.load();
+            continue;
+        }
+        if (oldest == nullptr || device->head.timestamp_us < oldest->head.timestamp_us) {
+            oldest = device.get();
+        }
+    }
+
+    if (oldest == nullptr || (!all_present && now_us - oldest->head.timestamp_us < MULTI_DEVICE_REORDER_US)) {
+        return false;
+    }
+
+    if (merged_config_stale_) {
+        refresh_merged_config();
+    }
+
+    if (fft_callback_generation_.load(std::memory_order_acquire) != merge_callback_generation_) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        merge_callback_ = fft_callback_;
+        merge_callback_generation_ = fft_callback_generation_.load(std::memory_order_relaxed);
+    }
+
+    if (merge_callback_) {
+        if (merged_config_) {
+            oldest->head.config = merged_config_;
+        }
+        PIPELINE_TRACE_SCOPE("merge block");
+        merge_callback_(oldest->head);
+    }
+
+    oldest->has_head = false;
+    held_blocks_.fetch_sub(1);
+    return true;
+}
+
+void MultiDeviceSource::refresh_merged_config() {
+    merged_config_stale_ = false;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::vector<bool> active(devices_.size());
+    for (size_t i = 0; i < devices_.size(); ++i) {
+        active[i] = is_active(i);
+    }
+    lock.unlock();
+
+    std::vector<ScanRange> ranges;
+    const SweepConfig* first = nullptr;
+    for (size_t i = 0; i < devices_.size(); ++i) {
+        const std::shared_ptr<const SweepConfig>& config = devices_[i]->config;
+        if (!active[i] || !config) {
+            continue;
+        }
+        if (first == nullptr) {
+            first = config.get();
+        }
+        for (size_t r = 0; r + 1 < config->freq_ranges_mhz.size(); r += 2) {
+            ranges.push_back({config->freq_ranges_mhz[r], config->freq_ranges_mhz[r + 1]});
+        }
+    }
+
+    if (first == nullptr) {
+        merged_config_.reset();
+        return;
+    }
+
+    std::sort(ranges.begin(), ranges.end(),
+              [](const ScanRange& a, const ScanRange& b) { return a.start_mhz < b.start_mhz; });
+
+    auto config = std::make_shared<SweepConfig>();
+    config->generation = ++merged_generation_;
+    config->bin_width_hz = first->bin_width_hz;
+    config->fft_size = first->fft_size;
+
+    // Partitions meet on tuning-step boundaries; join them back up so the
+    // spectrum has no seam where one device hands over to the next
+    for (const ScanRange& range : ranges) {
+        if (!config->freq_ranges_mhz.empty() && range.start_mhz <= config->freq_ranges_mhz.back()) {
+            config->freq_ranges_mhz.back() = std::max(config->freq_ranges_mhz.back(), range.end_mhz);
+        } else {
+            config->freq_ranges_mhz.push_back(range.start_mhz);
+            config->freq_ranges_mhz.push_back(range.end_mhz);
+        }
+    }
+
+    merged_config_ = std::move(config);
+}
@@ -0,0 +1,203 @@
+#include "pipeline_metrics.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+constexpr std::array<const char*, PIPELINE_COUNTER_COUNT> COUNTER_NAMES = {
+    "blocks_received", "blocks_dropped", "blocks_assembled", "sweeps_completed", "frames_rendered"};
+
+constexpr std::array<const char*, PIPELINE_TIMING_COUNT> TIMING_NAMES = {
+    "queue_wait", "assembly", "waterfall_insert", "repaint", "capture_to_screen"};
+
+constexpr std::array<double, 4> JSON_PERCENTILES = {0.5, 0.9, 0.99, 0.999};
+
+void append_format(std::string& out, const char* format, auto... args) {
+    char buffer[128];
+    const int length = std::snprintf(buffer, sizeof(buffer), format, args...);
+    if (length > 0) {
+        out.append(buffer, std::min(static_cast<size_t>(length), sizeof(buffer) - 1));
+    }
+}
+
+}  // namespace
+
+int64_t pipeline_now_ns() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+size_t LatencyHistogram::bucket_index(uint64_t ns) noexcept {
+    if (ns < 4) {
+        return static_cast<size_t>(ns);
+    }
+    const auto exponent = static_cast<size_t>(std::bit_width(ns) - 1);
+    const auto sub = static_cast<size_t>((ns >> (exponent - 2)) & 3);
+    return std::min(4 * (exponent - 1) + sub, LATENCY_BUCKET_COUNT - 1);
+}
+
+uint64_t LatencyHistogram::bucket_upper_ns(size_t index) noexcept {
+    // Smallest value of the next bucket
+    const size_t next = index + 1;
+    if (next < 4) {
+        return next;
+    }
+    const size_t exponent = next / 4 + 1;
+    return (4 + next % 4) << (exponent - 2);
+}
+
+void LatencyHistogram::record(uint64_t ns) noexcept {
+    buckets_[bucket_index(ns)].fetch_add(1, std::memory_order_relaxed);
+    sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t max = max_ns_.load(std::memory_order_relaxed);
+    while (ns > max && !max_ns_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() noexcept {
+    for (std::atomic<uint64_t>& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    sum_ns_.store(0, std::memory_order_relaxed);
+    max_ns_.store(0, std::memory_order_relaxed);
+}
+
+LatencySnapshot LatencyHistogram::snapshot() const noexcept {
+    LatencySnapshot snapshot;
+    for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+        snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.buckets[i];
+    }
+    snapshot.sum_ns = sum_ns_.load(std::memory_order_relaxed);
+    snapshot.max_ns = max_ns_.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+double LatencySnapshot::mean_ns() const noexcept {
+    return count > 0 ? static_cast<double>(sum_ns) / static_cast<double>(count) : 0.0;
+}
+
+uint64_t LatencySnapshot::percentile_ns(double fraction) const noexcept {
+    if (count == 0) {
+        return 0;
+    }
+
+    const auto rank = static_cast<uint64_t>(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(count - 1));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+        seen += buckets[i];
+        if (seen > rank) {
+            return std::min(LatencyHistogram::bucket_upper_ns(i), max_ns);
+        }
+    }
+    return max_ns;
+}
+
+double PipelineSnapshot::rate(PipelineCounter which, const PipelineSnapshot& earlier) const noexcept {
+    const double seconds = static_cast<double>(taken_ns - earlier.taken_ns) / 1e9;
+    const uint64_t now = counter(which);
+    const uint64_t then = earlier.counter(which);
+    return seconds > 0.0 && now >= then ? static_cast<double>(now - then) / seconds : 0.0;
+}
+
+PipelineMetrics::PipelineMetrics() {
+    reset_ns_.store(pipeline_now_ns(), std::memory_order_relaxed);
+}
+
+void PipelineMetrics::set_enabled(bool enabled) noexcept {
+    if (enabled && !is_enabled()) {
+        reset();
+    }
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void PipelineMetrics::reset() noexcept {
+    for (std::atomic<uint64_t>& counter : counters_) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+    for (LatencyHistogram& timing : timings_) {
+        timing.reset();
+    }
+    reset_ns_.store(pipeline_now_ns(), std::memory_order_relaxed);
+}
+
+PipelineSnapshot PipelineMetrics::snapshot() const noexcept {
+    PipelineSnapshot snapshot;
+    snapshot.taken_ns = pipeline_now_ns();
+    snapshot.elapsed_s = static_cast<double>(snapshot.taken_ns - reset_ns_.load(std::memory_order_relaxed)) / 1e9;
+    for (size_t i = 0; i < PIPELINE_COUNTER_COUNT; ++i) {
+        snapshot.counters[i] = counters_[i].load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < PIPELINE_TIMING_COUNT; ++i) {
+        snapshot.timings[i] = timings_[i].snapshot();
+    }
+    return snapshot;
+}
+
+const char* PipelineMetrics::name(PipelineCounter which) noexcept {
+    return COUNTER_NAMES[static_cast<size_t>(which)];
+}
+
+const char* PipelineMetrics::name(PipelineTiming which) noexcept {
+    return TIMING_NAMES[static_cast<size_t>(which)];
+}
+
+std::string pipeline_metrics_json(const PipelineSnapshot& snapshot) {
+    std::string out;
+    append_format(out, "{\n  \"elapsed_s\": %.3f,\n  \"counters\": {", snapshot.elapsed_s);
+
+    for (size_t i = 0; i < PIPELINE_COUNTER_COUNT; ++i) {
+        const double rate = snapshot.elapsed_s > 0.0 ? static_cast<double>(snapshot.counters[i]) / snapshot.elapsed_s
+                                                     : 0.0;
+        append_format(out, "%s\n    \"%s\": {\"total\": %" PRIu64 ", \"per_second\": %.2f}", i == 0 ? "" : ",",
+                      COUNTER_NAMES[i], snapshot.counters[i], rate);
+    }
+    out += "\n  },\n  \"timings_us\": {";
+
+    for (size_t i = 0; i < PIPELINE_TIMING_COUNT; ++i) {
+        const LatencySnapshot& timing = snapshot.timings[i];
+        append_format(out, "%s\n    \"%s\": {\"count\": %" PRIu64 ", \"mean\": %.3f, \"max\": %.3f", i == 0 ? "" : ",",
+                      TIMING_NAMES[i], timing.count, timing.mean_ns() / 1e3, static_cast<double>(timing.max_ns) / 1e3);
+        for (const double fraction : JSON_PERCENTILES) {
+            append_format(out, ", \"p%g\": %.3f", fraction * 100.0,
+                          static_cast<double>(timing.percentile_ns(fraction)) / 1e3);
+        }
+
+        // Non-empty buckets only, as [upper bound in us, count]
+        out += ", \"buckets\": [";
+        bool first = true;
+        for (size_t b = 0; b < LATENCY_BUCKET_COUNT; ++b) {
+            if (timing.buckets[b] == 0) {
+                continue;
+            }
+            append_format(out, "%s[%.3f, %" PRIu64 "]", first ? "" : ", ",
+                          static_cast<double>(LatencyHistogram::bucket_upper_ns(b)) / 1e3, timing.buckets[b]);
+            first = false;
+        }
+        out += "]}";
+    }
+    out += "\n  }\n}\n";
+    return out;
+}
+
+bool write_pipeline_metrics_json(const PipelineSnapshot& snapshot, const std::string& path) {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Failed to open metrics file: " << path << '\n';
+        return false;
+    }
+    file << pipeline_metrics_json(snapshot);
+    return static_cast<bool>(file);
+}
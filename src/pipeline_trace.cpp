@@ -0,0 +1,227 @@
+#include "pipeline_trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace pipeline_trace_detail {
+std::atomic_bool enabled{false};
+}  // namespace pipeline_trace_detail
+
+namespace {
+
+// One span, guarded by a sequence number that is odd while the owning
+// thread rewrites it; the writer of the file skips slots caught mid-write
+struct TraceSlot {
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<const char*> name{nullptr};
+    std::atomic<int64_t> start_ns{0};
+    std::atomic<int64_t> end_ns{0};
+};
+
+struct ThreadBuffer {
+    explicit ThreadBuffer(size_t id) : id(id), slots(PIPELINE_TRACE_EVENTS_PER_THREAD) {}
+
+    const size_t id;
+    const char* name = nullptr;  // Guarded by the registry mutex
+    std::vector<TraceSlot> slots;
+    uint64_t next = 0;  // Owning thread only
+    std::atomic<uint64_t> written{0};
+    std::atomic_bool retired{false};
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    size_t next_id = 1;
+    int64_t start_ns = 0;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+// Hands the buffer back when its thread exits, so it can be released on
+// the next start once its events are no longer wanted
+struct ThreadState {
+    ThreadBuffer* buffer = nullptr;
+    const char* name = nullptr;
+    bool untraced = false;
+
+    ~ThreadState() {
+        if (buffer != nullptr) {
+            buffer->retired.store(true, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ThreadState thread_state;
+
+ThreadBuffer* thread_buffer() {
+    if (thread_state.buffer != nullptr || thread_state.untraced) {
+        return thread_state.buffer;
+    }
+
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    if (reg.buffers.size() >= PIPELINE_TRACE_MAX_THREADS) {
+        thread_state.untraced = true;
+        std::cerr << "Trace thread limit reached; a thread is not traced\n";
+        return nullptr;
+    }
+
+    reg.buffers.push_back(std::make_unique<ThreadBuffer>(reg.next_id++));
+    thread_state.buffer = reg.buffers.back().get();
+    thread_state.buffer->name = thread_state.name;
+    return thread_state.buffer;
+}
+
+void append_format(std::string& out, const char* format, auto... args) {
+    char buffer[256];
+    const int length = std::snprintf(buffer, sizeof(buffer), format, args...);
+    if (length > 0) {
+        out.append(buffer, std::min(static_cast<size_t>(length), sizeof(buffer) - 1));
+    }
+}
+
+// Names are literals chosen in this code base, but keep the JSON valid
+void append_json_string(std::string& out, const char* text) {
+    out += '"';
+    for (const char* c = text; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out += '\\';
+        }
+        out += *c;
+    }
+    out += '"';
+}
+
+}  // namespace
+
+void pipeline_trace_start() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    std::erase_if(reg.buffers, [](const std::unique_ptr<ThreadBuffer>& buffer) {
+        return buffer->retired.load(std::memory_order_acquire);
+    });
+    reg.start_ns = pipeline_now_ns();
+    pipeline_trace_detail::enabled.store(true, std::memory_order_release);
+}
+
+void pipeline_trace_stop() {
+    pipeline_trace_detail::enabled.store(false, std::memory_order_release);
+}
+
+void pipeline_trace_set_thread_name(const char* name) noexcept {
+    if (thread_state.name == name) {
+        return;
+    }
+    thread_state.name = name;
+
+    if (thread_state.buffer != nullptr) {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        thread_state.buffer->name = name;
+    }
+}
+
+void pipeline_trace_record(const char* name, int64_t start_ns, int64_t end_ns) noexcept {
+    ThreadBuffer* buffer = thread_buffer();
+    if (buffer == nullptr) {
+        return;
+    }
+
+    TraceSlot& slot = buffer->slots[buffer->next % buffer->slots.size()];
+    const uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start_ns.store(start_ns, std::memory_order_relaxed);
+    slot.end_ns.store(end_ns, std::memory_order_relaxed);
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+
+    ++buffer->next;
+    buffer->written.store(buffer->next, std::memory_order_relaxed);
+}
+
+bool pipeline_trace_write_json(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        std::cerr << "Failed to open trace file: " << path << '\n';
+        return false;
+    }
+
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    std::string out = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    bool first = true;
+    uint64_t events = 0;
+
+    for (const std::unique_ptr<ThreadBuffer>& buffer : reg.buffers) {
+        append_format(out, "%s{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": %zu, \"args\": {\"name\": ",
+                      first ? "" : ",\n", buffer->id);
+        if (buffer->name != nullptr) {
+            append_json_string(out, buffer->name);
+        } else {
+            append_format(out, "\"thread %zu\"", buffer->id);
+        }
+        out += "}}";
+        first = false;
+
+        const uint64_t written = buffer->written.load(std::memory_order_relaxed);
+        if (written > buffer->slots.size()) {
+            std::cerr << "Trace buffer of thread " << buffer->id << " wrapped; its oldest "
+                      << written - buffer->slots.size() << " spans are lost\n";
+        }
+
+        for (const TraceSlot& slot : buffer->slots) {
+            const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence == 0 || sequence % 2 != 0) {
+                continue;
+            }
+            const char* name = slot.name.load(std::memory_order_relaxed);
+            const int64_t start_ns = slot.start_ns.load(std::memory_order_relaxed);
+            const int64_t end_ns = slot.end_ns.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != sequence || start_ns < reg.start_ns) {
+                continue;
+            }
+
+            out += ",\n{\"ph\": \"X\", \"cat\": \"pipeline\", \"name\": ";
+            append_json_string(out, name);
+            append_format(out, ", \"pid\": 1, \"tid\": %zu, \"ts\": %.3f, \"dur\": %.3f}", buffer->id,
+                          static_cast<double>(start_ns - reg.start_ns) / 1e3,
+                          static_cast<double>(end_ns - start_ns) / 1e3);
+            ++events;
+
+            // Keep memory bounded for long captures with many threads
+            if (out.size() > (1 << 20)) {
+                std::fwrite(out.data(), 1, out.size(), file);
+                out.clear();
+            }
+        }
+    }
+    out += "\n]}\n";
+
+    std::fwrite(out.data(), 1, out.size(), file);
+    const bool ok = std::fclose(file) == 0;
+    if (!ok) {
+        std::cerr << "Failed to write trace file: " << path << '\n';
+        return false;
+    }
+
+    std::cerr << "Wrote " << events << " trace spans to " << path << '\n';
+    return true;
+}
@@ -0,0 +1,427 @@
+#include "recording_playback.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "sweep_record_format.hpp"
+
+using namespace sweep_record;
+
+constexpr size_t NOT_DECODED = static_cast<size_t>(-1);
+
+bool RecordingPlayback::open(const std::string& path) {
+    close();
+
+    if (!file_.open(path)) {
+        return false;
+    }
+
+    const auto* header = reinterpret_cast<const FileHeader*>(file_.data());
+    if (file_.size() < sizeof(FileHeader) || header->magic != FILE_MAGIC || header->version != FORMAT_VERSION) {
+        std::cerr << "Not a sweep recording: " << path << '\n';
+        close();
+        return false;
+    }
+
+    const Footer* footer = nullptr;
+    if (file_.size() >= sizeof(FileHeader) + sizeof(Footer) && file_.size() % RECORD_ALIGNMENT == 0) {
+        footer = reinterpret_cast<const Footer*>(file_.data() + file_.size() - sizeof(Footer));
+    }
+
+    const bool footer_valid = footer && footer->magic == FOOTER_MAGIC &&
+                              footer->index_offset + sizeof(RecordHeader) + sizeof(IndexHeader) +
+                                      footer->index_entries * sizeof(IndexEntry) <=
+                                  file_.size() - sizeof(Footer);
+
+    if (footer_valid) {
+        records_end_ = footer->index_offset;
+        index_ = {reinterpret_cast<const IndexEntry*>(file_.data() + footer->index_offset + sizeof(RecordHeader) +
+                                                      sizeof(IndexHeader)),
+                  footer->index_entries};
+        first_timestamp_us_ = footer->first_timestamp_us;
+        last_timestamp_us_ = footer->last_timestamp_us;
+        dropped_blocks_ = footer->dropped_blocks;
+    } else {
+        // Not closed cleanly: recover the index from what made it to disk
+        std::cerr << "Recording was not closed, recovering its index: " << path << '\n';
+        records_end_ = file_.size();
+        if (!rebuild_index()) {
+            std::cerr << "No sweeps found in recording: " << path << '\n';
+            close();
+            return false;
+        }
+    }
+
+    if (index_.empty()) {
+        std::cerr << "No sweeps found in recording: " << path << '\n';
+        close();
+        return false;
+    }
+
+    seek(first_timestamp_us_);
+    return true;
+}
+
+void RecordingPlayback::close() {
+    file_.close();
+    records_end_ = 0;
+    index_ = {};
+    owned_index_.clear();
+    first_timestamp_us_ = 0;
+    last_timestamp_us_ = 0;
+    dropped_blocks_ = 0;
+    passed_drops_ = 0;
+    cursor_ = 0;
+    reverse_from_ = 0;
+    config_offset_ = 0;
+    config_.reset();
+    reverse_steps_.clear();
+    reverse_samples_.clear();
+    decoder_.reset();
+    decoder_synced_ = true;
+}
+
+const RecordHeader* RecordingPlayback::record_at(uint64_t offset) const {
+    if (offset + sizeof(RecordHeader) > records_end_) {
+        return nullptr;
+    }
+    const auto* header = reinterpret_cast<const RecordHeader*>(file_.data() + offset);
+    if (offset + sizeof(RecordHeader) + header->payload_bytes > records_end_) {
+        return nullptr;  // Truncated by a crash
+    }
+    return header;
+}
+
+// Index record at offset, if it is one whose entries lie within the file
+const IndexHeader* RecordingPlayback::index_header_at(uint64_t offset) const {
+    const RecordHeader* header = record_at(offset);
+    if (!header || static_cast<RecordType>(header->type) != RecordType::Index ||
+        header->payload_bytes < sizeof(IndexHeader)) {
+        return nullptr;
+    }
+
+    const auto* index = reinterpret_cast<const IndexHeader*>(file_.data() + offset + sizeof(RecordHeader));
+    const uint64_t capacity = (header->payload_bytes - sizeof(IndexHeader)) / sizeof(IndexEntry);
+    if (index->magic != INDEX_MAGIC || index->entries > capacity) {
+        return nullptr;
+    }
+    return index;
+}
+
+// Follows the checkpoint chain back from the newest Index record. Returns
+// the newest one, or null when there is none or the chain is broken.
+const IndexHeader* RecordingPlayback::load_checkpoints() {
+    // Records are aligned, so the newest checkpoint starts on an aligned
+    // offset somewhere in the tail written after it
+    uint64_t offset = padded_size(records_end_ - RECORD_ALIGNMENT + 1) - RECORD_ALIGNMENT;
+    const IndexHeader* newest = nullptr;
+    for (; offset >= sizeof(FileHeader); offset -= RECORD_ALIGNMENT) {
+        newest = index_header_at(offset);
+        if (newest) {
+            break;
+        }
+    }
+    if (!newest) {
+        return nullptr;
+    }
+
+    owned_index_.assign(newest->first_entry + newest->entries, IndexEntry{});
+    uint64_t covered = owned_index_.size();
+
+    for (const IndexHeader* index = newest; index;) {
+        if (index->first_entry + index->entries != covered) {
+            return nullptr;
+        }
+        std::memcpy(owned_index_.data() + index->first_entry, index + 1, index->entries * sizeof(IndexEntry));
+        covered = index->first_entry;
+        if (covered == 0) {
+            return newest;
+        }
+
+        // Each checkpoint points strictly backwards, so a damaged chain ends
+        if (index->previous_offset >= offset) {
+            return nullptr;
+        }
+        offset = index->previous_offset;
+        index = index_header_at(offset);
+    }
+    return nullptr;
+}
+
+bool RecordingPlayback::rebuild_index() {
+    uint64_t config_offset = 0;
+    uint64_t offset = sizeof(FileHeader);
+
+    if (const IndexHeader* checkpoint = load_checkpoints()) {
+        config_offset = checkpoint->resume_config_offset;
+        offset = checkpoint->resume_offset;
+        dropped_blocks_ = checkpoint->dropped_blocks;
+    } else {
+        owned_index_.clear();
+    }
+
+    while (const RecordHeader* header = record_at(offset)) {
+        const std::byte* payload = file_.data() + offset + sizeof(RecordHeader);
+
+        switch (static_cast<RecordType>(header->type)) {
+            case RecordType::Config:
+                config_offset = offset;
+                break;
+            case RecordType::Band: {
+                const auto* band = reinterpret_cast<const BandRecord*>(payload);
+                if (owned_index_.empty() || (band->flags & BAND_FLAG_CHUNK_START) != 0) {
+                    owned_index_.push_back({band->timestamp_us, offset, config_offset, band->start_hz, band->end_hz});
+                } else {
+                    IndexEntry& entry = owned_index_.back();
+                    entry.min_start_hz = std::min(entry.min_start_hz, band->start_hz);
+                    entry.max_end_hz = std::max(entry.max_end_hz, band->end_hz);
+                }
+                last_timestamp_us_ = band->timestamp_us;
+                break;
+            }
+            case RecordType::Drop:
+                dropped_blocks_ += reinterpret_cast<const DropRecord*>(payload)->dropped_blocks;
+                break;
+            default:
+                break;
+        }
+
+        offset += sizeof(RecordHeader) + header->payload_bytes;
+    }
+
+    records_end_ = offset;
+    index_ = owned_index_;
+    if (owned_index_.empty()) {
+        return false;
+    }
+    first_timestamp_us_ = owned_index_.front().timestamp_us;
+    return true;
+}
+
+void RecordingPlayback::load_config(uint64_t offset) {
+    if (offset == config_offset_ && config_) {
+        return;
+    }
+
+    const RecordHeader* header = record_at(offset);
+    if (!header || static_cast<RecordType>(header->type) != RecordType::Config) {
+        return;
+    }
+
+    const std::byte* payload = file_.data() + offset + sizeof(RecordHeader);
+    const auto* record = reinterpret_cast<const ConfigRecord*>(payload);
+
+    auto config = std::make_shared<SweepConfig>();
+    config->generation = record->generation;
+    config->bin_width_hz = record->bin_width_hz;
+    config->fft_size = record->fft_size;
+    config->freq_ranges_mhz.resize(static_cast<size_t>(record->num_ranges) * 2);
+    std::memcpy(config->freq_ranges_mhz.data(), payload + sizeof(ConfigRecord),
+                config->freq_ranges_mhz.size() * sizeof(uint16_t));
+
+    config_offset_ = offset;
+    config_ = std::move(config);
+}
+
+void RecordingPlayback::decode_band(uint64_t offset, PlaybackBand& band) {
+    const auto* header = reinterpret_cast<const RecordHeader*>(file_.data() + offset);
+    const auto* record = reinterpret_cast<const BandRecord*>(file_.data() + offset + sizeof(RecordHeader));
+    const std::byte* samples = file_.data() + offset + sizeof(RecordHeader) + sizeof(BandRecord);
+
+    band.timestamp_us = record->timestamp_us;
+    band.start_hz = record->start_hz;
+    band.end_hz = record->end_hz;
+    band.upper = (record->flags & BAND_FLAG_UPPER) != 0;
+
+    switch (static_cast<PowerEncoding>(record->encoding)) {
+        case PowerEncoding::Float32:
+            band.power_db = {reinterpret_cast<const float*>(samples), record->num_bins};
+            break;
+        case PowerEncoding::Int16: {
+            const auto* levels = reinterpret_cast<const int16_t*>(samples);
+            scratch_.resize(record->num_bins);
+            for (size_t i = 0; i < scratch_.size(); ++i) {
+                scratch_[i] = record->offset_db + static_cast<float>(levels[i]) * record->step_db;
+            }
+            band.power_db = scratch_;
+            break;
+        }
+        case PowerEncoding::RiceDelta:
+            scratch_.resize(record->num_bins);
+            band.power_db = scratch_;
+            if (!decode_rice(*header, *record, scratch_)) {
+                band.power_db = {};
+            }
+            break;
+        default:
+            band.power_db = {};
+            break;
+    }
+}
+
+bool RecordingPlayback::decode_rice(const RecordHeader& header, const BandRecord& record, std::span<float> out) {
+    const auto* coded = reinterpret_cast<const std::byte*>(&record) + sizeof(BandRecord);
+    return decoder_.decode(record.start_hz, (record.flags & BAND_FLAG_KEYFRAME) != 0,
+                           {coded, header.payload_bytes - sizeof(BandRecord)}, record.step_db, out);
+}
+
+// Decodes every RiceDelta band from the start of the cursor's chunk up to
+// the cursor, so the next delta band finds its reference
+void RecordingPlayback::resync_decoder() {
+    decoder_.reset();
+    decoder_synced_ = true;
+
+    auto entry = std::upper_bound(index_.begin(), index_.end(), cursor_,
+                                  [](uint64_t offset, const IndexEntry& e) { return offset < e.offset; });
+    if (entry == index_.begin()) {
+        return;
+    }
+    --entry;
+
+    for (uint64_t offset = entry->offset; offset < cursor_;) {
+        const RecordHeader* header = record_at(offset);
+        if (!header) {
+            break;
+        }
+        if (static_cast<RecordType>(header->type) == RecordType::Band) {
+            const auto* record = reinterpret_cast<const BandRecord*>(file_.data() + offset + sizeof(RecordHeader));
+            if (static_cast<PowerEncoding>(record->encoding) == PowerEncoding::RiceDelta) {
+                scratch_.resize(record->num_bins);
+                decode_rice(*header, *record, scratch_);
+            }
+        }
+        offset += sizeof(RecordHeader) + header->payload_bytes;
+    }
+}
+
+void RecordingPlayback::seek(int64_t timestamp_us) {
+    reverse_steps_.clear();
+
+    auto entry = std::upper_bound(index_.begin(), index_.end(), timestamp_us,
+                                  [](int64_t t, const IndexEntry& e) { return t < e.timestamp_us; });
+    if (entry != index_.begin()) {
+        --entry;
+    }
+
+    cursor_ = entry->offset;
+    load_config(entry->config_offset);
+    decoder_.reset();
+    decoder_synced_ = true;
+
+    // Walk the chunk up to the first band at or after the target
+    while (const RecordHeader* header = record_at(cursor_)) {
+        if (static_cast<RecordType>(header->type) == RecordType::Band) {
+            const auto* band = reinterpret_cast<const BandRecord*>(file_.data() + cursor_ + sizeof(RecordHeader));
+            if (band->timestamp_us >= timestamp_us) {
+                break;
+            }
+            if (static_cast<PowerEncoding>(band->encoding) == PowerEncoding::RiceDelta) {
+                scratch_.resize(band->num_bins);
+                decode_rice(*header, *band, scratch_);
+            }
+        } else if (static_cast<RecordType>(header->type) == RecordType::Config) {
+            load_config(cursor_);
+        }
+        cursor_ += sizeof(RecordHeader) + header->payload_bytes;
+    }
+    reverse_from_ = cursor_;
+}
+
+bool RecordingPlayback::next(PlaybackBand& band) {
+    reverse_steps_.clear();
+    if (!decoder_synced_) {
+        resync_decoder();
+    }
+
+    while (const RecordHeader* header = record_at(cursor_)) {
+        const uint64_t offset = cursor_;
+        cursor_ += sizeof(RecordHeader) + header->payload_bytes;
+
+        switch (static_cast<RecordType>(header->type)) {
+            case RecordType::Config:
+                load_config(offset);
+                break;
+            case RecordType::Band:
+                decode_band(offset, band);
+                reverse_from_ = offset;
+                return true;
+            case RecordType::Drop:
+                passed_drops_ += reinterpret_cast<const DropRecord*>(file_.data() + offset + sizeof(RecordHeader))
+                                     ->dropped_blocks;
+                break;
+            default:
+                break;
+        }
+    }
+    return false;
+}
+
+bool RecordingPlayback::previous(PlaybackBand& band) {
+    if (reverse_steps_.empty() && !fill_reverse_steps()) {
+        return false;
+    }
+
+    const ReverseStep step = reverse_steps_.back();
+    reverse_steps_.pop_back();
+
+    load_config(step.config_offset);
+    if (step.first_sample == NOT_DECODED) {
+        decode_band(step.band_offset, band);
+    } else {
+        // Header fields only; the samples were decoded by fill_reverse_steps
+        const auto* record = reinterpret_cast<const BandRecord*>(file_.data() + step.band_offset +
+                                                                 sizeof(RecordHeader));
+        band.timestamp_us = record->timestamp_us;
+        band.start_hz = record->start_hz;
+        band.end_hz = record->end_hz;
+        band.upper = (record->flags & BAND_FLAG_UPPER) != 0;
+        band.power_db = std::span<const float>(reverse_samples_).subspan(step.first_sample, record->num_bins);
+    }
+    // next() goes on with the band after this one
+    reverse_from_ = step.band_offset;
+    cursor_ = step.band_offset + sizeof(RecordHeader) + record_at(step.band_offset)->payload_bytes;
+    return true;
+}
+
+bool RecordingPlayback::fill_reverse_steps() {
+    // Chunk that holds the band record just before reverse_from_
+    auto entry = std::lower_bound(index_.begin(), index_.end(), reverse_from_,
+                                  [](const IndexEntry& e, uint64_t offset) { return e.offset < offset; });
+    if (entry == index_.begin()) {
+        return false;
+    }
+    --entry;
+
+    decoder_.reset();
+    decoder_synced_ = false;
+    reverse_samples_.clear();
+
+    uint64_t config_offset = entry->config_offset;
+    for (uint64_t offset = entry->offset; offset < reverse_from_;) {
+        const RecordHeader* header = record_at(offset);
+        if (!header) {
+            break;
+        }
+        if (static_cast<RecordType>(header->type) == RecordType::Config) {
+            config_offset = offset;
+        } else if (static_cast<RecordType>(header->type) == RecordType::Band) {
+            const auto* record = reinterpret_cast<const BandRecord*>(file_.data() + offset + sizeof(RecordHeader));
+            size_t first_sample = NOT_DECODED;
+            if (static_cast<PowerEncoding>(record->encoding) == PowerEncoding::RiceDelta) {
+                first_sample = reverse_samples_.size();
+                reverse_samples_.resize(first_sample + record->num_bins, 0.0F);
+                decode_rice(*header, *record, std::span<float>(reverse_samples_).subspan(first_sample));
+            }
+            reverse_steps_.push_back({offset, config_offset, first_sample});
+        }
+        offset += sizeof(RecordHeader) + header->payload_bytes;
+    }
+
+    return !reverse_steps_.empty();
+}
@@ -0,0 +1,66 @@
+#include "render_scheduler.hpp"
+
+#include <QGuiApplication>
+#include <QScreen>
+#include <algorithm>
+#include <cmath>
+
+constexpr int FPS_WINDOW_MS = 1000;
+
+RenderScheduler::RenderScheduler(QObject* parent) : QObject(parent) {
+    timer_.setTimerType(Qt::PreciseTimer);
+    connect(&timer_, &QTimer::timeout, this, &RenderScheduler::on_tick);
+    fps_window_.start();
+    set_target_fps(DEFAULT_TARGET_FPS);
+}
+
+void RenderScheduler::set_target_fps(int fps) {
+    if (fps > 0) {
+        target_fps_ = fps;
+    } else {
+        const QScreen* screen = QGuiApplication::primaryScreen();
+        target_fps_ = screen && screen->refreshRate() > 0.0 ? screen->refreshRate() : 60.0;
+    }
+
+    timer_.start(std::max(1, static_cast<int>(std::lround(1000.0 / target_fps_))));
+}
+
+double RenderScheduler::target_fps() const {
+    return target_fps_;
+}
+
+void RenderScheduler::sweep_completed() {
+    ++pending_sweeps_;
+}
+
+void RenderScheduler::on_tick() {
+    if (pending_sweeps_ > 0) {
+        const int sweeps = pending_sweeps_;
+        pending_sweeps_ = 0;
+
+        ++frames_;
+        ++frames_in_window_;
+        dropped_frames_ += static_cast<uint64_t>(sweeps - 1);
+
+        emit frame_due(sweeps);
+    }
+
+    const qint64 elapsed_ms = fps_window_.elapsed();
+    if (elapsed_ms >= FPS_WINDOW_MS) {
+        achieved_fps_ = frames_in_window_ * 1000.0 / static_cast<double>(elapsed_ms);
+        frames_in_window_ = 0;
+        fps_window_.restart();
+    }
+}
+
+double RenderScheduler::achieved_fps() const {
+    return achieved_fps_;
+}
+
+uint64_t RenderScheduler::frames() const {
+    return frames_;
+}
+
+uint64_t RenderScheduler::dropped_frames() const {
+    return dropped_frames_;
+}
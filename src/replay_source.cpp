@@ -0,0 +1,328 @@
+#include "replay_source.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hackrf_gain_state.hpp"
+#include "pipeline_metrics.hpp"
+#include "pipeline_trace.hpp"
+
+constexpr uint64_t MHZ_TO_HZ = 1'000'000ULL;
+
+// Splits one hackrf_sweep CSV line. Returns false for headers, blank lines
+// and anything else that does not look like a sweep line.
+bool parse_sweep_line(const std::string& text,
+                      int64_t& timestamp_us,
+                      FrequencyBand& band,
+                      double& bin_width_hz) {
+    int year = 0;
+    int month = 0;
+    int day = 0;
+    int hour = 0;
+    int minute = 0;
+    double second = 0.0;
+    unsigned long long hz_low = 0;
+    unsigned long long hz_high = 0;
+    int consumed = 0;
+
+    if (std::sscanf(text.c_str(), "%d-%d-%d, %d:%d:%lf, %llu, %llu, %lf, %*d%n",
+                    &year, &month, &day, &hour, &minute, &second,
+                    &hz_low, &hz_high, &bin_width_hz, &consumed) != 9 ||
+        consumed == 0 || hz_high <= hz_low) {
+        return false;
+    }
+
+    const auto days = std::chrono::sys_days(std::chrono::year_month_day(
+        std::chrono::year(year), std::chrono::month(month), std::chrono::day(day)));
+    timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(days.time_since_epoch()).count() +
+                   (static_cast<int64_t>(hour) * 3600 + minute * 60) * 1'000'000 +
+                   static_cast<int64_t>(std::llround(second * 1e6));
+
+    band.start_hz = hz_low;
+    band.end_hz = hz_high;
+    band.power_db.clear();
+
+    const char* cursor = text.c_str() + consumed;
+    while (*cursor != '\0') {
+        while (*cursor == ',' || *cursor == ' ') {
+            ++cursor;
+        }
+        char* end = nullptr;
+        const float value = std::strtof(cursor, &end);
+        if (end == cursor) {
+            break;
+        }
+        band.power_db.push_back(value);
+        cursor = end;
+    }
+
+    return !band.power_db.empty();
+}
+
+ReplaySource::ReplaySource(ReplayPace pace, bool loop) : pace_(pace), loop_(loop) {}
+
+ReplaySource::~ReplaySource() {
+    stop_sweep();
+}
+
+bool ReplaySource::open(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Failed to open replay file: " << path << '\n';
+        return false;
+    }
+
+    struct Interval {
+        uint64_t start_hz;
+        uint64_t end_hz;
+    };
+
+    std::vector<Interval> intervals;
+    double bin_width_hz = 0.0;
+    size_t bins_per_band = 0;
+
+    ReplayLine line;
+    while (read_line(file, line)) {
+        if (bin_width_hz == 0.0) {
+            bin_width_hz = line.bin_width_hz;
+            bins_per_band = line.band.power_db.size();
+        }
+        intervals.push_back({line.band.start_hz, line.band.end_hz});
+    }
+
+    if (intervals.empty()) {
+        std::cerr << "No hackrf_sweep lines found in replay file: " << path << '\n';
+        return false;
+    }
+
+    // Merge the swept bands back into ranges. hackrf_sweep interleaves its
+    // tuning steps, so neighbouring bands may be one band width apart.
+    std::sort(intervals.begin(), intervals.end(),
+              [](const Interval& a, const Interval& b) { return a.start_hz < b.start_hz; });
+
+    std::vector<Interval> merged;
+    for (const Interval& interval : intervals) {
+        const uint64_t tolerance = interval.end_hz - interval.start_hz;
+        if (!merged.empty() && interval.start_hz <= merged.back().end_hz + tolerance) {
+            merged.back().end_hz = std::max(merged.back().end_hz, interval.end_hz);
+        } else {
+            merged.push_back(interval);
+        }
+    }
+
+    auto config = std::make_shared<SweepConfig>();
+    config->generation = 1;
+    config->bin_width_hz = bin_width_hz;
+    config->fft_size = static_cast<int>(bins_per_band * 4);
+
+    std::vector<ScanRange> ranges;
+    for (const Interval& interval : merged) {
+        const auto start_mhz = static_cast<uint16_t>(interval.start_hz / MHZ_TO_HZ);
+        const auto end_mhz = static_cast<uint16_t>((interval.end_hz + MHZ_TO_HZ - 1) / MHZ_TO_HZ);
+        ranges.push_back({start_mhz, end_mhz});
+        config->freq_ranges_mhz.push_back(start_mhz);
+        config->freq_ranges_mhz.push_back(end_mhz);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    path_ = path;
+    scan_ranges_ = std::move(ranges);
+    sweep_config_ = std::move(config);
+    return true;
+}
+
+bool ReplaySource::read_line(std::ifstream& file, ReplayLine& line) {
+    std::string text;
+    while (std::getline(file, text)) {
+        if (parse_sweep_line(text, line.timestamp_us, line.band, line.bin_width_hz)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ReplaySource::is_connected() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sweep_config_ != nullptr;
+}
+
+bool ReplaySource::connect_device() {
+    return is_connected();
+}
+
+void ReplaySource::start_sweep() {
+    if (!is_connected()) {
+        return;
+    }
+
+    stop_sweep();
+
+    running_.store(true);
+    thread_ = std::thread(&ReplaySource::run, this);
+}
+
+void ReplaySource::stop_sweep() {
+    running_.store(false);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void ReplaySource::restart_sweep() {
+    start_sweep();
+}
+
+void ReplaySource::run() {
+    pipeline_trace_set_thread_name("replay");
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    const std::string path = path_;
+    const std::shared_ptr<const SweepConfig> config = sweep_config_;
+    lock.unlock();
+
+    std::ifstream file(path);
+
+    ReplayStats stats;
+    const auto replay_start = std::chrono::steady_clock::now();
+    auto pass_start = replay_start;
+    int64_t first_timestamp_us = -1;
+
+    FFTSweepData block;
+    block.config = config;
+
+    ReplayLine current;
+    ReplayLine next;
+    bool have_next = false;
+
+    while (running_.load(std::memory_order_relaxed)) {
+        if (have_next) {
+            std::swap(current, next);
+            have_next = false;
+        } else if (!read_line(file, current)) {
+            if (!loop_) {
+                break;
+            }
+            file.clear();
+            file.seekg(0);
+            ++stats.passes;
+            first_timestamp_us = -1;
+            continue;
+        }
+
+        // Pair this line with the next one if both came from one tuning step
+        have_next = read_line(file, next);
+        const bool paired = have_next && next.timestamp_us == current.timestamp_us &&
+                            next.band.start_hz > current.band.start_hz;
+
+        block.timestamp_us = current.timestamp_us;
+        std::swap(block.band_lower, current.band);
+        if (paired) {
+            std::swap(block.band_upper, next.band);
+            have_next = false;
+        } else {
+            block.band_upper.start_hz = 0;
+            block.band_upper.end_hz = 0;
+            block.band_upper.power_db.clear();
+        }
+
+        if (pace_ == ReplayPace::Original) {
+            if (first_timestamp_us < 0) {
+                first_timestamp_us = current.timestamp_us;
+                pass_start = std::chrono::steady_clock::now();
+            }
+            std::this_thread::sleep_until(
+                pass_start + std::chrono::microseconds(current.timestamp_us - first_timestamp_us));
+        }
+
+        lock.lock();
+        const FFTCallback callback = fft_callback_;
+        lock.unlock();
+
+        block.capture_ns = pipeline_now_ns();
+        if (callback) {
+            PIPELINE_TRACE_SCOPE("deliver block");
+            callback(block);
+        }
+        ++stats.blocks;
+    }
+
+    ++stats.passes;
+    stats.elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - replay_start).count();
+
+    lock.lock();
+    const ReplayFinishedCallback finished = finished_callback_;
+    lock.unlock();
+
+    if (finished) {
+        finished(stats);
+    }
+}
+
+void ReplaySource::set_gain_state(const HackRFGainState& state) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    gain_state_ = state;
+}
+
+HackRFGainState ReplaySource::get_gain_state() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return gain_state_;
+}
+
+void ReplaySource::set_amp_enable(bool enable) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    gain_state_.set_amp_enable(enable);
+}
+
+void ReplaySource::set_vga_gain(int gain) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    gain_state_.set_vga_gain(gain);
+}
+
+void ReplaySource::set_lna_gain(int gain) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    gain_state_.set_lna_gain(gain);
+}
+
+void ReplaySource::set_fft_callback(FFTCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fft_callback_ = std::move(callback);
+}
+
+void ReplaySource::set_finished_callback(ReplayFinishedCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    finished_callback_ = std::move(callback);
+}
+
+bool ReplaySource::set_scan_ranges(const std::vector<ScanRange>& ranges) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const bool unchanged = std::equal(ranges.begin(), ranges.end(), scan_ranges_.begin(), scan_ranges_.end(),
+                                      [](const ScanRange& a, const ScanRange& b) {
+                                          return a.start_mhz == b.start_mhz && a.end_mhz == b.end_mhz;
+                                      });
+    if (!unchanged) {
+        std::cerr << "Scan ranges are fixed by the replay file\n";
+    }
+    return unchanged;
+}
+
+// Nothing changes, and a restart would start the file over
+bool ReplaySource::applies_scan_ranges_live() const {
+    return true;
+}
+
+std::vector<ScanRange> ReplaySource::get_scan_ranges() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return scan_ranges_;
+}
@@ -0,0 +1,262 @@
+#include "simulated_source.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "hackrf_controller.hpp"
+#include "hackrf_gain_state.hpp"
+#include "pipeline_metrics.hpp"
+#include "pipeline_trace.hpp"
+#include "sweep_partition.hpp"
+
+constexpr uint64_t MHZ_TO_HZ = 1'000'000ULL;
+
+namespace {
+
+// Downlinks and ISM traffic a scan would typically turn up
+constexpr std::array<SimulatedCarrier, 6> SIMULATED_CARRIERS{{
+    {806'000'000, 10'000'000, -60.0F},
+    {948'000'000, 5'000'000, -65.0F},
+    {1'815'000'000, 20'000'000, -62.0F},
+    {2'140'000'000, 15'000'000, -58.0F},
+    {2'437'000'000, 20'000'000, -70.0F},
+    {3'500'000'000, 40'000'000, -66.0F},
+}};
+
+// Gains the simulated levels above are quoted at
+constexpr int SIMULATED_REFERENCE_GAIN_DB = 24;
+
+int simulated_fft_size() {
+    // hackrf_sweeper rounds the FFT up so that (size + 4) is a multiple of 8
+    int size = DEFAULT_SAMPLE_RATE_HZ / FFT_BIN_WIDTH_HZ;
+    while ((size + 4) % 8 != 0) {
+        ++size;
+    }
+    return size;
+}
+
+float gain_offset_db(const HackRFGainState& gain) {
+    return static_cast<float>(gain.get_lna_gain() + gain.get_vga_gain() - SIMULATED_REFERENCE_GAIN_DB +
+                              (gain.get_amp_enable() ? hackrf_hardware::AMP_GAIN_DB : 0));
+}
+
+}  // namespace
+
+SimulatedSource::SimulatedSource(uint32_t seed) : random_state_(0x9E3779B97F4A7C15ULL ^ seed) {}
+
+SimulatedSource::~SimulatedSource() {
+    stop_sweep();
+}
+
+bool SimulatedSource::is_connected() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return connected_;
+}
+
+bool SimulatedSource::connect_device() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    connected_ = true;
+    publish_sweep_config();
+    return true;
+}
+
+void SimulatedSource::start_sweep() {
+    if (!is_connected()) {
+        return;
+    }
+
+    stop_sweep();
+
+    running_.store(true);
+    thread_ = std::thread(&SimulatedSource::run, this);
+}
+
+void SimulatedSource::stop_sweep() {
+    running_.store(false);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void SimulatedSource::restart_sweep() {
+    start_sweep();
+}
+
+void SimulatedSource::run() {
+    using Clock = std::chrono::steady_clock;
+    constexpr auto BLOCK_PERIOD = std::chrono::microseconds(1'000'000 / SIMULATED_BLOCKS_PER_SECOND);
+    constexpr uint64_t BAND_HZ = DEFAULT_SAMPLE_RATE_HZ / 4;
+    constexpr uint64_t STEP_HZ = SWEEP_TUNE_STEP_MHZ * MHZ_TO_HZ;
+
+    pipeline_trace_set_thread_name("simulated device");
+
+    FFTSweepData block;
+    auto next_block = Clock::now();
+
+    while (running_.load(std::memory_order_relaxed)) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        block.config = sweep_config_;
+        const float gain_db = gain_offset_db(gain_state_);
+        lock.unlock();
+
+        if (!block.config || block.config->freq_ranges_mhz.empty()) {
+            std::this_thread::sleep_for(BLOCK_PERIOD);
+            continue;
+        }
+
+        const std::vector<uint16_t>& ranges = block.config->freq_ranges_mhz;
+        for (size_t r = 0; r + 1 < ranges.size() && running_.load(std::memory_order_relaxed); r += 2) {
+            for (uint64_t step_hz = ranges[r] * MHZ_TO_HZ; step_hz < ranges[r + 1] * MHZ_TO_HZ; step_hz += STEP_HZ) {
+                // Two retunes per step, a quarter of the sample rate apart,
+                // each delivering a lower and an upper band
+                for (const uint64_t offset_hz : {uint64_t{0}, BAND_HZ}) {
+                    if (!running_.load(std::memory_order_relaxed)) {
+                        break;
+                    }
+
+                    fill_band(block.band_lower, *block.config, step_hz + offset_hz, gain_db);
+                    fill_band(block.band_upper, *block.config, step_hz + offset_hz + 2 * BAND_HZ, gain_db);
+
+                    // Do not try to catch up after the thread was held up
+                    const auto now = Clock::now();
+                    next_block = std::max(next_block + BLOCK_PERIOD, now - BLOCK_PERIOD);
+                    std::this_thread::sleep_until(next_block);
+
+                    block.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                             std::chrono::system_clock::now().time_since_epoch())
+                                             .count();
+                    block.capture_ns = pipeline_now_ns();
+
+                    lock.lock();
+                    const FFTCallback callback = fft_callback_;
+                    lock.unlock();
+
+                    if (callback) {
+                        PIPELINE_TRACE_SCOPE("deliver block");
+                        callback(block);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void SimulatedSource::fill_band(FrequencyBand& band, const SweepConfig& config, uint64_t start_hz, float gain_db) {
+    const auto num_bins = static_cast<size_t>(config.fft_size / 4);
+
+    band.start_hz = start_hz;
+    band.end_hz = start_hz + DEFAULT_SAMPLE_RATE_HZ / 4;
+    band.power_db.resize(num_bins);
+
+    for (size_t i = 0; i < num_bins; ++i) {
+        // xorshift64*; the sum of two uniforms gives a rounded noise shape
+        random_state_ ^= random_state_ >> 12;
+        random_state_ ^= random_state_ << 25;
+        random_state_ ^= random_state_ >> 27;
+        const uint64_t bits = random_state_ * 0x2545F4914F6CDD1DULL;
+        const float noise = (static_cast<float>(bits >> 40) + static_cast<float>(bits & 0xFFFFFF)) /
+                                static_cast<float>(1 << 24) -
+                            1.0F;
+
+        const auto center_hz = static_cast<double>(start_hz) + (static_cast<double>(i) + 0.5) * config.bin_width_hz;
+        float level = SIMULATED_NOISE_DB;
+        for (const SimulatedCarrier& carrier : SIMULATED_CARRIERS) {
+            if (std::abs(center_hz - static_cast<double>(carrier.center_hz)) * 2.0 <=
+                static_cast<double>(carrier.bandwidth_hz)) {
+                level = std::max(level, carrier.power_db);
+            }
+        }
+
+        band.power_db[i] = level + gain_db + noise * SIMULATED_NOISE_SPREAD_DB;
+    }
+}
+
+void SimulatedSource::publish_sweep_config() {
+    auto config = std::make_shared<SweepConfig>();
+    config->generation = ++sweep_config_generation_;
+    config->fft_size = simulated_fft_size();
+    config->bin_width_hz = static_cast<double>(DEFAULT_SAMPLE_RATE_HZ) / config->fft_size;
+
+    // Widened to whole tuning steps, as hackrf_sweeper does
+    for (const ScanRange& range : scan_ranges_) {
+        const uint32_t steps = sweep_tune_steps({range});
+        config->freq_ranges_mhz.push_back(range.start_mhz);
+        config->freq_ranges_mhz.push_back(static_cast<uint16_t>(range.start_mhz + steps * SWEEP_TUNE_STEP_MHZ));
+    }
+
+    sweep_config_ = std::move(config);
+}
+
+void SimulatedSource::set_gain_state(const HackRFGainState& state) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    gain_state_ = state;
+}
+
+HackRFGainState SimulatedSource::get_gain_state() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return gain_state_;
+}
+
+void SimulatedSource::set_amp_enable(bool enable) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    gain_state_.set_amp_enable(enable);
+}
+
+void SimulatedSource::set_vga_gain(int gain) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    gain_state_.set_vga_gain(gain);
+}
+
+void SimulatedSource::set_lna_gain(int gain) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    gain_state_.set_lna_gain(gain);
+}
+
+void SimulatedSource::set_fft_callback(FFTCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fft_callback_ = std::move(callback);
+}
+
+bool SimulatedSource::set_scan_ranges(const std::vector<ScanRange>& ranges) {
+    if (ranges.empty()) {
+        std::cerr << "At least one scan range is required\n";
+        return false;
+    }
+
+    for (const ScanRange& range : ranges) {
+        if (range.start_mhz >= range.end_mhz) {
+            std::cerr << "Invalid range: start must be less than end\n";
+            return false;
+        }
+        if (range.start_mhz < FREQ_MIN_MHZ || range.end_mhz > FREQ_MAX_MHZ) {
+            std::cerr << "Frequency out of HackRF range (1-6000 MHz)\n";
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    scan_ranges_ = ranges;
+    if (connected_) {
+        publish_sweep_config();
+    }
+    return true;
+}
+
+// The sweep thread rereads the config before every pass
+bool SimulatedSource::applies_scan_ranges_live() const {
+    return true;
+}
+
+std::vector<ScanRange> SimulatedSource::get_scan_ranges() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return scan_ranges_;
+}
@@ -0,0 +1,78 @@
+#include "spectrum_decimator.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+void SpectrumDecimator::reset(std::span<const float> bins) {
+    levels_.clear();
+
+    size_t nodes = bins.size();
+    while (nodes > 1) {
+        nodes = (nodes + 1) / 2;
+        levels_.emplace_back(nodes);
+    }
+
+    if (!bins.empty()) {
+        update(bins, 0, bins.size());
+    }
+}
+
+void SpectrumDecimator::update(std::span<const float> bins, size_t first, size_t count) {
+    if (count == 0 || levels_.empty()) {
+        return;
+    }
+
+    size_t lo = first / 2;
+    size_t hi = (first + count - 1) / 2;
+
+    std::vector<MinMax>& pairs = levels_.front();
+    for (size_t i = lo; i <= hi; ++i) {
+        const float a = bins[2 * i];
+        const float b = 2 * i + 1 < bins.size() ? bins[2 * i + 1] : a;
+        pairs[i] = {std::min(a, b), std::max(a, b)};
+    }
+
+    for (size_t level = 1; level < levels_.size(); ++level) {
+        const std::vector<MinMax>& children = levels_[level - 1];
+        std::vector<MinMax>& parents = levels_[level];
+
+        lo /= 2;
+        hi /= 2;
+        for (size_t i = lo; i <= hi; ++i) {
+            const MinMax& a = children[2 * i];
+            const MinMax& b = 2 * i + 1 < children.size() ? children[2 * i + 1] : a;
+            parents[i] = {std::min(a.min, b.min), std::max(a.max, b.max)};
+        }
+    }
+}
+
+MinMax SpectrumDecimator::range(std::span<const float> bins, size_t first, size_t last) const {
+    MinMax result{bins[first], bins[first]};
+
+    size_t i = first;
+    while (i < last) {
+        // Largest aligned node starting at i that fits inside [i, last)
+        size_t level = 0;
+        while (level < levels_.size() &&
+               (i & ((size_t{2} << level) - 1)) == 0 &&
+               i + (size_t{2} << level) <= last) {
+            ++level;
+        }
+
+        if (level == 0) {
+            result.min = std::min(result.min, bins[i]);
+            result.max = std::max(result.max, bins[i]);
+            ++i;
+            continue;
+        }
+
+        const MinMax& node = levels_[level - 1][i >> level];
+        result.min = std::min(result.min, node.min);
+        result.max = std::max(result.max, node.max);
+        i += size_t{1} << level;
+    }
+
+    return result;
+}
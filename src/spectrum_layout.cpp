@@ -0,0 +1,137 @@
+#include "spectrum_layout.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+constexpr uint64_t MHZ_TO_HZ = 1'000'000ULL;
+
+SpectrumLayout::SpectrumLayout(double bin_width_hz, const std::vector<uint16_t>& freq_ranges_mhz)
+    : bin_width_hz_(bin_width_hz) {
+    if (bin_width_hz_ <= 0.0) {
+        return;
+    }
+
+    segments_.reserve(freq_ranges_mhz.size() / 2);
+
+    for (size_t i = 0; i + 1 < freq_ranges_mhz.size(); i += 2) {
+        if (freq_ranges_mhz[i + 1] <= freq_ranges_mhz[i]) {
+            continue;
+        }
+
+        SpectrumSegment segment;
+        segment.start_hz = freq_ranges_mhz[i] * MHZ_TO_HZ;
+        segment.end_hz = freq_ranges_mhz[i + 1] * MHZ_TO_HZ;
+        segment.first_bin = num_bins_;
+        segment.num_bins = static_cast<size_t>(
+            std::ceil(static_cast<double>(segment.end_hz - segment.start_hz) / bin_width_hz_));
+
+        num_bins_ += segment.num_bins;
+        segments_.push_back(segment);
+    }
+}
+
+uint64_t SpectrumLayout::start_hz() const noexcept {
+    return segments_.empty() ? 0 : segments_.front().start_hz;
+}
+
+uint64_t SpectrumLayout::end_hz() const noexcept {
+    return segments_.empty() ? 0 : segments_.back().end_hz;
+}
+
+double SpectrumLayout::frequency_at(size_t bin) const {
+    // Segments are few (hackrf_sweeper caps them at MAX_SWEEP_RANGES), so a
+    // linear scan beats anything cleverer.
+    for (const SpectrumSegment& segment : segments_) {
+        if (bin < segment.first_bin + segment.num_bins) {
+            return static_cast<double>(segment.start_hz) +
+                   static_cast<double>(bin - segment.first_bin) * bin_width_hz_;
+        }
+    }
+    return static_cast<double>(end_hz());
+}
+
+size_t SpectrumLayout::bin_at(uint64_t freq_hz) const {
+    for (const SpectrumSegment& segment : segments_) {
+        if (freq_hz >= segment.start_hz && freq_hz < segment.end_hz) {
+            const auto offset = static_cast<size_t>(
+                static_cast<double>(freq_hz - segment.start_hz) / bin_width_hz_);
+            return segment.first_bin + std::min(offset, segment.num_bins - 1);
+        }
+    }
+    return npos;
+}
+
+double SpectrumLayout::frequency_of_column(double column) const {
+    if (segments_.empty()) {
+        return 0.0;
+    }
+
+    const SpectrumSegment* segment = &segments_.front();
+    for (const SpectrumSegment& candidate : segments_) {
+        if (column >= static_cast<double>(candidate.first_bin)) {
+            segment = &candidate;
+        }
+    }
+    return static_cast<double>(segment->start_hz) +
+           (column - static_cast<double>(segment->first_bin)) * bin_width_hz_;
+}
+
+double SpectrumLayout::column_of_frequency(double freq_hz) const {
+    if (segments_.empty()) {
+        return 0.0;
+    }
+
+    // Frequencies in a gap snap to the edge of the nearer segment
+    const SpectrumSegment* nearest = &segments_.front();
+    double nearest_distance = std::numeric_limits<double>::max();
+    for (const SpectrumSegment& segment : segments_) {
+        const double start = static_cast<double>(segment.start_hz);
+        const double end = start + static_cast<double>(segment.num_bins) * bin_width_hz_;
+        const double distance = freq_hz < start ? start - freq_hz : (freq_hz > end ? freq_hz - end : 0.0);
+        if (distance < nearest_distance) {
+            nearest = &segment;
+            nearest_distance = distance;
+        }
+    }
+
+    const double start = static_cast<double>(nearest->start_hz);
+    const double offset = std::clamp((freq_hz - start) / bin_width_hz_, 0.0, static_cast<double>(nearest->num_bins));
+    return static_cast<double>(nearest->first_bin) + offset;
+}
+
+std::vector<BinRun> SpectrumLayout::shared_bins(const SpectrumLayout& to) const {
+    std::vector<BinRun> runs;
+    if (bin_width_hz_ <= 0.0 || bin_width_hz_ != to.bin_width_hz_) {
+        return runs;
+    }
+
+    for (const SpectrumSegment& from_segment : segments_) {
+        for (const SpectrumSegment& to_segment : to.segments_) {
+            const uint64_t start_hz = std::max(from_segment.start_hz, to_segment.start_hz);
+            const uint64_t end_hz = std::min(from_segment.end_hz, to_segment.end_hz);
+            if (start_hz >= end_hz) {
+                continue;
+            }
+
+            const auto from_offset = static_cast<size_t>(
+                std::round(static_cast<double>(start_hz - from_segment.start_hz) / bin_width_hz_));
+            const auto to_offset = static_cast<size_t>(
+                std::round(static_cast<double>(start_hz - to_segment.start_hz) / bin_width_hz_));
+            if (from_offset >= from_segment.num_bins || to_offset >= to_segment.num_bins) {
+                continue;
+            }
+
+            const size_t count = std::min({
+                static_cast<size_t>(std::ceil(static_cast<double>(end_hz - start_hz) / bin_width_hz_)),
+                from_segment.num_bins - from_offset,
+                to_segment.num_bins - to_offset,
+            });
+            runs.push_back({from_segment.first_bin + from_offset, to_segment.first_bin + to_offset, count});
+        }
+    }
+    return runs;
+}
@@ -0,0 +1,99 @@
+#include "spectrum_series_data.hpp"
+
+#include <QPointF>
+#include <QRectF>
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <vector>
+
+#include "dataset_spectrum.hpp"
+
+SpectrumSeriesData::SpectrumSeriesData(const DatasetSpectrum* spectrum) : spectrum_(spectrum) {}
+
+SpectrumSeriesData::SpectrumSeriesData(const DatasetSpectrum* spectrum, TraceKind trace)
+    : spectrum_(spectrum), trace_(trace) {}
+
+void SpectrumSeriesData::update_envelope(double min_column, double max_column, int pixels) {
+    points_.clear();
+
+    const SpectrumLayout& layout = spectrum_->get_layout();
+    if (layout.empty() || pixels <= 0 || max_column <= min_column) {
+        return;
+    }
+
+    const TraceProcessor* trace = trace_ ? spectrum_->get_trace(*trace_) : nullptr;
+    if (trace_ && trace == nullptr) {
+        return;
+    }
+
+    const std::span<const float> power = trace ? trace->values() : spectrum_->get_spectrum();
+    const double columns_per_pixel = (max_column - min_column) / pixels;
+
+    // Segments are walked one at a time so no pixel pools bins from both
+    // sides of a gap between ranges
+    for (const SpectrumSegment& segment : layout.segments()) {
+        const auto segment_start = static_cast<double>(segment.first_bin);
+        const double lo = std::max(min_column, segment_start);
+        const double hi = std::min(max_column, segment_start + static_cast<double>(segment.num_bins));
+        if (hi <= lo) {
+            continue;
+        }
+
+        const auto to_bin = [&](double column, bool round_up) {
+            const double bin = column - segment_start;
+            const double rounded = round_up ? std::ceil(bin) : std::floor(bin);
+            return static_cast<size_t>(std::clamp(rounded, 0.0, static_cast<double>(segment.num_bins)));
+        };
+
+        const size_t first = to_bin(lo, false);
+        const size_t last = to_bin(hi, true);
+
+        // Few enough bins to draw them as they are
+        if (last - first <= 2 * static_cast<size_t>(std::ceil((hi - lo) / columns_per_pixel))) {
+            for (size_t bin = first; bin < last; ++bin) {
+                points_.emplace_back(segment_start + static_cast<double>(bin), power[segment.first_bin + bin]);
+            }
+            continue;
+        }
+
+        const auto first_pixel = static_cast<int>(std::floor((lo - min_column) / columns_per_pixel));
+        const auto last_pixel = static_cast<int>(std::ceil((hi - min_column) / columns_per_pixel));
+
+        for (int pixel = first_pixel; pixel < last_pixel; ++pixel) {
+            const double pixel_lo = min_column + pixel * columns_per_pixel;
+            const size_t bin_lo = std::max(first, to_bin(pixel_lo, false));
+            const size_t bin_hi = std::min(last, to_bin(pixel_lo + columns_per_pixel, true));
+            if (bin_hi <= bin_lo) {
+                continue;
+            }
+
+            const size_t envelope_first = segment.first_bin + bin_lo;
+            const size_t envelope_last = segment.first_bin + bin_hi;
+            const MinMax envelope = trace ? trace->get_min_max(envelope_first, envelope_last)
+                                          : spectrum_->get_min_max(envelope_first, envelope_last);
+            const double x = pixel_lo + columns_per_pixel / 2;
+            points_.emplace_back(x, envelope.min);
+            points_.emplace_back(x, envelope.max);
+        }
+    }
+}
+
+size_t SpectrumSeriesData::size() const {
+    return points_.size();
+}
+
+QPointF SpectrumSeriesData::sample(size_t i) const {
+    return points_[i];
+}
+
+QRectF SpectrumSeriesData::boundingRect() const {
+    // The plot axes are fixed, so only the column extent matters; avoid
+    // walking every bin just to find the power range.
+    const SpectrumLayout& layout = spectrum_->get_layout();
+    if (layout.empty()) {
+        return QRectF(1.0, 1.0, -2.0, -2.0);  // invalid rect, as Qwt expects
+    }
+
+    return QRectF(0.0, SPECTRUM_NO_DATA_DB, static_cast<double>(layout.num_bins()), -SPECTRUM_NO_DATA_DB);
+}
@@ -0,0 +1,147 @@
+#include "spectrum_statistics.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace {
+
+size_t bucket_of(float power_db) {
+    const float bucket = (power_db - STATS_MIN_DB) / STATS_BUCKET_DB;
+    if (!(bucket > 0.0F)) {
+        return 0;  // Also catches NaN
+    }
+    return std::min(static_cast<size_t>(bucket), STATS_BUCKETS - 1);
+}
+
+// Halving keeps the shape of the distribution while letting new sweeps
+// outweigh old ones
+uint64_t halve(std::span<uint32_t> histogram) {
+    uint64_t total = 0;
+    for (uint32_t& count : histogram) {
+        count /= 2;
+        total += count;
+    }
+    return total;
+}
+
+}  // namespace
+
+SpectrumStatistics::SpectrumStatistics(size_t num_bins)
+    : mean_(num_bins, 0.0F),
+      variance_(num_bins, 0.0F),
+      count_(num_bins, 0),
+      cell_histograms_(((num_bins + STATS_CELL_BINS - 1) / STATS_CELL_BINS) * STATS_BUCKETS, 0),
+      cell_totals_((num_bins + STATS_CELL_BINS - 1) / STATS_CELL_BINS, 0),
+      histogram_(STATS_BUCKETS, 0) {}
+
+void SpectrumStatistics::update(size_t first_bin, std::span<const float> power_db) {
+    if (power_db.empty() || first_bin + power_db.size() > mean_.size()) {
+        return;
+    }
+
+    for (size_t i = 0; i < power_db.size(); ++i) {
+        const size_t bin = first_bin + i;
+        const float value = power_db[i];
+
+        const uint32_t n = std::min(count_[bin] + 1, STATS_HISTORY_SWEEPS);
+        const float delta = value - mean_[bin];
+        mean_[bin] += delta / static_cast<float>(n);
+        variance_[bin] += (delta * (value - mean_[bin]) - variance_[bin]) / static_cast<float>(n);
+        count_[bin] = n;
+
+        const size_t bucket = bucket_of(value);
+        ++cell_histograms_[(bin / STATS_CELL_BINS) * STATS_BUCKETS + bucket];
+        ++histogram_[bucket];
+    }
+
+    const size_t first_cell = first_bin / STATS_CELL_BINS;
+    const size_t last_cell = (first_bin + power_db.size() - 1) / STATS_CELL_BINS;
+    for (size_t cell = first_cell; cell <= last_cell; ++cell) {
+        const size_t cell_begin = std::max(first_bin, cell * STATS_CELL_BINS);
+        const size_t cell_end = std::min(first_bin + power_db.size(), (cell + 1) * STATS_CELL_BINS);
+        cell_totals_[cell] += cell_end - cell_begin;
+
+        if (cell_totals_[cell] > uint64_t{STATS_CELL_BINS} * STATS_HISTORY_SWEEPS) {
+            cell_totals_[cell] = halve(std::span(cell_histograms_).subspan(cell * STATS_BUCKETS, STATS_BUCKETS));
+        }
+    }
+
+    total_ += power_db.size();
+    if (total_ > uint64_t{mean_.size()} * STATS_HISTORY_SWEEPS) {
+        total_ = halve(histogram_);
+    }
+}
+
+void SpectrumStatistics::reset() {
+    std::fill(mean_.begin(), mean_.end(), 0.0F);
+    std::fill(variance_.begin(), variance_.end(), 0.0F);
+    std::fill(count_.begin(), count_.end(), 0);
+    std::fill(cell_histograms_.begin(), cell_histograms_.end(), 0);
+    std::fill(cell_totals_.begin(), cell_totals_.end(), 0);
+    std::fill(histogram_.begin(), histogram_.end(), 0);
+    total_ = 0;
+}
+
+void SpectrumStatistics::remap(const std::vector<BinRun>& runs, size_t num_bins) {
+    remap_bins(mean_, runs, num_bins, 0.0F);
+    remap_bins(variance_, runs, num_bins, 0.0F);
+    remap_bins(count_, runs, num_bins, uint32_t{0});
+
+    const size_t num_cells = (num_bins + STATS_CELL_BINS - 1) / STATS_CELL_BINS;
+    std::vector<uint32_t> cell_histograms(num_cells * STATS_BUCKETS, 0);
+    std::vector<uint64_t> cell_totals(num_cells, 0);
+    std::vector<bool> filled(num_cells, false);
+
+    for (const BinRun& run : runs) {
+        for (size_t cell = run.to_bin / STATS_CELL_BINS; cell * STATS_CELL_BINS < run.to_bin + run.count; ++cell) {
+            if (filled[cell]) {
+                continue;
+            }
+            const size_t to_bin = std::max(run.to_bin, cell * STATS_CELL_BINS);
+            const size_t from_cell = (run.from_bin + (to_bin - run.to_bin)) / STATS_CELL_BINS;
+            std::copy_n(cell_histograms_.begin() + static_cast<ptrdiff_t>(from_cell * STATS_BUCKETS), STATS_BUCKETS,
+                        cell_histograms.begin() + static_cast<ptrdiff_t>(cell * STATS_BUCKETS));
+            cell_totals[cell] = cell_totals_[from_cell];
+            filled[cell] = true;
+        }
+    }
+
+    cell_histograms_ = std::move(cell_histograms);
+    cell_totals_ = std::move(cell_totals);
+}
+
+float SpectrumStatistics::noise_floor_db(size_t bin) const {
+    const size_t cell = bin / STATS_CELL_BINS;
+    return percentile(std::span(cell_histograms_).subspan(cell * STATS_BUCKETS, STATS_BUCKETS), cell_totals_[cell],
+                      STATS_NOISE_FLOOR_PERCENTILE);
+}
+
+float SpectrumStatistics::noise_floor_db() const {
+    return percentile(histogram_, total_, STATS_NOISE_FLOOR_PERCENTILE);
+}
+
+float SpectrumStatistics::percentile_db(double fraction) const {
+    return percentile(histogram_, total_, fraction);
+}
+
+float SpectrumStatistics::percentile(std::span<const uint32_t> histogram, uint64_t total, double fraction) {
+    if (total == 0) {
+        return STATS_MIN_DB;
+    }
+
+    // Interpolate inside the bucket the target rank falls into
+    const double target = std::clamp(fraction, 0.0, 1.0) * static_cast<double>(total);
+    double below = 0.0;
+    for (size_t bucket = 0; bucket < histogram.size(); ++bucket) {
+        const auto count = static_cast<double>(histogram[bucket]);
+        if (count > 0.0 && below + count >= target) {
+            const double within = (target - below) / count;
+            return STATS_MIN_DB + static_cast<float>((static_cast<double>(bucket) + within) * STATS_BUCKET_DB);
+        }
+        below += count;
+    }
+    return STATS_MAX_DB;
+}
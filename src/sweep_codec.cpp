@@ -0,0 +1,199 @@
+#include "sweep_codec.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace {
+
+constexpr int RICE_ESCAPE = 24;
+constexpr int RICE_ESCAPE_BITS = 17;  // Zigzag of an int16 difference
+constexpr int RICE_MAX_K = 15;
+
+int16_t quantize(float power_db, float inverse_step) {
+    const float level = std::nearbyint(power_db * inverse_step);
+    return static_cast<int16_t>(std::clamp(level,
+                                           static_cast<float>(std::numeric_limits<int16_t>::min()),
+                                           static_cast<float>(std::numeric_limits<int16_t>::max())));
+}
+
+uint32_t zigzag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+int32_t unzigzag(uint32_t value) {
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+class BitWriter {
+   public:
+    explicit BitWriter(std::vector<std::byte>& out) : out_(out) {}
+
+    void put(uint32_t value, int bits) {
+        accumulator_ = (accumulator_ << bits) | value;
+        pending_ += bits;
+        while (pending_ >= 8) {
+            pending_ -= 8;
+            out_.push_back(static_cast<std::byte>(accumulator_ >> pending_));
+        }
+    }
+
+    void finish() {
+        if (pending_ > 0) {
+            out_.push_back(static_cast<std::byte>(accumulator_ << (8 - pending_)));
+            pending_ = 0;
+        }
+    }
+
+   private:
+    std::vector<std::byte>& out_;
+    uint64_t accumulator_ = 0;
+    int pending_ = 0;
+};
+
+class BitReader {
+   public:
+    explicit BitReader(std::span<const std::byte> in) : in_(in) {}
+
+    bool get(int bits, uint32_t& value) {
+        while (available_ < bits) {
+            if (position_ == in_.size()) {
+                return false;
+            }
+            accumulator_ = (accumulator_ << 8) | static_cast<uint64_t>(in_[position_++]);
+            available_ += 8;
+        }
+        available_ -= bits;
+        value = static_cast<uint32_t>(accumulator_ >> available_) & ((uint64_t{1} << bits) - 1);
+        return true;
+    }
+
+    // Counts ones up to the terminating zero, stopping at limit
+    bool get_unary(int limit, int& count) {
+        count = 0;
+        uint32_t bit = 0;
+        while (count < limit) {
+            if (!get(1, bit)) {
+                return false;
+            }
+            if (bit == 0) {
+                return true;
+            }
+            ++count;
+        }
+        return true;
+    }
+
+   private:
+    std::span<const std::byte> in_;
+    size_t position_ = 0;
+    uint64_t accumulator_ = 0;
+    int available_ = 0;
+};
+
+}  // namespace
+
+bool SweepEncoder::encode(uint64_t start_hz, std::span<const float> power_db, float step_db,
+                          std::vector<std::byte>& out) {
+    const float inverse_step = 1.0F / step_db;
+
+    std::vector<int16_t>& reference = previous_[start_hz];
+    const bool keyframe = reference.size() != power_db.size();
+
+    residuals_.resize(power_db.size());
+    uint64_t sum = 0;
+    int16_t neighbour = 0;
+
+    if (keyframe) {
+        reference.resize(power_db.size());
+    }
+
+    for (size_t i = 0; i < power_db.size(); ++i) {
+        const int16_t level = quantize(power_db[i], inverse_step);
+        const int16_t prediction = keyframe ? neighbour : reference[i];
+        residuals_[i] = zigzag(static_cast<int32_t>(level) - prediction);
+        sum += residuals_[i];
+        neighbour = level;
+        reference[i] = level;
+    }
+
+    // Rice parameter close to log2 of the mean residual
+    int k = 0;
+    while (k < RICE_MAX_K && (static_cast<uint64_t>(power_db.size()) << (k + 1)) <= sum) {
+        ++k;
+    }
+
+    out.push_back(static_cast<std::byte>(k));
+    BitWriter writer(out);
+    for (const uint32_t residual : residuals_) {
+        const uint32_t quotient = residual >> k;
+        if (quotient < RICE_ESCAPE) {
+            writer.put(((1U << quotient) - 1) << 1, static_cast<int>(quotient) + 1);
+            writer.put(residual & ((1U << k) - 1), k);
+        } else {
+            writer.put((1U << RICE_ESCAPE) - 1, RICE_ESCAPE);
+            writer.put(residual, RICE_ESCAPE_BITS);
+        }
+    }
+    writer.finish();
+
+    return keyframe;
+}
+
+void SweepEncoder::reset() {
+    previous_.clear();
+}
+
+bool SweepDecoder::decode(uint64_t start_hz, bool keyframe, std::span<const std::byte> in, float step_db,
+                          std::span<float> out) {
+    std::vector<int16_t>& reference = previous_[start_hz];
+    if (keyframe) {
+        reference.resize(out.size());
+    } else if (reference.size() != out.size()) {
+        return false;
+    }
+
+    if (in.empty()) {
+        return false;
+    }
+    const int k = static_cast<int>(in[0]);
+    if (k > RICE_MAX_K) {
+        return false;
+    }
+    BitReader reader(in.subspan(1));
+
+    int16_t neighbour = 0;
+    for (size_t i = 0; i < out.size(); ++i) {
+        int quotient = 0;
+        uint32_t residual = 0;
+        if (!reader.get_unary(RICE_ESCAPE, quotient)) {
+            return false;
+        }
+        if (quotient == RICE_ESCAPE) {
+            if (!reader.get(RICE_ESCAPE_BITS, residual)) {
+                return false;
+            }
+        } else {
+            uint32_t remainder = 0;
+            if (!reader.get(k, remainder)) {
+                return false;
+            }
+            residual = (static_cast<uint32_t>(quotient) << k) | remainder;
+        }
+
+        const int16_t prediction = keyframe ? neighbour : reference[i];
+        const auto level = static_cast<int16_t>(prediction + unzigzag(residual));
+        reference[i] = level;
+        neighbour = level;
+        out[i] = static_cast<float>(level) * step_db;
+    }
+    return true;
+}
+
+void SweepDecoder::reset() {
+    previous_.clear();
+}
@@ -0,0 +1,51 @@
+#include "sweep_csv.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+void append_band(std::string& out, const char* time_prefix, const FrequencyBand& band, const SweepConfig& config) {
+    if (band.power_db.empty()) {
+        return;
+    }
+
+    char field[64];
+    out += time_prefix;
+    std::snprintf(field, sizeof(field), ", %llu, %llu, %.2f, %d",
+                  static_cast<unsigned long long>(band.start_hz), static_cast<unsigned long long>(band.end_hz),
+                  config.bin_width_hz, config.fft_size);
+    out += field;
+
+    for (const float value : band.power_db) {
+        std::snprintf(field, sizeof(field), ", %.2f", value);
+        out += field;
+    }
+    out += '\n';
+}
+
+}  // namespace
+
+void append_sweep_csv(std::string& out, const FFTSweepData& data) {
+    if (!data.config) {
+        return;
+    }
+
+    using namespace std::chrono;
+    const sys_time<microseconds> time{microseconds(data.timestamp_us)};
+    const sys_days day = floor<days>(time);
+    const year_month_day date{day};
+    const hh_mm_ss<microseconds> clock{time - day};
+
+    char time_prefix[48];
+    std::snprintf(time_prefix, sizeof(time_prefix), "%04d-%02u-%02u, %02lld:%02lld:%02lld.%06lld",
+                  static_cast<int>(date.year()), static_cast<unsigned>(date.month()),
+                  static_cast<unsigned>(date.day()), static_cast<long long>(clock.hours().count()),
+                  static_cast<long long>(clock.minutes().count()), static_cast<long long>(clock.seconds().count()),
+                  static_cast<long long>(clock.subseconds().count()));
+
+    append_band(out, time_prefix, data.band_lower, *data.config);
+    append_band(out, time_prefix, data.band_upper, *data.config);
+}
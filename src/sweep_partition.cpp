@@ -0,0 +1,79 @@
+#include "sweep_partition.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+uint32_t range_steps(const ScanRange& range) {
+    return (range.end_mhz - range.start_mhz + SWEEP_TUNE_STEP_MHZ - 1) / SWEEP_TUNE_STEP_MHZ;
+}
+
+std::vector<ScanRange> merge_ranges(std::vector<ScanRange> ranges) {
+    std::sort(ranges.begin(), ranges.end(),
+              [](const ScanRange& a, const ScanRange& b) { return a.start_mhz < b.start_mhz; });
+
+    std::vector<ScanRange> merged;
+    for (const ScanRange& range : ranges) {
+        if (range.end_mhz <= range.start_mhz) {
+            continue;
+        }
+        if (!merged.empty() && range.start_mhz <= merged.back().end_mhz) {
+            merged.back().end_mhz = std::max(merged.back().end_mhz, range.end_mhz);
+        } else {
+            merged.push_back(range);
+        }
+    }
+    return merged;
+}
+
+}  // namespace
+
+uint32_t sweep_tune_steps(const std::vector<ScanRange>& ranges) {
+    uint32_t steps = 0;
+    for (const ScanRange& range : merge_ranges(ranges)) {
+        steps += range_steps(range);
+    }
+    return steps;
+}
+
+std::vector<std::vector<ScanRange>> partition_scan_ranges(const std::vector<ScanRange>& ranges, size_t devices) {
+    std::vector<std::vector<ScanRange>> partitions(devices);
+    if (devices == 0) {
+        return partitions;
+    }
+
+    const std::vector<ScanRange> merged = merge_ranges(ranges);
+    uint64_t total_steps = 0;
+    for (const ScanRange& range : merged) {
+        total_steps += range_steps(range);
+    }
+
+    // Device d takes steps [d * total / devices, (d + 1) * total / devices)
+    size_t device = 0;
+    uint64_t assigned = 0;
+    for (const ScanRange& range : merged) {
+        uint16_t start_mhz = range.start_mhz;
+
+        while (start_mhz < range.end_mhz) {
+            while (device + 1 < devices && assigned >= (device + 1) * total_steps / devices) {
+                ++device;
+            }
+
+            const uint64_t quota = (device + 1) * total_steps / devices - assigned;
+            const uint32_t remaining = range_steps({start_mhz, range.end_mhz});
+            const auto steps = static_cast<uint32_t>(std::min<uint64_t>(quota, remaining));
+
+            const uint16_t end_mhz = steps == remaining
+                                         ? range.end_mhz
+                                         : static_cast<uint16_t>(start_mhz + steps * SWEEP_TUNE_STEP_MHZ);
+            partitions[device].push_back({start_mhz, end_mhz});
+
+            assigned += steps;
+            start_mhz = end_mhz;
+        }
+    }
+    return partitions;
+}
@@ -0,0 +1,124 @@
+#include "sweep_queue.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+SweepQueue::SweepQueue(size_t capacity, OverflowPolicy policy, size_t bins_per_band)
+    : capacity_(capacity > 0 ? capacity : 1),
+      policy_(policy),
+      slots_(capacity_ + 1),
+      ready_(capacity_),
+      free_(capacity_ + 1) {
+    for (FFTSweepData& slot : slots_) {
+        slot.band_lower.power_db.reserve(bins_per_band);
+        slot.band_upper.power_db.reserve(bins_per_band);
+    }
+
+    for (size_t i = 0; i < free_.size(); ++i) {
+        free_[i].store(static_cast<uint32_t>(i), std::memory_order_relaxed);
+    }
+    free_tail_.store(free_.size(), std::memory_order_release);
+}
+
+bool SweepQueue::push(const FFTSweepData& data) {
+    uint32_t slot = 0;
+
+    const uint64_t tail = ready_tail_.load(std::memory_order_relaxed);
+    const uint64_t head = ready_head_.load(std::memory_order_acquire);
+
+    bool have_slot = false;
+    if (tail - head >= capacity_) {
+        if (policy_ == OverflowPolicy::DropNewest) {
+            dropped_newest_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        have_slot = steal_oldest(slot);
+    }
+
+    if (!have_slot && !pop_free(slot)) {
+        // Only reachable if the consumer is holding more than one slot,
+        // which drain() never does.
+        dropped_newest_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    slots_[slot] = data;
+
+    ready_[tail % capacity_].store(slot, std::memory_order_relaxed);
+    ready_tail_.store(tail + 1, std::memory_order_release);
+    pushed_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool SweepQueue::steal_oldest(uint32_t& slot) {
+    uint64_t head = ready_head_.load(std::memory_order_acquire);
+    const uint64_t tail = ready_tail_.load(std::memory_order_relaxed);
+
+    while (tail - head >= capacity_) {
+        const uint32_t candidate = ready_[head % capacity_].load(std::memory_order_relaxed);
+        if (ready_head_.compare_exchange_weak(head, head + 1,
+                                              std::memory_order_acq_rel,
+                                              std::memory_order_acquire)) {
+            slot = candidate;
+            dropped_oldest_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // The consumer freed a position while we were trying
+    return false;
+}
+
+bool SweepQueue::pop_ready(uint32_t& slot) {
+    uint64_t head = ready_head_.load(std::memory_order_acquire);
+
+    for (;;) {
+        const uint64_t tail = ready_tail_.load(std::memory_order_acquire);
+        if (head == tail) {
+            return false;
+        }
+
+        // Read the entry before claiming it: the producer cannot overwrite
+        // position head until ready_head_ has moved past it.
+        const uint32_t candidate = ready_[head % capacity_].load(std::memory_order_relaxed);
+        if (ready_head_.compare_exchange_weak(head, head + 1,
+                                              std::memory_order_acq_rel,
+                                              std::memory_order_acquire)) {
+            slot = candidate;
+            return true;
+        }
+    }
+}
+
+void SweepQueue::push_free(uint32_t slot) {
+    const uint64_t tail = free_tail_.load(std::memory_order_relaxed);
+    free_[tail % free_.size()].store(slot, std::memory_order_relaxed);
+    free_tail_.store(tail + 1, std::memory_order_release);
+}
+
+bool SweepQueue::pop_free(uint32_t& slot) {
+    const uint64_t head = free_head_.load(std::memory_order_relaxed);
+    if (head == free_tail_.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    slot = free_[head % free_.size()].load(std::memory_order_relaxed);
+    free_head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+size_t SweepQueue::size() const noexcept {
+    const uint64_t head = ready_head_.load(std::memory_order_acquire);
+    const uint64_t tail = ready_tail_.load(std::memory_order_acquire);
+    return static_cast<size_t>(tail - head);
+}
+
+SweepQueueStats SweepQueue::stats() const noexcept {
+    SweepQueueStats stats;
+    stats.pushed = pushed_.load(std::memory_order_relaxed);
+    stats.dropped_oldest = dropped_oldest_.load(std::memory_order_relaxed);
+    stats.dropped_newest = dropped_newest_.load(std::memory_order_relaxed);
+    return stats;
+}
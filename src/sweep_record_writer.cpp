@@ -0,0 +1,279 @@
+#include "sweep_record_writer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "sweep_record_format.hpp"
+
+using namespace sweep_record;
+
+constexpr uint64_t MHZ_TO_HZ = 1'000'000ULL;
+
+SweepRecordWriter::SweepRecordWriter() {
+    buffer_.reserve(RECORD_WRITER_BUFFER_BYTES);
+}
+
+SweepRecordWriter::~SweepRecordWriter() {
+    close();
+}
+
+bool SweepRecordWriter::open(const std::string& path, PowerEncoding encoding, float step_db) {
+    close();
+
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        std::cerr << "Failed to create recording: " << path << '\n';
+        return false;
+    }
+    // buffer_ already batches records; stdio would only copy them again
+    std::setvbuf(file_, nullptr, _IONBF, 0);
+
+    failed_ = false;
+    buffer_.clear();
+    flushed_bytes_ = 0;
+    encoding_ = encoding;
+    step_db_ = step_db > 0.0F ? step_db : RECORD_WRITER_DEFAULT_STEP_DB;
+    config_generation_ = 0;
+    config_offset_ = 0;
+    sweep_start_hz_ = 0;
+    chunk_bands_ = 0;
+    chunk_sweeps_ = 0;
+    last_timestamp_us_ = 0;
+    encoder_.reset();
+    index_.clear();
+    checkpointed_entries_ = 0;
+    previous_index_offset_ = 0;
+    chunk_dropped_blocks_ = 0;
+    footer_ = Footer{};
+    sample_bytes_ = 0;
+    raw_sample_bytes_ = 0;
+
+    FileHeader header{};
+    header.magic = FILE_MAGIC;
+    header.version = FORMAT_VERSION;
+    header.header_bytes = sizeof(FileHeader);
+    header.created_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::system_clock::now().time_since_epoch())
+                            .count();
+    append(&header, sizeof(header));
+    return true;
+}
+
+bool SweepRecordWriter::close() {
+    if (!file_) {
+        return false;
+    }
+
+    footer_.index_offset = bytes_written();
+    footer_.index_entries = index_.size();
+    footer_.magic = FOOTER_MAGIC;
+
+    write_index(0, index_.size(), footer_.index_offset, config_offset_, footer_.dropped_blocks);
+    append(&footer_, sizeof(footer_));
+    flush();
+
+    bool ok = !failed_;
+    if (std::fclose(file_) != 0) {
+        std::cerr << "Failed to close recording\n";
+        ok = false;
+    }
+    file_ = nullptr;
+    return ok;
+}
+
+void SweepRecordWriter::write_block(const FFTSweepData& data) {
+    if (!data.config) {
+        return;
+    }
+
+    const SweepConfig& config = *data.config;
+    if (config.generation != config_generation_) {
+        write_config(config);
+    }
+
+    for (const FrequencyBand* band : {&data.band_lower, &data.band_upper}) {
+        write_band(data.timestamp_us, band->start_hz, band->end_hz, config.bin_width_hz, band->power_db,
+                   band == &data.band_upper);
+    }
+}
+
+void SweepRecordWriter::write_config(const SweepConfig& config) {
+    const size_t range_bytes = config.freq_ranges_mhz.size() * sizeof(uint16_t);
+
+    config_offset_ = bytes_written();
+    config_generation_ = config.generation;
+    sweep_start_hz_ = config.freq_ranges_mhz.empty() ? 0 : config.freq_ranges_mhz.front() * MHZ_TO_HZ;
+
+    begin_record(RecordType::Config, sizeof(ConfigRecord) + range_bytes);
+
+    ConfigRecord record{};
+    record.generation = config.generation;
+    record.bin_width_hz = config.bin_width_hz;
+    record.fft_size = config.fft_size;
+    record.num_ranges = static_cast<uint32_t>(config.freq_ranges_mhz.size() / 2);
+    append(&record, sizeof(record));
+    append(config.freq_ranges_mhz.data(), range_bytes);
+    pad_to_alignment();
+}
+
+void SweepRecordWriter::write_band(int64_t timestamp_us, uint64_t start_hz, uint64_t end_hz, double bin_width_hz,
+                                   std::span<const float> power_db, bool upper) {
+    if (power_db.empty()) {
+        return;
+    }
+
+    // Each index entry starts an independent compression chunk, so playback
+    // can start decoding at any of them. Chunks only break where a sweep
+    // starts over; elsewhere the encoder would lose the previous sweep.
+    const uint64_t offset = bytes_written();
+    const bool sweep_starts = sweep_start_hz_ != 0 && start_hz == sweep_start_hz_;
+    if (sweep_starts) {
+        ++chunk_sweeps_;
+    }
+    const bool chunk_starts =
+        footer_.band_records == 0 ||
+        (sweep_starts && chunk_bands_ >= INDEX_STRIDE_BANDS && chunk_sweeps_ > INDEX_CHUNK_MIN_SWEEPS) ||
+        chunk_bands_ >= INDEX_MAX_CHUNK_BANDS;
+    if (chunk_starts) {
+        index_.push_back({timestamp_us, offset, config_offset_, start_hz, end_hz});
+        chunk_dropped_blocks_ = footer_.dropped_blocks;
+        encoder_.reset();
+        chunk_bands_ = 0;
+        chunk_sweeps_ = sweep_starts ? 1 : 0;
+    } else {
+        IndexEntry& entry = index_.back();
+        entry.min_start_hz = std::min(entry.min_start_hz, start_hz);
+        entry.max_end_hz = std::max(entry.max_end_hz, end_hz);
+    }
+
+    if (footer_.band_records == 0) {
+        footer_.first_timestamp_us = timestamp_us;
+    }
+    footer_.last_timestamp_us = timestamp_us;
+    ++footer_.band_records;
+    last_timestamp_us_ = timestamp_us;
+    ++chunk_bands_;
+
+    BandRecord record{};
+    record.timestamp_us = timestamp_us;
+    record.start_hz = start_hz;
+    record.end_hz = end_hz;
+    record.bin_width_hz = bin_width_hz;
+    record.num_bins = static_cast<uint32_t>(power_db.size());
+    record.encoding = static_cast<uint16_t>(encoding_);
+    record.flags = static_cast<uint16_t>((upper ? BAND_FLAG_UPPER : 0) | (chunk_starts ? BAND_FLAG_CHUNK_START : 0));
+    record.offset_db = 0.0F;
+    record.step_db = encoding_ == PowerEncoding::Float32 ? 0.0F : step_db_;
+
+    const void* samples = power_db.data();
+    size_t samples_bytes = power_db.size() * sizeof(float);
+
+    if (encoding_ == PowerEncoding::Int16) {
+        const float scale = 1.0F / step_db_;
+        quantized_.resize(power_db.size());
+        for (size_t i = 0; i < power_db.size(); ++i) {
+            const float level = std::nearbyint(power_db[i] * scale);
+            quantized_[i] = static_cast<int16_t>(std::clamp(level,
+                                                            static_cast<float>(std::numeric_limits<int16_t>::min()),
+                                                            static_cast<float>(std::numeric_limits<int16_t>::max())));
+        }
+        samples = quantized_.data();
+        samples_bytes = quantized_.size() * sizeof(int16_t);
+    } else if (encoding_ == PowerEncoding::RiceDelta) {
+        encoded_.clear();
+        if (encoder_.encode(start_hz, power_db, step_db_, encoded_)) {
+            record.flags |= BAND_FLAG_KEYFRAME;
+        }
+        samples = encoded_.data();
+        samples_bytes = encoded_.size();
+    }
+
+    begin_record(RecordType::Band, sizeof(BandRecord) + samples_bytes);
+    append(&record, sizeof(record));
+    append(samples, samples_bytes);
+    pad_to_alignment();
+
+    sample_bytes_ += samples_bytes;
+    raw_sample_bytes_ += power_db.size() * sizeof(float);
+}
+
+void SweepRecordWriter::write_drop(uint64_t dropped_blocks) {
+    begin_record(RecordType::Drop, sizeof(DropRecord));
+    const DropRecord record{last_timestamp_us_, dropped_blocks};
+    append(&record, sizeof(record));
+
+    footer_.dropped_blocks += dropped_blocks;
+}
+
+void SweepRecordWriter::checkpoint() {
+    // The newest entry's chunk is still open and its extent still growing,
+    // so recovery walks from its start instead
+    const uint64_t completed = index_.empty() ? 0 : index_.size() - 1;
+    if (completed > checkpointed_entries_) {
+        const IndexEntry& open_chunk = index_.back();
+        write_index(checkpointed_entries_, completed - checkpointed_entries_, open_chunk.offset,
+                    open_chunk.config_offset, chunk_dropped_blocks_);
+        checkpointed_entries_ = completed;
+    }
+    flush();
+}
+
+void SweepRecordWriter::write_index(uint64_t first_entry, uint64_t entries, uint64_t resume_offset,
+                                    uint64_t resume_config_offset, uint64_t dropped_blocks) {
+    const uint64_t offset = bytes_written();
+
+    IndexHeader header{};
+    header.magic = INDEX_MAGIC;
+    header.previous_offset = previous_index_offset_;
+    header.first_entry = first_entry;
+    header.entries = entries;
+    header.resume_offset = resume_offset;
+    header.resume_config_offset = resume_config_offset;
+    header.dropped_blocks = dropped_blocks;
+
+    begin_record(RecordType::Index, sizeof(IndexHeader) + entries * sizeof(IndexEntry));
+    append(&header, sizeof(header));
+    append(index_.data() + first_entry, entries * sizeof(IndexEntry));
+
+    previous_index_offset_ = offset;
+}
+
+void SweepRecordWriter::begin_record(RecordType type, size_t payload_bytes) {
+    const RecordHeader header{static_cast<uint32_t>(type), static_cast<uint32_t>(padded_size(payload_bytes))};
+    append(&header, sizeof(header));
+}
+
+void SweepRecordWriter::append(const void* data, size_t bytes) {
+    if (buffer_.size() + bytes > buffer_.capacity()) {
+        flush();
+    }
+    const auto* begin = static_cast<const char*>(data);
+    buffer_.insert(buffer_.end(), begin, begin + bytes);
+}
+
+void SweepRecordWriter::pad_to_alignment() {
+    const uint64_t offset = bytes_written();
+    buffer_.resize(buffer_.size() + (padded_size(offset) - offset), 0);
+}
+
+void SweepRecordWriter::flush() {
+    if (buffer_.empty() || !file_) {
+        return;
+    }
+
+    if (!failed_ && std::fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size()) {
+        std::cerr << "Failed to write recording, further blocks are discarded\n";
+        failed_ = true;
+    }
+
+    flushed_bytes_ += buffer_.size();
+    buffer_.clear();
+}
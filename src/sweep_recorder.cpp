@@ -0,0 +1,100 @@
+#include "sweep_recorder.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "pipeline_trace.hpp"
+#include "sweep_record_format.hpp"
+
+SweepRecorder::~SweepRecorder() {
+    stop();
+}
+
+bool SweepRecorder::start(const std::string& path, sweep_record::PowerEncoding encoding, float step_db) {
+    stop();
+
+    if (!writer_.open(path, encoding, step_db)) {
+        return false;
+    }
+
+    // Forget anything pushed after the previous recording stopped
+    queue_.drain([](const FFTSweepData&) {});
+
+    dropped_baseline_ = queue_.stats().dropped();
+    blocks_written_.store(0, std::memory_order_relaxed);
+    dropped_blocks_.store(0, std::memory_order_relaxed);
+    publish_stats();
+
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&SweepRecorder::run, this);
+    recording_.store(true, std::memory_order_release);
+    return true;
+}
+
+void SweepRecorder::stop() {
+    recording_.store(false, std::memory_order_release);
+    running_.store(false, std::memory_order_release);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+SweepRecorderStats SweepRecorder::stats() const noexcept {
+    SweepRecorderStats stats;
+    stats.blocks = blocks_written_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_blocks_.load(std::memory_order_relaxed);
+    stats.bytes = bytes_written_.load(std::memory_order_relaxed);
+    stats.sample_bytes = sample_bytes_.load(std::memory_order_relaxed);
+    stats.raw_sample_bytes = raw_sample_bytes_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void SweepRecorder::run() {
+    pipeline_trace_set_thread_name("sweep recorder");
+
+    auto last_flush = std::chrono::steady_clock::now();
+
+    while (running_.load(std::memory_order_acquire)) {
+        const size_t drained = drain_to_writer();
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now - last_flush >= std::chrono::milliseconds(RECORDER_FLUSH_INTERVAL_MS)) {
+            writer_.checkpoint();
+            last_flush = now;
+        }
+
+        if (drained == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(RECORDER_IDLE_SLEEP_MS));
+        }
+    }
+
+    drain_to_writer();
+    writer_.close();
+    publish_stats();
+}
+
+size_t SweepRecorder::drain_to_writer() {
+    PIPELINE_TRACE_SCOPE("write recording");
+
+    const size_t drained = queue_.drain([this](const FFTSweepData& data) { writer_.write_block(data); },
+                                        queue_.capacity());
+    blocks_written_.fetch_add(drained, std::memory_order_relaxed);
+
+    const uint64_t dropped = queue_.stats().dropped();
+    if (dropped != dropped_baseline_) {
+        writer_.write_drop(dropped - dropped_baseline_);
+        dropped_blocks_.fetch_add(dropped - dropped_baseline_, std::memory_order_relaxed);
+        dropped_baseline_ = dropped;
+    }
+
+    publish_stats();
+    return drained;
+}
+
+void SweepRecorder::publish_stats() {
+    bytes_written_.store(writer_.bytes_written(), std::memory_order_relaxed);
+    sample_bytes_.store(writer_.sample_bytes(), std::memory_order_relaxed);
+    raw_sample_bytes_.store(writer_.raw_sample_bytes(), std::memory_order_relaxed);
+}
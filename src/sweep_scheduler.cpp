@@ -0,0 +1,429 @@
+#include "sweep_scheduler.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "hackrf_controller.hpp"
+#include "hackrf_gain_state.hpp"
+#include "sweep_partition.hpp"
+
+constexpr uint64_t MHZ_TO_HZ = 1'000'000ULL;
+
+namespace {
+
+// Every hackrf_sweeper tuning step delivers two blocks
+constexpr double BLOCKS_PER_STEP = 2.0;
+
+double tighter_target(double a, double b) {
+    if (a <= 0.0) {
+        return b;
+    }
+    if (b <= 0.0) {
+        return a;
+    }
+    return std::min(a, b);
+}
+
+std::vector<ScheduledRange> merge_scheduled(std::vector<ScheduledRange> ranges) {
+    std::sort(ranges.begin(), ranges.end(), [](const ScheduledRange& a, const ScheduledRange& b) {
+        return a.range.start_mhz < b.range.start_mhz;
+    });
+
+    std::vector<ScheduledRange> merged;
+    for (const ScheduledRange& range : ranges) {
+        if (range.range.end_mhz <= range.range.start_mhz) {
+            continue;
+        }
+        if (!merged.empty() && range.range.start_mhz < merged.back().range.end_mhz) {
+            merged.back().range.end_mhz = std::max(merged.back().range.end_mhz, range.range.end_mhz);
+            merged.back().revisit_s = tighter_target(merged.back().revisit_s, range.revisit_s);
+        } else {
+            merged.push_back(range);
+        }
+    }
+    return merged;
+}
+
+std::vector<ScanRange> build_entries(const std::vector<ScheduledRange>& ranges, const std::vector<bool>& fast,
+                                     size_t slots) {
+    std::vector<ScanRange> entries;
+    if (slots <= 1) {
+        for (const ScheduledRange& range : ranges) {
+            entries.push_back(range.range);
+        }
+        return entries;
+    }
+
+    std::vector<ScanRange> background;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        if (!fast[i]) {
+            background.push_back(ranges[i].range);
+        }
+    }
+
+    const std::vector<std::vector<ScanRange>> chunks = partition_scan_ranges(background, slots);
+    for (const std::vector<ScanRange>& chunk : chunks) {
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            if (fast[i]) {
+                entries.push_back(ranges[i].range);
+            }
+        }
+        entries.insert(entries.end(), chunk.begin(), chunk.end());
+    }
+    return entries;
+}
+
+}  // namespace
+
+SweepPlan plan_sweep_schedule(const std::vector<ScheduledRange>& ranges, double steps_per_second,
+                              size_t max_entries) {
+    SweepPlan plan;
+    plan.ranges = merge_scheduled(ranges);
+
+    const double rate = steps_per_second > 0.0 ? steps_per_second : SCHEDULER_DEFAULT_STEPS_PER_SECOND;
+    const size_t count = plan.ranges.size();
+
+    std::vector<uint32_t> steps(count);
+    uint32_t total_steps = 0;
+    for (size_t i = 0; i < count; ++i) {
+        steps[i] = sweep_tune_steps({plan.ranges[i].range});
+        total_steps += steps[i];
+    }
+
+    // Ranges whose target a plain pass already meets stay in the background
+    std::vector<bool> fast(count);
+    const double pass_s = total_steps / rate;
+    for (size_t i = 0; i < count; ++i) {
+        fast[i] = plan.ranges[i].revisit_s > 0.0 && plan.ranges[i].revisit_s < pass_s;
+    }
+
+    uint32_t cycle_steps = total_steps;
+    uint32_t fast_steps = 0;
+    for (size_t round = 0; round <= count; ++round) {
+        size_t fast_count = 0;
+        fast_steps = 0;
+        double tightest_s = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            if (fast[i]) {
+                ++fast_count;
+                fast_steps += steps[i];
+                tightest_s = tighter_target(tightest_s, plan.ranges[i].revisit_s);
+            }
+        }
+
+        // More slots revisit the fast ranges sooner but cost list entries:
+        // take the fewest that meet the tightest target, or as many as fit
+        const uint32_t background_steps = total_steps - fast_steps;
+        plan.slots = 1;
+        if (fast_count > 0 && background_steps > 0) {
+            for (size_t slots = 2; slots <= background_steps; ++slots) {
+                if (build_entries(plan.ranges, fast, slots).size() > max_entries) {
+                    break;
+                }
+                plan.slots = slots;
+                if ((fast_steps + static_cast<double>(background_steps) / slots) / rate <= tightest_s) {
+                    break;
+                }
+            }
+        }
+        cycle_steps = static_cast<uint32_t>(plan.slots) * fast_steps + background_steps;
+
+        // A longer cycle may now miss a background range's own target
+        bool promoted = false;
+        for (size_t i = 0; i < count && fast_count + 1 < max_entries; ++i) {
+            if (!fast[i] && plan.ranges[i].revisit_s > 0.0 && cycle_steps / rate > plan.ranges[i].revisit_s) {
+                fast[i] = true;
+                promoted = true;
+                break;
+            }
+        }
+        if (!promoted) {
+            break;
+        }
+    }
+
+    plan.entries = build_entries(plan.ranges, fast, plan.slots);
+
+    for (size_t i = 0; i < count; ++i) {
+        const bool repeated = plan.slots > 1 && fast[i];
+        plan.expected_revisit_s.push_back(cycle_steps / rate / (repeated ? static_cast<double>(plan.slots) : 1.0));
+    }
+    return plan;
+}
+
+SweepScheduler::SweepScheduler(std::unique_ptr<SpectrumSource> source) : source_(std::move(source)) {
+    source_->set_fft_callback([this](const FFTSweepData& data) { process_block(data); });
+}
+
+SweepScheduler::~SweepScheduler() {
+    source_->stop_sweep();
+    source_->set_fft_callback(nullptr);
+}
+
+SpectrumSource& SweepScheduler::source() const {
+    return *source_;
+}
+
+bool SweepScheduler::set_schedule(const std::vector<ScheduledRange>& ranges) {
+    if (ranges.empty()) {
+        std::cerr << "At least one scan range is required\n";
+        return false;
+    }
+
+    const double steps_per_second = measured_steps_per_second();
+    std::lock_guard<std::mutex> lock(mutex_);
+    return apply_plan(ranges, steps_per_second);
+}
+
+SweepPlan SweepScheduler::get_plan() const {
+    return state_.load()->plan;
+}
+
+bool SweepScheduler::replan() {
+    const double steps_per_second = measured_steps_per_second();
+    const std::vector<ScheduledRange> ranges = state_.load()->plan.ranges;
+    if (ranges.empty() || steps_per_second <= 0.0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return apply_plan(ranges, steps_per_second);
+}
+
+bool SweepScheduler::apply_plan(const std::vector<ScheduledRange>& ranges, double steps_per_second) {
+    SweepPlan plan = plan_sweep_schedule(ranges, steps_per_second, MAX_SWEEP_RANGES);
+
+    const bool live = source_->applies_scan_ranges_live();
+    const uint64_t stale_config_generation = seen_config_generation_.load(std::memory_order_acquire);
+    if (!source_->set_scan_ranges(plan.entries)) {
+        return false;
+    }
+
+    // hackrf_sweeper hands the list to the firmware only when a sweep
+    // starts, so a running device keeps sweeping the old one until then.
+    // Once the restart has returned, every block comes from the new list.
+    if (!live && sweeping_) {
+        source_->restart_sweep();
+    }
+
+    std::vector<uint64_t> range_starts_hz;
+    for (const ScheduledRange& range : plan.ranges) {
+        range_starts_hz.push_back(range.range.start_mhz * MHZ_TO_HZ);
+    }
+    auto counters = std::make_shared<SweepPlanCounters>(plan.ranges.size());
+
+    state_.update([&](SweepSchedulerState& next) {
+        next.plan = std::move(plan);
+        next.range_starts_hz = std::move(range_starts_hz);
+        next.counters = std::move(counters);
+        next.awaits_config = live;
+        next.stale_config_generation = stale_config_generation;
+    });
+    return true;
+}
+
+double SweepScheduler::measured_steps_per_second() const {
+    const std::shared_ptr<SweepPlanCounters> counters = state_.load()->counters;
+    if (!counters) {
+        return 0.0;
+    }
+
+    const uint64_t blocks = counters->blocks.load(std::memory_order_relaxed);
+    const int64_t first_us = counters->first_block_us.load(std::memory_order_relaxed);
+    const int64_t last_us = counters->last_block_us.load(std::memory_order_relaxed);
+    if (blocks < 2 || last_us <= first_us) {
+        return 0.0;
+    }
+    return static_cast<double>(blocks - 1) / BLOCKS_PER_STEP / (static_cast<double>(last_us - first_us) / 1e6);
+}
+
+std::vector<RangeRevisit> SweepScheduler::revisit_report() const {
+    const std::shared_ptr<const SweepSchedulerState> state = state_.load();
+    const SweepPlan& plan = state->plan;
+
+    std::vector<RangeRevisit> report(plan.ranges.size());
+    for (size_t i = 0; i < report.size(); ++i) {
+        const RangeVisitCounter& counter = state->counters->visits[i];
+        const uint64_t visits = counter.visits.load(std::memory_order_relaxed);
+        const int64_t first_us = counter.first_us.load(std::memory_order_relaxed);
+        const int64_t last_us = counter.last_us.load(std::memory_order_relaxed);
+
+        report[i].target = plan.ranges[i];
+        report[i].expected_s = plan.expected_revisit_s[i];
+        report[i].visits = visits;
+        if (visits > 1) {
+            report[i].achieved_s = static_cast<double>(last_us - first_us) / 1e6 / static_cast<double>(visits - 1);
+        }
+    }
+    return report;
+}
+
+// A new plan takes over from the first block swept from its list; until
+// then blocks are counted and described under the previous one
+void SweepScheduler::refresh_block_state(const FFTSweepData& data) {
+    if (!block_state_ || state_.generation() != block_generation_) {
+        block_state_ = state_.load();
+        block_generation_ = block_state_->generation;
+    }
+
+    if (block_state_->counters == (block_plan_ ? block_plan_->counters : nullptr)) {
+        return;
+    }
+    if (block_state_->awaits_config &&
+        (!data.config || data.config->generation == block_state_->stale_config_generation)) {
+        return;
+    }
+    block_plan_ = block_state_;
+    source_config_.reset();
+}
+
+void SweepScheduler::process_block(const FFTSweepData& data) {
+    if (data.config) {
+        seen_config_generation_.store(data.config->generation, std::memory_order_release);
+    }
+    refresh_block_state(data);
+
+    if (block_plan_) {
+        SweepPlanCounters& counters = *block_plan_->counters;
+        if (counters.blocks.fetch_add(1, std::memory_order_relaxed) == 0) {
+            counters.first_block_us.store(data.timestamp_us, std::memory_order_relaxed);
+        }
+        counters.last_block_us.store(data.timestamp_us, std::memory_order_relaxed);
+
+        // A visit starts with the first block of the range's first step
+        const std::vector<uint64_t>& range_starts_hz = block_plan_->range_starts_hz;
+        for (size_t i = 0; i < range_starts_hz.size(); ++i) {
+            if (data.band_lower.start_hz == range_starts_hz[i]) {
+                RangeVisitCounter& counter = counters.visits[i];
+                if (counter.visits.fetch_add(1, std::memory_order_relaxed) == 0) {
+                    counter.first_us.store(data.timestamp_us, std::memory_order_relaxed);
+                }
+                counter.last_us.store(data.timestamp_us, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Describe the plain ranges, widened as the device widens them, rather
+    // than the list with its repeats and chunks
+    if (data.config != source_config_ && data.config) {
+        source_config_ = data.config;
+
+        std::vector<ScanRange> ranges;
+        if (block_plan_) {
+            for (const ScheduledRange& range : block_plan_->plan.ranges) {
+                const uint32_t steps = sweep_tune_steps({range.range});
+                ranges.push_back({range.range.start_mhz,
+                                  static_cast<uint16_t>(range.range.start_mhz + steps * SWEEP_TUNE_STEP_MHZ)});
+            }
+        }
+
+        auto config = std::make_shared<SweepConfig>();
+        config->generation = ++config_generation_;
+        config->bin_width_hz = data.config->bin_width_hz;
+        config->fft_size = data.config->fft_size;
+        for (const ScanRange& range : ranges) {
+            if (!config->freq_ranges_mhz.empty() && range.start_mhz <= config->freq_ranges_mhz.back()) {
+                config->freq_ranges_mhz.back() = std::max(config->freq_ranges_mhz.back(), range.end_mhz);
+            } else {
+                config->freq_ranges_mhz.push_back(range.start_mhz);
+                config->freq_ranges_mhz.push_back(range.end_mhz);
+            }
+        }
+        block_.config = ranges.empty() ? data.config : std::move(config);
+    }
+
+    if (!block_state_->fft_callback) {
+        return;
+    }
+
+    block_.timestamp_us = data.timestamp_us;
+    block_.capture_ns = data.capture_ns;
+    block_.band_lower = data.band_lower;
+    block_.band_upper = data.band_upper;
+    block_state_->fft_callback(block_);
+}
+
+bool SweepScheduler::is_connected() const {
+    return source_->is_connected();
+}
+
+bool SweepScheduler::connect_device() {
+    return source_->connect_device();
+}
+
+void SweepScheduler::start_sweep() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    source_->start_sweep();
+    sweeping_ = true;
+}
+
+void SweepScheduler::stop_sweep() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    source_->stop_sweep();
+    sweeping_ = false;
+}
+
+void SweepScheduler::restart_sweep() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    source_->restart_sweep();
+    sweeping_ = true;
+}
+
+void SweepScheduler::set_gain_state(const HackRFGainState& state) {
+    source_->set_gain_state(state);
+}
+
+HackRFGainState SweepScheduler::get_gain_state() const {
+    return source_->get_gain_state();
+}
+
+void SweepScheduler::set_amp_enable(bool enable) noexcept {
+    source_->set_amp_enable(enable);
+}
+
+void SweepScheduler::set_vga_gain(int gain) {
+    source_->set_vga_gain(gain);
+}
+
+void SweepScheduler::set_lna_gain(int gain) {
+    source_->set_lna_gain(gain);
+}
+
+void SweepScheduler::set_fft_callback(FFTCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    state_.update([&callback](SweepSchedulerState& next) { next.fft_callback = std::move(callback); });
+}
+
+bool SweepScheduler::set_scan_ranges(const std::vector<ScanRange>& ranges) {
+    const std::shared_ptr<const SweepSchedulerState> state = state_.load();
+    const std::vector<ScheduledRange>& current = state->plan.ranges;
+
+    std::vector<ScheduledRange> scheduled;
+    for (const ScanRange& range : ranges) {
+        // Ranges that survive an edit keep their target
+        const auto kept = std::find_if(current.begin(), current.end(), [&range](const ScheduledRange& s) {
+            return s.range.start_mhz == range.start_mhz && s.range.end_mhz == range.end_mhz;
+        });
+        scheduled.push_back({range, kept != current.end() ? kept->revisit_s : 0.0});
+    }
+
+    return set_schedule(scheduled);
+}
+
+std::vector<ScanRange> SweepScheduler::get_scan_ranges() const {
+    std::vector<ScanRange> ranges;
+    for (const ScheduledRange& range : state_.load()->plan.ranges) {
+        ranges.push_back(range.range);
+    }
+    return ranges;
+}
+
+bool SweepScheduler::applies_scan_ranges_live() const {
+    return true;
+}
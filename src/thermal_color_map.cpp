@@ -4,6 +4,10 @@
 #include <qwt_plot_curve.h>
 #include <qwt_plot_spectrogram.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <span>
 #include <thermal_color_map.hpp>
 
 ThermalColorMap::ThermalColorMap() {
@@ -271,6 +275,30 @@ ThermalColorMap::ThermalColorMap() {
         double pos = static_cast<double>(i) / (nStops - 1);
         addColorStop(pos, colors[i]);
     }
+
+    // Bake the interpolated palette once so per-pixel lookups skip the
+    // colour stop search and interpolation in QwtLinearColorMap::rgb.
+    const QwtInterval unit(0.0, 1.0);
+    for (int i = 0; i < THERMAL_LUT_SIZE; ++i) {
+        lut_[i] = QwtLinearColorMap::rgb(unit, static_cast<double>(i) / (THERMAL_LUT_SIZE - 1));
+    }
+}
+
+template <typename T>
+void colorize_values(const std::array<QRgb, THERMAL_LUT_SIZE>& lut,
+                     const QwtInterval& interval,
+                     std::span<const T> values,
+                     QRgb* out) {
+    const double width = interval.width();
+    const T min = static_cast<T>(interval.minValue());
+    const T scale = static_cast<T>(width > 0.0 ? (THERMAL_LUT_SIZE - 1) / width : 0.0);
+    constexpr T max_index = static_cast<T>(THERMAL_LUT_SIZE - 1);
+
+    for (size_t i = 0; i < values.size(); ++i) {
+        // std::max(0, NaN) yields 0, so NaNs map to the lowest colour
+        const T position = std::min(std::max(T(0), (values[i] - min) * scale), max_index);
+        out[i] = lut[static_cast<int>(position + T(0.5))];
+    }
 }
 
 QRgb ThermalColorMap::rgb(const QwtInterval& interval, double value) const {
@@ -278,5 +306,15 @@ QRgb ThermalColorMap::rgb(const QwtInterval& interval, double value) const {
         return qRgb(0, 0, 0);
     }
 
-    return QwtLinearColorMap::rgb(interval, value);
+    QRgb color = 0;
+    colorize_values(lut_, interval, std::span<const double>(&value, 1), &color);
+    return color;
+}
+
+void ThermalColorMap::colorize(const QwtInterval& interval, std::span<const float> values, QRgb* out) const {
+    colorize_values(lut_, interval, values, out);
+}
+
+void ThermalColorMap::colorize(const QwtInterval& interval, std::span<const double> values, QRgb* out) const {
+    colorize_values(lut_, interval, values, out);
 }
@@ -0,0 +1,209 @@
+#include "trace_kernels.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// The kernels are written against GCC/Clang vector extensions rather than
+// one intrinsic set per ISA: the same source lowers to AVX2, SSE2 or NEON
+// and does not depend on the optimizer's loop vectorizer, which stays off
+// at -O2 for loops like these.
+#if defined(__x86_64__)
+#define TRACE_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define TRACE_KERNEL
+#endif
+
+#define TRACE_INLINE inline __attribute__((always_inline))
+
+// Vector-typed helpers below are always inlined, so the ABI note GCC
+// attaches to them for the baseline target does not apply
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace {
+
+constexpr size_t LANES = 8;
+
+using FloatLanes = float __attribute__((vector_size(LANES * sizeof(float))));
+using IntLanes = int32_t __attribute__((vector_size(LANES * sizeof(int32_t))));
+
+constexpr float DB_TO_LOG2 = 0.332192809F;  // log2(10) / 10
+constexpr float LOG2_TO_DB = 3.01029996F;   // 10 / log2(10)
+
+// Floor of the exponent range; -126 * LOG2_TO_DB dB is far below any real bin
+constexpr float MIN_LOG2 = -126.0F;
+constexpr float MAX_LOG2 = 127.0F;
+
+// One block of LANES bins. The tail of a span is staged through a zeroed
+// block so every update runs the same vector code.
+struct Lanes {
+    FloatLanes trace;
+    FloatLanes linear;
+    IntLanes hits;
+    FloatLanes input;
+};
+
+TRACE_INLINE FloatLanes splat(float value) {
+    return FloatLanes{} + value;
+}
+
+TRACE_INLINE IntLanes splat(int32_t value) {
+    return IntLanes{} + value;
+}
+
+// 2^x to 2e-7 relative: integer part straight into the exponent field,
+// fractional part from a degree 5 fit on [0, 1)
+TRACE_INLINE FloatLanes fast_exp2(const FloatLanes& value) {
+    FloatLanes x = value < MIN_LOG2 ? splat(MIN_LOG2) : value;
+    x = x > MAX_LOG2 ? splat(MAX_LOG2) : x;
+
+    // Offset to keep the conversion's truncation a floor
+    const FloatLanes shifted = x - MIN_LOG2;
+    const IntLanes whole = __builtin_convertvector(shifted, IntLanes);
+    const FloatLanes f = shifted - __builtin_convertvector(whole, FloatLanes);
+
+    const FloatLanes p = 0.999999898F +
+                         f * (0.69315449F + f * (0.240141818F + f * (0.0558603371F +
+                                                                     f * (0.00894959042F + f * 0.00189375406F))));
+    const auto scale = std::bit_cast<FloatLanes>((whole + 1) << 23);  // 2^(whole - 126)
+    return p * scale;
+}
+
+// log2(x) for normal positive x to 3e-6 absolute: exponent field plus a
+// degree 6 fit of log2(1 + m) on the mantissa
+TRACE_INLINE FloatLanes fast_log2(const FloatLanes& x) {
+    const auto bits = std::bit_cast<IntLanes>(x);
+    const FloatLanes exponent = __builtin_convertvector((bits >> 23) - 127, FloatLanes);
+    const FloatLanes m = std::bit_cast<FloatLanes>((bits & 0x007FFFFF) | 0x3F800000) - 1.0F;
+
+    const FloatLanes p = 2.44343872e-06F +
+                         m * (1.44245353F + m * (-0.71731278F + m * (0.454508492F + m * (-0.272697565F +
+                                                                                      m * (0.117613084F +
+                                                                                           m * -0.0245685347F)))));
+    return exponent + p;
+}
+
+template <typename T>
+TRACE_INLINE T load(const void* source) {
+    T value;
+    std::memcpy(&value, source, sizeof(value));
+    return value;
+}
+
+template <typename T>
+TRACE_INLINE void store(void* target, const T& value) {
+    std::memcpy(target, &value, sizeof(value));
+}
+
+// Runs `step` over every block of [0, count); `linear` may be null for
+// kernels that do not use it
+template <typename Step>
+TRACE_INLINE void for_each_block(float* trace, float* linear, uint32_t* hits, const float* input, size_t count,
+                                 Step step) {
+    Lanes lanes{};
+
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        lanes.trace = load<FloatLanes>(trace + i);
+        lanes.hits = load<IntLanes>(hits + i);
+        lanes.input = load<FloatLanes>(input + i);
+        if (linear != nullptr) {
+            lanes.linear = load<FloatLanes>(linear + i);
+        }
+
+        step(lanes);
+
+        store(trace + i, lanes.trace);
+        store(hits + i, lanes.hits);
+        if (linear != nullptr) {
+            store(linear + i, lanes.linear);
+        }
+    }
+
+    const size_t rest = count - i;
+    if (rest == 0) {
+        return;
+    }
+
+    lanes = Lanes{};
+    std::memcpy(&lanes.trace, trace + i, rest * sizeof(float));
+    std::memcpy(&lanes.hits, hits + i, rest * sizeof(uint32_t));
+    std::memcpy(&lanes.input, input + i, rest * sizeof(float));
+    if (linear != nullptr) {
+        std::memcpy(&lanes.linear, linear + i, rest * sizeof(float));
+    }
+
+    step(lanes);
+
+    std::memcpy(trace + i, &lanes.trace, rest * sizeof(float));
+    std::memcpy(hits + i, &lanes.hits, rest * sizeof(uint32_t));
+    if (linear != nullptr) {
+        std::memcpy(linear + i, &lanes.linear, rest * sizeof(float));
+    }
+}
+
+}  // namespace
+
+TRACE_KERNEL
+void trace_max_hold(float* trace, uint32_t* hits, const float* input, size_t count, float decay_db) {
+    for_each_block(trace, nullptr, hits, input, count, [decay_db](Lanes& lanes) {
+        const FloatLanes held = lanes.trace - decay_db;
+        const FloatLanes value = lanes.input > held ? lanes.input : held;
+        lanes.trace = lanes.hits == 0 ? lanes.input : value;
+        lanes.hits = splat(1);
+    });
+}
+
+TRACE_KERNEL
+void trace_min_hold(float* trace, uint32_t* hits, const float* input, size_t count, float decay_db) {
+    for_each_block(trace, nullptr, hits, input, count, [decay_db](Lanes& lanes) {
+        const FloatLanes held = lanes.trace + decay_db;
+        const FloatLanes value = lanes.input < held ? lanes.input : held;
+        lanes.trace = lanes.hits == 0 ? lanes.input : value;
+        lanes.hits = splat(1);
+    });
+}
+
+TRACE_KERNEL
+void trace_average(float* trace, float* linear, uint32_t* hits, const float* input, size_t count,
+                   uint32_t average_count) {
+    const auto limit = static_cast<int32_t>(average_count > 0 ? average_count : 1);
+
+    for_each_block(trace, linear, hits, input, count, [limit](Lanes& lanes) {
+        const IntLanes n = lanes.hits < limit ? lanes.hits + 1 : splat(limit);
+        const FloatLanes power = fast_exp2(lanes.input * DB_TO_LOG2);
+
+        // With n == 1 this overwrites whatever was left from before a reset
+        lanes.linear += (power - lanes.linear) / __builtin_convertvector(n, FloatLanes);
+        lanes.hits = n;
+        lanes.trace = fast_log2(lanes.linear) * LOG2_TO_DB;
+    });
+}
+
+TRACE_KERNEL
+void power_db_to_linear(const float* power_db, float* linear, size_t count) {
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        store(linear + i, fast_exp2(load<FloatLanes>(power_db + i) * DB_TO_LOG2));
+    }
+
+    if (i < count) {
+        FloatLanes tail{};
+        std::memcpy(&tail, power_db + i, (count - i) * sizeof(float));
+        tail = fast_exp2(tail * DB_TO_LOG2);
+        std::memcpy(linear + i, &tail, (count - i) * sizeof(float));
+    }
+}
+
+const char* trace_kernel_target() {
+#if defined(__x86_64__)
+    return __builtin_cpu_supports("avx2") ? "avx2" : "sse2";
+#elif defined(__aarch64__)
+    return "neon";
+#else
+    return "generic";
+#endif
+}
@@ -0,0 +1,76 @@
+#include "trace_processor.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "dataset_spectrum.hpp"
+#include "trace_kernels.hpp"
+
+TraceProcessor::TraceProcessor(TraceKind kind, size_t num_bins)
+    : kind_(kind), values_(num_bins, SPECTRUM_NO_DATA_DB), hits_(num_bins, 0) {
+    if (kind_ == TraceKind::Average) {
+        linear_.assign(num_bins, 0.0F);
+    }
+    decimator_.reset(values_);
+}
+
+void TraceProcessor::update(size_t first_bin, std::span<const float> power_db) {
+    if (power_db.empty() || first_bin + power_db.size() > values_.size()) {
+        return;
+    }
+
+    float* values = values_.data() + first_bin;
+    uint32_t* hits = hits_.data() + first_bin;
+
+    switch (kind_) {
+        case TraceKind::MaxHold:
+            trace_max_hold(values, hits, power_db.data(), power_db.size(), decay_db_);
+            break;
+        case TraceKind::MinHold:
+            trace_min_hold(values, hits, power_db.data(), power_db.size(), decay_db_);
+            break;
+        case TraceKind::Average:
+            trace_average(values, linear_.data() + first_bin, hits, power_db.data(), power_db.size(),
+                          average_count_);
+            break;
+    }
+
+    decimator_.update(values_, first_bin, power_db.size());
+}
+
+void TraceProcessor::reset() {
+    // The kernels treat a bin without hits as empty, so the linear
+    // accumulator can keep its stale contents
+    std::fill(values_.begin(), values_.end(), SPECTRUM_NO_DATA_DB);
+    std::fill(hits_.begin(), hits_.end(), 0);
+    decimator_.reset(values_);
+}
+
+void TraceProcessor::remap(const std::vector<BinRun>& runs, size_t num_bins) {
+    remap_bins(values_, runs, num_bins, SPECTRUM_NO_DATA_DB);
+    remap_bins(hits_, runs, num_bins, uint32_t{0});
+    if (kind_ == TraceKind::Average) {
+        remap_bins(linear_, runs, num_bins, 0.0F);
+    }
+    decimator_.reset(values_);
+}
+
+void TraceProcessor::set_decay_db(float decay_db) noexcept {
+    decay_db_ = std::max(decay_db, 0.0F);
+}
+
+void TraceProcessor::set_average_count(uint32_t count) noexcept {
+    average_count_ = std::max<uint32_t>(count, 1);
+
+    // Bins past the new count carry on from their current average
+    for (uint32_t& hits : hits_) {
+        hits = std::min(hits, average_count_);
+    }
+}
+
+MinMax TraceProcessor::get_min_max(size_t first_bin, size_t last_bin) const {
+    return decimator_.range(values_, first_bin, last_bin);
+}
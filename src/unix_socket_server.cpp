@@ -0,0 +1,111 @@
+#include "unix_socket_server.hpp"
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+UnixSocketServer::~UnixSocketServer() {
+    close();
+}
+
+bool UnixSocketServer::listen(const std::string& path) {
+    close();
+
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path too long: " << path << '\n';
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "Failed to create socket: " << std::strerror(errno) << '\n';
+        return false;
+    }
+
+    ::unlink(path.c_str());  // Left behind by a previous run
+    if (::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listen_fd_, SOMAXCONN) != 0) {
+        std::cerr << "Failed to listen on " << path << ": " << std::strerror(errno) << '\n';
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    path_ = path;
+    return true;
+}
+
+void UnixSocketServer::close() {
+    for (const Client& client : clients_) {
+        ::close(client.fd);
+    }
+    clients_.clear();
+
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        ::unlink(path_.c_str());
+        listen_fd_ = -1;
+    }
+}
+
+void UnixSocketServer::accept_pending() {
+    if (listen_fd_ < 0) {
+        return;
+    }
+
+    for (;;) {
+        const int client = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client < 0) {
+            return;
+        }
+        clients_.push_back({client, {}});
+    }
+}
+
+void UnixSocketServer::broadcast(std::string_view data) {
+    for (size_t i = 0; i < clients_.size();) {
+        Client& client = clients_[i];
+        client.backlog.append(data);
+        if (send_backlog(client) && client.backlog.size() <= SOCKET_CLIENT_MAX_BACKLOG_BYTES) {
+            ++i;
+            continue;
+        }
+
+        // Gone, or so far behind that it would never catch up
+        ::close(client.fd);
+        clients_[i] = std::move(clients_.back());
+        clients_.pop_back();
+        ++dropped_clients_;
+    }
+}
+
+// Sends as much of the backlog as the socket takes; false on a hard error
+bool UnixSocketServer::send_backlog(Client& client) {
+    size_t sent_total = 0;
+    while (sent_total < client.backlog.size()) {
+        const ssize_t sent = ::send(client.fd, client.backlog.data() + sent_total, client.backlog.size() - sent_total,
+                                    MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent > 0) {
+            sent_total += static_cast<size_t>(sent);
+        } else if (sent < 0 && errno == EINTR) {
+            continue;
+        } else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            return false;
+        }
+    }
+    client.backlog.erase(0, sent_total);
+    return true;
+}
@@ -0,0 +1,72 @@
+#include "usb_hotplug.hpp"
+
+#include <libhackrf/hackrf.h>
+#include <libusb-1.0/libusb.h>
+
+#include <iostream>
+#include <thread>
+
+UsbHotplugMonitor::UsbHotplugMonitor(DeviceCommandWorker* commands) : commands_(commands) {}
+
+UsbHotplugMonitor::~UsbHotplugMonitor() {
+    stop();
+}
+
+bool UsbHotplugMonitor::start() {
+    stop();
+
+    int rc = libusb_init(&context_);
+    if (rc != LIBUSB_SUCCESS) {
+        std::cerr << "Failed to initialize libusb: " << rc << "\n";
+        context_ = nullptr;
+        return false;
+    }
+
+    rc = libusb_hotplug_register_callback(
+        context_,
+        LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED,
+        0, HACKRF_VENDOR_ID, USB_BOARD_ID_HACKRF_ONE, LIBUSB_HOTPLUG_MATCH_ANY,
+        &UsbHotplugMonitor::on_device_arrived, this, &callback_handle_);
+
+    if (rc != LIBUSB_SUCCESS) {
+        std::cerr << "Error creating a hotplug callback: " << rc << "\n";
+        libusb_exit(context_);
+        context_ = nullptr;
+        return false;
+    }
+
+    running_.store(true, std::memory_order_relaxed);
+    event_thread_ = std::thread([this]() {
+        while (running_.load(std::memory_order_relaxed)) {
+            libusb_handle_events_completed(context_, nullptr);
+        }
+    });
+    return true;
+}
+
+void UsbHotplugMonitor::stop() {
+    if (!context_) {
+        return;
+    }
+
+    running_.store(false, std::memory_order_relaxed);
+
+    // Deregistering generates an event, which wakes the handler thread
+    libusb_hotplug_deregister_callback(context_, callback_handle_);
+    if (event_thread_.joinable()) {
+        event_thread_.join();
+    }
+
+    libusb_exit(context_);
+    context_ = nullptr;
+}
+
+int UsbHotplugMonitor::on_device_arrived(libusb_context* /*ctx*/, libusb_device* /*device*/,
+                                         libusb_hotplug_event /*event*/, void* user_data) {
+    auto* monitor = static_cast<UsbHotplugMonitor*>(user_data);
+
+    // Runs on the libusb event thread: queue the work instead of sleeping here
+    monitor->commands_->connect_device(HOTPLUG_DELAY);
+    monitor->commands_->start_sweep();
+    return 0;
+}
@@ -0,0 +1,373 @@
+#include "waterfall_history.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dataset_spectrum.hpp"
+
+namespace {
+
+size_t row_bytes(size_t cols) {
+    return cols * sizeof(float) + sizeof(int64_t);
+}
+
+void max_into(float* target, const float* source, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        target[i] = std::max(target[i], source[i]);
+    }
+}
+
+}  // namespace
+
+WaterfallHistory::~WaterfallHistory() {
+    unmap_spill();
+}
+
+bool WaterfallHistory::configure(const WaterfallHistoryConfig& config) {
+    unmap_spill();
+    config_ = config;
+
+    const bool mapped = config_.spill_bytes == 0 || map_spill(config_.spill_path, config_.spill_bytes);
+    reset(cols_);
+    return mapped;
+}
+
+bool WaterfallHistory::map_spill(const std::string& path, size_t size) {
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        std::cerr << "Failed to create history spill file: " << path << '\n';
+        return false;
+    }
+
+    // Scratch only, so it goes away with the process however that ends
+    ::unlink(path.c_str());
+
+    // Reserve the blocks now; running out of disk under a mapping is SIGBUS
+    if (::posix_fallocate(fd, 0, static_cast<off_t>(size)) != 0) {
+        std::cerr << "Not enough disk space for history spill file: " << path << '\n';
+        ::close(fd);
+        return false;
+    }
+
+    void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);  // The mapping keeps its own reference
+
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Failed to map history spill file: " << path << '\n';
+        return false;
+    }
+
+    spill_ = static_cast<float*>(mapping);
+    spill_size_ = size;
+    return true;
+}
+
+void WaterfallHistory::unmap_spill() {
+    if (spill_) {
+        ::munmap(spill_, spill_size_);
+        spill_ = nullptr;
+        spill_size_ = 0;
+    }
+    spill_ring_ = Ring{};
+}
+
+size_t WaterfallHistory::hot_capacity(size_t cols) const noexcept {
+    return std::max<size_t>(1, config_.memory_bytes / 2 / row_bytes(cols));
+}
+
+// One row of each level's share goes to its pending row
+size_t WaterfallHistory::level_capacity(size_t cols) const noexcept {
+    const size_t rows = config_.memory_bytes / 2 / WATERFALL_HISTORY_LEVELS / row_bytes(cols);
+    return std::max<size_t>(1, rows > 1 ? rows - 1 : 0);
+}
+
+size_t WaterfallHistory::spill_capacity(size_t cols) const noexcept {
+    return cols > 0 ? spill_size_ / (cols * sizeof(float)) : 0;
+}
+
+void WaterfallHistory::reset(size_t cols) {
+    cols_ = cols;
+
+    const auto init_ring = [cols](Ring& ring, size_t capacity, float* rows) {
+        ring = Ring{};
+        ring.capacity = capacity;
+        if (rows == nullptr && capacity > 0) {
+            ring.storage.assign(capacity * cols, SPECTRUM_NO_DATA_DB);
+            rows = ring.storage.data();
+        }
+        ring.rows = rows;
+        ring.timestamps_us.assign(capacity, 0);
+    };
+
+    init_ring(hot_, hot_capacity(cols), nullptr);
+    init_ring(spill_ring_, spill_capacity(cols), spill_);
+    for (Ring& level : levels_) {
+        init_ring(level, level_capacity(cols), nullptr);
+    }
+    for (Pending& pending : pending_) {
+        pending.power.assign(cols, SPECTRUM_NO_DATA_DB);
+        pending.count = 0;
+    }
+}
+
+void WaterfallHistory::remap_ring(Ring& ring, const std::vector<BinRun>& runs, size_t cols, size_t capacity) {
+    Ring remapped;
+    remapped.capacity = capacity;
+    remapped.storage.assign(capacity * cols, SPECTRUM_NO_DATA_DB);
+    remapped.rows = remapped.storage.data();
+    remapped.timestamps_us.assign(capacity, 0);
+    remapped.count = std::min(ring.count, capacity);
+    remapped.next = remapped.count % capacity;
+    remapped.dropped = ring.dropped || remapped.count < ring.count;
+
+    // Keeps the newest rows, oldest first from slot 0
+    const size_t skipped = ring.count - remapped.count;
+    for (size_t i = 0; i < remapped.count; ++i) {
+        const size_t slot = ring.slot(skipped + i);
+        const float* source = ring.rows + slot * cols_;
+        float* target = remapped.rows + i * cols;
+        for (const BinRun& run : runs) {
+            if (run.from_bin + run.count <= cols_ && run.to_bin + run.count <= cols) {
+                std::copy_n(source + run.from_bin, run.count, target + run.to_bin);
+            }
+        }
+        remapped.timestamps_us[i] = ring.timestamps_us[slot];
+    }
+
+    ring = std::move(remapped);
+}
+
+void WaterfallHistory::remap(const std::vector<BinRun>& runs, size_t cols) {
+    if (cols_ == 0 || cols == 0) {
+        reset(cols);
+        return;
+    }
+
+    remap_ring(hot_, runs, cols, hot_capacity(cols));
+    for (Ring& level : levels_) {
+        remap_ring(level, runs, cols, level_capacity(cols));
+    }
+    for (Pending& pending : pending_) {
+        remap_bins(pending.power, runs, cols, SPECTRUM_NO_DATA_DB);
+    }
+
+    const bool had_spilled_rows = spill_ring_.count > 0 || spill_ring_.dropped;
+    spill_ring_ = Ring{};
+    spill_ring_.capacity = spill_capacity(cols);
+    spill_ring_.rows = spill_;
+    spill_ring_.timestamps_us.assign(spill_ring_.capacity, 0);
+    spill_ring_.dropped = had_spilled_rows;
+
+    cols_ = cols;
+}
+
+// Rows past a ring's count are never read, so nothing is refilled
+void WaterfallHistory::clear() {
+    for (Ring* ring : {&hot_, &spill_ring_}) {
+        ring->next = 0;
+        ring->count = 0;
+        ring->dropped = false;
+    }
+    for (Ring& level : levels_) {
+        level.next = 0;
+        level.count = 0;
+        level.dropped = false;
+    }
+    for (Pending& pending : pending_) {
+        pending.count = 0;
+    }
+}
+
+void WaterfallHistory::push(Ring& ring, int64_t timestamp_us, const float* power) {
+    std::memcpy(ring.rows + ring.next * cols_, power, cols_ * sizeof(float));
+    ring.timestamps_us[ring.next] = timestamp_us;
+    ring.next = (ring.next + 1) % ring.capacity;
+    if (ring.count < ring.capacity) {
+        ++ring.count;
+    } else {
+        ring.dropped = true;
+    }
+}
+
+void WaterfallHistory::add_row(int64_t timestamp_us, std::span<const float> power) {
+    if (cols_ == 0 || power.size() < cols_) {
+        return;
+    }
+
+    if (!empty() && timestamp_us < newest_us()) {
+        clear();
+    }
+
+    // The oldest hot row moves on to the spill before it is overwritten
+    if (hot_.count == hot_.capacity && spill_ring_.capacity > 0) {
+        const size_t oldest = hot_.slot(0);
+        push(spill_ring_, hot_.timestamps_us[oldest], hot_.rows + oldest * cols_);
+    }
+    push(hot_, timestamp_us, power.data());
+
+    // Every DECIMATION rows of a level complete one row of the level above
+    const float* pooled = power.data();
+    int64_t pooled_us = timestamp_us;
+    for (size_t k = 0; k < WATERFALL_HISTORY_LEVELS; ++k) {
+        Pending& pending = pending_[k];
+        if (pending.count == 0) {
+            std::copy_n(pooled, cols_, pending.power.begin());
+            pending.timestamp_us = pooled_us;
+        } else {
+            max_into(pending.power.data(), pooled, cols_);
+        }
+
+        if (++pending.count < WATERFALL_HISTORY_DECIMATION) {
+            return;
+        }
+
+        Ring& level = levels_[k];
+        push(level, pending.timestamp_us, pending.power.data());
+        pending.count = 0;
+
+        const size_t newest = level.slot(level.count - 1);
+        pooled = level.rows + newest * cols_;
+        pooled_us = level.timestamps_us[newest];
+    }
+}
+
+int64_t WaterfallHistory::newest_us() const noexcept {
+    return hot_.count > 0 ? hot_.timestamps_us[hot_.slot(hot_.count - 1)] : 0;
+}
+
+size_t WaterfallHistory::memory_bytes() const noexcept {
+    size_t bytes = (hot_.storage.size() + pending_.size() * cols_) * sizeof(float) +
+                   (hot_.timestamps_us.size() + spill_ring_.timestamps_us.size()) * sizeof(int64_t);
+    for (const Ring& level : levels_) {
+        bytes += level.storage.size() * sizeof(float) + level.timestamps_us.size() * sizeof(int64_t);
+    }
+    return bytes;
+}
+
+size_t WaterfallHistory::level_count(size_t level) const noexcept {
+    return level == 0 ? spill_ring_.count + hot_.count : levels_[level - 1].count;
+}
+
+const float* WaterfallHistory::level_row(size_t level, size_t i) const noexcept {
+    if (level > 0) {
+        const Ring& ring = levels_[level - 1];
+        return ring.rows + ring.slot(i) * cols_;
+    }
+    if (i < spill_ring_.count) {
+        return spill_ring_.rows + spill_ring_.slot(i) * cols_;
+    }
+    return hot_.rows + hot_.slot(i - spill_ring_.count) * cols_;
+}
+
+int64_t WaterfallHistory::level_timestamp(size_t level, size_t i) const noexcept {
+    if (level > 0) {
+        const Ring& ring = levels_[level - 1];
+        return ring.timestamps_us[ring.slot(i)];
+    }
+    if (i < spill_ring_.count) {
+        return spill_ring_.timestamps_us[spill_ring_.slot(i)];
+    }
+    return hot_.timestamps_us[hot_.slot(i - spill_ring_.count)];
+}
+
+bool WaterfallHistory::level_complete(size_t level) const noexcept {
+    if (level > 0) {
+        return !levels_[level - 1].dropped;
+    }
+    return spill_ring_.capacity > 0 ? !spill_ring_.dropped : !hot_.dropped;
+}
+
+// First row of the level starting at or after timestamp_us
+size_t WaterfallHistory::level_lower_bound(size_t level, int64_t timestamp_us) const noexcept {
+    size_t lo = 0;
+    size_t hi = level_count(level);
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (level_timestamp(level, mid) < timestamp_us) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+bool WaterfallHistory::read(int64_t start_us, int64_t end_us, size_t max_rows, WaterfallHistoryRows& rows) const {
+    rows.timestamps_us.clear();
+    rows.power.clear();
+    if (cols_ == 0 || empty() || max_rows == 0 || end_us < start_us || newest_us() < start_us) {
+        return false;
+    }
+
+    size_t first = 0;
+    size_t last = 0;
+    size_t level = 0;
+    bool partial = false;
+    for (; level <= WATERFALL_HISTORY_LEVELS; ++level) {
+        first = level_lower_bound(level, start_us);
+        last = end_us < newest_us() ? level_lower_bound(level, end_us + 1) : level_count(level);
+
+        // A pooled row starting before the window still covers its start
+        if (level > 0 && first > 0 && first < level_count(level)) {
+            --first;
+        }
+        partial = std::any_of(pending_.begin(), pending_.begin() + static_cast<ptrdiff_t>(level),
+                              [](const Pending& pending) { return pending.count > 0; });
+
+        const bool reaches =
+            level_complete(level) || (level_count(level) > 0 && level_timestamp(level, 0) <= start_us);
+        if (reaches && last - first + (partial ? 1 : 0) <= max_rows) {
+            break;
+        }
+        if (level == WATERFALL_HISTORY_LEVELS) {
+            const size_t budget = partial ? max_rows - 1 : max_rows;
+            first = std::max(first, last > budget ? last - budget : 0);
+            break;
+        }
+    }
+
+    rows.level = level;
+    for (size_t i = first; i < last; ++i) {
+        rows.timestamps_us.push_back(level_timestamp(level, i));
+        const float* row = level_row(level, i);
+        rows.power.insert(rows.power.end(), row, row + cols_);
+    }
+
+    // The pending rows below this level together hold every sweep since its
+    // newest full row; the highest one holds the oldest of them
+    if (partial && last == level_count(level)) {
+        std::vector<float> tail(cols_, SPECTRUM_NO_DATA_DB);
+        int64_t tail_us = 0;
+        bool have_tail = false;
+        for (size_t k = level; k-- > 0;) {
+            const Pending& pending = pending_[k];
+            if (pending.count == 0) {
+                continue;
+            }
+            if (!have_tail) {
+                std::copy(pending.power.begin(), pending.power.end(), tail.begin());
+                tail_us = pending.timestamp_us;
+                have_tail = true;
+            } else {
+                max_into(tail.data(), pending.power.data(), cols_);
+            }
+        }
+        if (have_tail) {
+            rows.timestamps_us.push_back(tail_us);
+            rows.power.insert(rows.power.end(), tail.begin(), tail.end());
+        }
+    }
+
+    return !rows.timestamps_us.empty();
+}
@@ -0,0 +1,157 @@
+#include "waterfall_image_item.hpp"
+
+#include <qwt_interval.h>
+#include <qwt_plot_item.h>
+#include <qwt_scale_map.h>
+
+#include <QImage>
+#include <QPainter>
+#include <QRectF>
+#include <algorithm>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "dataset_spectrum.hpp"
+
+WaterfallImageItem::WaterfallImageItem(int rows, int cols, const QwtInterval& z_interval)
+    : rows_(std::max(rows, 1)),
+      cols_(std::max(cols, 1)),
+      z_interval_(z_interval),
+      image_(std::min(cols_, WATERFALL_IMAGE_MAX_WIDTH), rows_, QImage::Format_RGB32),
+      values_(static_cast<size_t>(image_.width()) * rows_, SPECTRUM_NO_DATA_DB),
+      columns_(cols_, SPECTRUM_NO_DATA_DB),
+      pooled_(image_.width()) {
+    image_.fill(Qt::black);
+
+    setItemAttribute(QwtPlotItem::AutoScale, true);
+    setZ(8.0);  // Same layer as QwtPlotSpectrogram
+}
+
+int WaterfallImageItem::rtti() const {
+    return QwtPlotItem::Rtti_PlotUserItem + 1;
+}
+
+QRectF WaterfallImageItem::boundingRect() const {
+    return QRectF(0.0, 0.0, cols_, rows_);
+}
+
+void WaterfallImageItem::addRow(const DatasetSpectrum& spectrum) {
+    addRow(spectrum.get_layout(), spectrum.get_spectrum());
+}
+
+void WaterfallImageItem::addRow(const SpectrumLayout& layout, std::span<const float> power) {
+    if (layout.empty() || power.size() < layout.num_bins()) {
+        return;
+    }
+
+    // Columns are the layout's flat bins, as in WaterfallRasterData::addRow
+    const int count = std::min(static_cast<int>(layout.num_bins()), cols_);
+    std::copy_n(power.begin(), count, columns_.begin());
+    std::fill(columns_.begin() + count, columns_.end(), SPECTRUM_NO_DATA_DB);
+
+    std::span<const float> row = columns_;
+    const int width = image_.width();
+    if (cols_ > width) {
+        for (int x = 0; x < width; ++x) {
+            const auto begin = columns_.begin() + static_cast<ptrdiff_t>(x) * cols_ / width;
+            const auto end = columns_.begin() + static_cast<ptrdiff_t>(x + 1) * cols_ / width;
+            pooled_[x] = *std::max_element(begin, end);
+        }
+        row = pooled_;
+    }
+
+    head_ = (head_ + rows_ - 1) % rows_;
+    filled_ = std::min(filled_ + 1, rows_);
+    std::copy(row.begin(), row.end(), values_.begin() + static_cast<ptrdiff_t>(head_) * width);
+    color_map_.colorize(z_interval_, row, reinterpret_cast<QRgb*>(image_.scanLine(head_)));
+}
+
+void WaterfallImageItem::setZInterval(const QwtInterval& z_interval) {
+    if (z_interval == z_interval_) {
+        return;
+    }
+    z_interval_ = z_interval;
+
+    const int width = image_.width();
+    for (int i = 0; i < filled_; ++i) {
+        const int y = (head_ + i) % rows_;
+        color_map_.colorize(z_interval_,
+                            std::span<const float>(values_).subspan(static_cast<size_t>(y) * width, width),
+                            reinterpret_cast<QRgb*>(image_.scanLine(y)));
+    }
+}
+
+void WaterfallImageItem::remap(const std::vector<BinRun>& runs, int cols) {
+    cols = std::max(cols, 1);
+    const int old_width = image_.width();
+    const int width = std::min(cols, WATERFALL_IMAGE_MAX_WIDTH);
+
+    std::vector<size_t> columns(static_cast<size_t>(cols), SpectrumLayout::npos);
+    for (const BinRun& run : runs) {
+        if (run.from_bin + run.count > static_cast<size_t>(cols_) || run.to_bin + run.count > columns.size()) {
+            continue;
+        }
+        for (size_t i = 0; i < run.count; ++i) {
+            columns[run.to_bin + i] = run.from_bin + i;
+        }
+    }
+
+    // Pixels stand for the column in the middle of the ones they pool
+    std::vector<int> source_x(width, -1);
+    for (int x = 0; x < width; ++x) {
+        const size_t column = columns[(static_cast<size_t>(x) * 2 + 1) * static_cast<size_t>(cols) / (width * 2)];
+        if (column != SpectrumLayout::npos) {
+            source_x[x] = static_cast<int>(column * static_cast<size_t>(old_width) / static_cast<size_t>(cols_));
+        }
+    }
+
+    QImage image(width, rows_, QImage::Format_RGB32);
+    image.fill(Qt::black);
+    std::vector<float> values(static_cast<size_t>(width) * rows_, SPECTRUM_NO_DATA_DB);
+    for (int y = 0; y < rows_; ++y) {
+        const auto* source = reinterpret_cast<const QRgb*>(image_.constScanLine(y));
+        auto* target = reinterpret_cast<QRgb*>(image.scanLine(y));
+        const float* source_values = values_.data() + static_cast<size_t>(y) * old_width;
+        float* target_values = values.data() + static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; ++x) {
+            if (source_x[x] >= 0) {
+                target[x] = source[source_x[x]];
+                target_values[x] = source_values[source_x[x]];
+            }
+        }
+    }
+
+    cols_ = cols;
+    image_ = std::move(image);
+    values_ = std::move(values);
+    columns_.assign(cols_, SPECTRUM_NO_DATA_DB);
+    pooled_.resize(width);
+}
+
+void WaterfallImageItem::draw(QPainter* painter,
+                              const QwtScaleMap& x_map,
+                              const QwtScaleMap& y_map,
+                              const QRectF& /*canvas_rect*/) const {
+    const double left = x_map.transform(0.0);
+    const double right = x_map.transform(cols_);
+    const double top = y_map.transform(rows_);
+    const double bottom = y_map.transform(0.0);
+    const double row_height = (bottom - top) / rows_;
+
+    const int newest_rows = rows_ - head_;
+    const int width = image_.width();
+
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
+
+    painter->drawImage(QRectF(left, top, right - left, row_height * newest_rows),
+                       image_, QRectF(0, head_, width, newest_rows));
+
+    if (head_ > 0) {
+        painter->drawImage(QRectF(left, top + row_height * newest_rows, right - left, row_height * head_),
+                           image_, QRectF(0, 0, width, head_));
+    }
+
+    painter->restore();
+}
@@ -1,10 +1,14 @@
 #include "waterfall_raster_data.hpp"
 
 #include <QtGlobal>
+#include <algorithm>
 #include <iostream>
-#include <map>
+#include <span>
+#include <utility>
 #include <vector>
 
+#include "dataset_spectrum.hpp"
+
 WaterfallRasterData::WaterfallRasterData(int rows, int cols, int bin_width, double init_value)
     : m_maxRows(rows), m_cols(cols), bin_width(bin_width), m_currentIndex(0), init_value(init_value) {
     m_data.resize(m_maxRows * m_cols, init_value);
@@ -27,20 +31,40 @@ void WaterfallRasterData::addRow(QVector<double> newRow) {
     m_currentIndex = (m_currentIndex + 1) % m_maxRows;
 }
 
-void WaterfallRasterData::addRow(std::map<uint64_t, float> newRow) {
-    if (newRow.empty() || bin_width <= 0) {
+void WaterfallRasterData::addRow(const DatasetSpectrum& spectrum) {
+    addRow(spectrum.get_layout(), spectrum.get_spectrum());
+}
+
+void WaterfallRasterData::addRow(const SpectrumLayout& layout, std::span<const float> power) {
+    if (layout.empty() || bin_width <= 0 || power.size() < layout.num_bins()) {
         return;
     }
 
-    uint64_t start_freq = newRow.begin()->first;
+    // Columns are the layout's flat bins
+    double* row = &m_data[m_currentIndex * m_cols];
+    const int count = std::min(static_cast<int>(layout.num_bins()), m_cols);
+    std::copy_n(power.begin(), count, row);
+    std::fill(row + count, row + m_cols, init_value);
 
-    QVector<double> newRowVector(m_cols, init_value);
+    m_currentIndex = (m_currentIndex + 1) % m_maxRows;
+}
 
-    for (const auto& [freq, power] : newRow) {
-        newRowVector[(freq - start_freq) / bin_width] = power;
+void WaterfallRasterData::remap(const std::vector<BinRun>& runs, int cols) {
+    std::vector<double> data(static_cast<size_t>(m_maxRows) * cols, init_value);
+    for (int row = 0; row < m_maxRows; ++row) {
+        const double* source = &m_data[static_cast<size_t>(row) * m_cols];
+        double* target = &data[static_cast<size_t>(row) * cols];
+        for (const BinRun& run : runs) {
+            if (run.from_bin + run.count <= static_cast<size_t>(m_cols) &&
+                run.to_bin + run.count <= static_cast<size_t>(cols)) {
+                std::copy_n(source + run.from_bin, run.count, target + run.to_bin);
+            }
+        }
     }
 
-    addRow(newRowVector);
+    m_data = std::move(data);
+    m_cols = cols;
+    setInterval(Qt::XAxis, QwtInterval(0, m_cols));
 }
 
 double WaterfallRasterData::value(double x, double y) const {
@@ -0,0 +1,120 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "recording_playback.hpp"
+#include "sweep_codec.hpp"
+#include "sweep_record_format.hpp"
+#include "sweep_record_writer.hpp"
+
+namespace {
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Decodes every band once and reports what it found and how fast
+int info(const std::string& path) {
+    RecordingPlayback playback;
+    if (!playback.open(path)) {
+        return 1;
+    }
+
+    uint64_t bands = 0;
+    uint64_t bins = 0;
+    PlaybackBand band;
+
+    const auto start = std::chrono::steady_clock::now();
+    while (playback.next(band)) {
+        ++bands;
+        bins += band.power_db.size();
+    }
+    const double seconds = seconds_since(start);
+
+    std::cout << "Bands:          " << bands << '\n'
+              << "Span:           "
+              << static_cast<double>(playback.last_timestamp_us() - playback.first_timestamp_us()) / 1e6 << " s\n"
+              << "Dropped blocks: " << playback.dropped_blocks() << '\n'
+              << "Ratio vs f32:   " << static_cast<double>(bins * sizeof(float)) / static_cast<double>(playback.file_size())
+              << '\n'
+              << "Decode:         " << static_cast<double>(bins) / seconds / 1e6 << " Mbins/s\n";
+    return 0;
+}
+
+// Rewrites any recording with RiceDelta samples at step_db
+int compress(const std::string& in_path, const std::string& out_path, float step_db) {
+    RecordingPlayback playback;
+    if (!playback.open(in_path)) {
+        return 1;
+    }
+
+    SweepRecordWriter writer;
+    if (!writer.open(out_path, sweep_record::PowerEncoding::RiceDelta, step_db)) {
+        return 1;
+    }
+
+    std::shared_ptr<const SweepConfig> config;
+    uint64_t bins = 0;
+    double encode_s = 0.0;
+    PlaybackBand band;
+
+    while (playback.next(band)) {
+        if (const uint64_t drops = playback.take_passed_drops()) {
+            writer.write_drop(drops);
+        }
+        if (playback.config() != config) {
+            config = playback.config();
+            writer.write_config(*config);
+        }
+        if (!config) {
+            continue;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        writer.write_band(band.timestamp_us, band.start_hz, band.end_hz, config->bin_width_hz, band.power_db,
+                          band.upper);
+        encode_s += seconds_since(start);
+        bins += band.power_db.size();
+    }
+
+    if (const uint64_t drops = playback.take_passed_drops()) {
+        writer.write_drop(drops);
+    }
+
+    const uint64_t sample_bytes = writer.sample_bytes();
+    const uint64_t raw_sample_bytes = writer.raw_sample_bytes();
+    const uint64_t file_bytes = writer.bytes_written();
+    if (!writer.close()) {
+        return 1;
+    }
+
+    std::cout << "Samples:        " << raw_sample_bytes << " -> " << sample_bytes << " bytes ("
+              << static_cast<double>(raw_sample_bytes) / static_cast<double>(sample_bytes) << "x)\n"
+              << "File:           " << playback.file_size() << " -> " << file_bytes << " bytes\n"
+              << "Encode:         " << static_cast<double>(bins) / encode_s / 1e6 << " Mbins/s\n";
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc == 3 && std::strcmp(argv[1], "info") == 0) {
+        return info(argv[2]);
+    }
+
+    if ((argc == 4 || argc == 6) && std::strcmp(argv[1], "compress") == 0) {
+        float step_db = SWEEP_CODEC_DEFAULT_STEP_DB;
+        if (argc == 6 && std::strcmp(argv[4], "--step") == 0) {
+            step_db = static_cast<float>(std::atof(argv[5]));
+        }
+        return compress(argv[2], argv[3], step_db);
+    }
+
+    std::cerr << "Usage: " << argv[0] << " info <recording>\n"
+              << "       " << argv[0] << " compress <in> <out> [--step dB]\n";
+    return 1;
+}